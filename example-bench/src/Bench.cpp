@@ -0,0 +1,90 @@
+//
+//  Bench.cpp
+//  RemoteProjectionMapper
+//
+
+#include "Bench.h"
+
+namespace {
+    double timeIterations(const std::function<void()>& body, uint64_t iterations)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(uint64_t i = 0; i < iterations; ++i){
+            body();
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    void writeString(std::ostream& out, const std::string& text)
+    {
+        out << '"';
+        for(auto c : text){
+            if(c == '"' || c == '\\') out << '\\';
+            out << c;
+        }
+        out << '"';
+    }
+}
+
+void Bench::run(const std::string& name, const std::vector<std::pair<std::string, std::string>>& params,
+                const std::function<void()>& body, const std::function<void()>& setup)
+{
+    if(!settings.filter.empty() && name.find(settings.filter) == std::string::npos) return;
+
+    // Grow the iterations until a sample is long enough for the clock, this also warms up caches and allocations.
+    uint64_t iterations = 1;
+    while(true){
+        if(setup) setup();
+        auto elapsed = timeIterations(body, iterations);
+        if(elapsed >= settings.minSampleTime) break;
+        iterations = elapsed > 0.0 ? std::max<uint64_t>(iterations * 2, uint64_t(iterations * settings.minSampleTime * 1.2 / elapsed)) : iterations * 10;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(settings.samples);
+    for(int i = 0; i < settings.samples; ++i){
+        if(setup) setup();
+        samples.push_back(timeIterations(body, iterations) * 1e9 / iterations);
+    }
+    std::sort(samples.begin(), samples.end());
+
+    Result result;
+    result.name = name;
+    result.params = params;
+    result.iterations = iterations;
+    result.median = samples[samples.size() / 2];
+    result.min = samples.front();
+    result.max = samples.back();
+    results.push_back(result);
+
+    std::stringstream line;
+    line << name;
+    for(auto & param : params){
+        line << " " << param.first << "=" << param.second;
+    }
+    ofLogNotice("bench") << line.str() << ": " << result.median << "ns (min " << result.min << "ns, max " << result.max << "ns)";
+}
+
+std::string Bench::toJson() const
+{
+    std::stringstream out;
+    out << "{\n\"samples\": " << settings.samples << ",\n\"minSampleTime\": " << settings.minSampleTime << ",\n\"results\": [";
+    for(size_t i = 0; i < results.size(); ++i){
+        auto & result = results[i];
+        out << (i ? "," : "") << "\n{\"name\": ";
+        writeString(out, result.name);
+        out << ", \"params\": {";
+        for(size_t p = 0; p < result.params.size(); ++p){
+            out << (p ? ", " : "");
+            writeString(out, result.params[p].first);
+            out << ": ";
+            writeString(out, result.params[p].second);
+        }
+        out << "}, \"iterations\": " << result.iterations
+            << ", \"medianNs\": " << result.median
+            << ", \"minNs\": " << result.min
+            << ", \"maxNs\": " << result.max << "}";
+    }
+    out << "\n]\n}\n";
+    return out.str();
+}
@@ -0,0 +1,63 @@
+//
+//  Bench.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+#include <chrono>
+#include <functional>
+
+//runs benchmark cases and collects their timings. every case is calibrated to a number of iterations that takes at least
+//minSampleTime, then timed for a number of samples, the median over the samples is the number to compare between runs.
+class Bench {
+public:
+
+    struct Settings {
+        //seconds a sample has to take at least
+        double minSampleTime{0.01};
+        int samples{21};
+        //only run cases whose name contains filter
+        std::string filter;
+    };
+
+    struct Result {
+        std::string name;
+        //parameters of the case, in the order they were given
+        std::vector<std::pair<std::string, std::string>> params;
+        uint64_t iterations{0};
+        //nanoseconds per iteration
+        double median{0};
+        double min{0};
+        double max{0};
+    };
+
+    explicit Bench(const Settings& settings) : settings(settings) {}
+
+    //time body, which runs one iteration per call. setup runs before every sample, untimed
+    void run(const std::string& name, const std::vector<std::pair<std::string, std::string>>& params,
+             const std::function<void()>& body, const std::function<void()>& setup = nullptr);
+
+    const std::vector<Result>& getResults() const { return results; }
+
+    //every result as JSON, one object per case
+    std::string toJson() const;
+
+    //keep the compiler from optimizing away the computation of value
+    template<typename T>
+    static inline void keep(const T& value){
+#if defined(_MSC_VER)
+        static volatile const void* sink;
+        sink = &value;
+#else
+        asm volatile("" : : "g"(&value) : "memory");
+#endif
+    }
+
+private:
+
+    Settings settings;
+    std::vector<Result> results;
+};
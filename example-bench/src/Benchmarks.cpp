@@ -0,0 +1,290 @@
+//
+//  Benchmarks.cpp
+//  RemoteProjectionMapper
+//
+
+#include "Benchmarks.h"
+#include "RemoteMeshBuilder.h"
+#include "RemoteWarpJson.h"
+
+#include <limits>
+
+//control grids from the default 2 by 2 up to dense 64 by 64 ones
+static const std::vector<int> sGridSizes = {2, 4, 10, 32, 64};
+//mesh resolutions, higher is coarser
+static const std::vector<int> sResolutions = {32, 16, 8, 4};
+static const glm::vec2 sContentSize(1920.0f, 1080.0f);
+//WarpSettings::TYPE_BILINEAR, without pulling the warp classes in
+static const int sBilinearType = 1;
+
+//a regular grid with its inner points pushed around a little, the same every run
+static std::vector<glm::vec2> makeControlPoints(int columns, int rows)
+{
+    std::vector<glm::vec2> points;
+    points.reserve(columns * rows);
+    for(int x = 0; x < columns; ++x){
+        for(int y = 0; y < rows; ++y){
+            glm::vec2 point(x / float(columns - 1), y / float(rows - 1));
+            if(x > 0 && x < columns - 1 && y > 0 && y < rows - 1){
+                point += 0.02f * glm::vec2(std::sin(x * 1.7f + y), std::cos(x + y * 2.3f));
+            }
+            points.push_back(point);
+        }
+    }
+    return points;
+}
+
+static RemoteMeshBuilder makeBuilder(int controls, int resolution, bool linear)
+{
+    RemoteMeshBuilder builder;
+    builder.settings.numControlsX = controls;
+    builder.settings.numControlsY = controls;
+    builder.settings.linear = linear;
+    builder.settings.adaptive = false;
+    builder.settings.resolution = resolution;
+    builder.settings.size = sContentSize;
+    builder.settings.windowSize = sContentSize;
+    builder.controlPoints = makeControlPoints(controls, controls);
+    return builder;
+}
+
+static WarpRecord makeWarpRecord(const std::string& name, int controls)
+{
+    WarpRecord record;
+    record.name = name;
+    record.preset = "no_preset";
+    record.type = sBilinearType;
+    record.columns = controls;
+    record.rows = controls;
+    record.controlPoints = makeControlPoints(controls, controls);
+    record.edges = glm::vec4(0.1f, 0.0f, 0.1f, 0.0f);
+    record.hasBilinear = true;
+    return record;
+}
+
+void runGeometryBenchmarks(Bench& bench)
+{
+    for(auto linear : {true, false}){
+        for(auto controls : sGridSizes){
+            for(auto resolution : sResolutions){
+                auto builder = makeBuilder(controls, resolution, linear);
+                std::vector<std::pair<std::string, std::string>> params = {
+                    {"interpolation", linear ? "linear" : "bicubic"},
+                    {"controls", ofToString(controls) + "x" + ofToString(controls)},
+                    {"resolution", ofToString(resolution)},
+                };
+
+                bench.run("mesh build", params, [&builder]{
+                    builder.build();
+                    Bench::keep(builder.mesh.positions.data());
+                });
+
+                // Dragging one control point in the middle of the grid.
+                glm::ivec2 moved(controls / 2, controls / 2);
+                auto & point = builder.controlPoints[moved.x * controls + moved.y];
+                auto origin = point;
+                float offset = 0.0f;
+                bench.run("mesh update", params, [&]{
+                    offset = offset > 0.01f ? 0.0f : offset + 0.001f;
+                    point = origin + offset;
+                    builder.update(moved, moved);
+                    builder.clearChanges();
+                    Bench::keep(builder.mesh.positions.data());
+                });
+            }
+        }
+    }
+
+    // Tessellated meshes are rebuilt whenever a point moves.
+    for(auto tolerance : {0.25f, 1.0f}){
+        for(auto controls : sGridSizes){
+            auto builder = makeBuilder(controls, 4, false);
+            builder.settings.tolerance = tolerance;
+            std::vector<std::pair<std::string, std::string>> params = {
+                {"tolerance", ofToString(tolerance)},
+                {"controls", ofToString(controls) + "x" + ofToString(controls)},
+                {"resolution", "4"},
+            };
+            bench.run("mesh tessellate", params, [&builder]{
+                builder.build();
+                Bench::keep(builder.mesh.indices.data());
+            });
+        }
+    }
+    
+    // Packing on top of building and updating, what setCompactVertices costs the CPU.
+    for(auto controls : sGridSizes){
+        auto builder = makeBuilder(controls, 4, false);
+        builder.settings.compact = true;
+        std::vector<std::pair<std::string, std::string>> params = {
+            {"controls", ofToString(controls) + "x" + ofToString(controls)},
+            {"resolution", "4"},
+        };
+        bench.run("mesh build compact", params, [&builder]{
+            builder.build();
+            Bench::keep(builder.mesh.compact.data());
+        });
+
+        glm::ivec2 moved(controls / 2, controls / 2);
+        auto & point = builder.controlPoints[moved.x * controls + moved.y];
+        auto origin = point;
+        float offset = 0.0f;
+        builder.clearChanges();
+        bench.run("mesh update compact", params, [&]{
+            offset = offset > 0.01f ? 0.0f : offset + 0.001f;
+            point = origin + offset;
+            builder.update(moved, moved);
+            builder.clearChanges();
+            Bench::keep(builder.mesh.compact.data());
+        });
+    }
+
+    // What a topology uploads once per resolution, for a 1080p and an 8K canvas.
+    for(auto canvas : {glm::ivec2(1920, 1080), glm::ivec2(7680, 4320)}){
+        for(auto resolution : sResolutions){
+            int columns = canvas.x / resolution + 1;
+            int rows = canvas.y / resolution + 1;
+            std::vector<std::pair<std::string, std::string>> params = {
+                {"canvas", ofToString(canvas.x) + "x" + ofToString(canvas.y)},
+                {"resolution", ofToString(resolution)},
+            };
+            std::vector<uint32_t> indices(RemoteGridIndices::countTriangles(columns, rows));
+            bench.run("indices triangles", params, [&]{
+                RemoteGridIndices::triangles(columns, rows, indices.data());
+                Bench::keep(indices.data());
+            });
+            indices.resize(RemoteGridIndices::countTriangleStrips(columns, rows));
+            bench.run("indices strips", params, [&]{
+                RemoteGridIndices::triangleStrips(columns, rows, std::numeric_limits<uint32_t>::max(), indices.data());
+                Bench::keep(indices.data());
+            });
+        }
+    }
+
+    for(auto linear : {true, false}){
+        for(auto controls : sGridSizes){
+            std::vector<std::pair<std::string, std::string>> params = {
+                {"interpolation", linear ? "linear" : "bicubic"},
+                {"controls", ofToString(controls) + "x" + ofToString(controls)},
+            };
+            auto original = makeControlPoints(controls, controls);
+            std::vector<glm::vec2> points;
+
+            // What setNumControlsX does, one column more.
+            bench.run("grid resample", params, [&]{
+                points.assign(original.begin(), original.end());
+                RemoteControlGrid::resampleColumns(points, controls, controls, controls + 1, linear);
+                Bench::keep(points.data());
+            });
+
+            bench.run("grid subdivide", params, [&]{
+                points.assign(original.begin(), original.end());
+                RemoteControlGrid::insertColumn(points, controls, controls, 0.3f, linear);
+                Bench::keep(points.data());
+            });
+        }
+    }
+
+    for(auto controls : sGridSizes){
+        std::vector<std::pair<std::string, std::string>> params = {{"controls", ofToString(controls) + "x" + ofToString(controls)}};
+        auto points = makeControlPoints(controls, controls);
+        bench.run("grid flip", params, [&]{
+            RemoteControlGrid::flipHorizontal(points, controls, controls);
+            Bench::keep(points.data());
+        });
+        bench.run("grid rotate", params, [&]{
+            RemoteControlGrid::rotateClockwise(points, controls, controls);
+            Bench::keep(points.data());
+        });
+    }
+
+    // Picking runs over the control points of every warp, in draw area pixels.
+    for(auto warps : {1, 10, 40}){
+        std::vector<std::pair<std::string, std::string>> params = {{"warps", ofToString(warps)}, {"controls", "10x10"}};
+        std::vector<glm::vec2> points;
+        for(int i = 0; i < warps; ++i){
+            for(auto & point : makeControlPoints(10, 10)){
+                points.push_back(point * sContentSize + glm::vec2(i * 3.0f, 0.0f));
+            }
+        }
+        glm::vec2 pos(700.0f, 400.0f);
+        bench.run("find closest point", params, [&]{
+            pos.x = pos.x > 800.0f ? 700.0f : pos.x + 1.0f;
+            float distance;
+            Bench::keep(RemoteGeometry::findClosestPoint(points.data(), points.size(), pos, &distance));
+        });
+        std::vector<size_t> indices;
+        indices.reserve(points.size());
+        bench.run("find points in area", params, [&]{
+            indices.clear();
+            RemoteGeometry::findPointsInArea(points.data(), points.size(), glm::vec2(400.0f, 200.0f), glm::vec2(1200.0f, 800.0f), indices);
+            Bench::keep(indices.data());
+        });
+    }
+
+    bench.run("clip", {}, [&]{
+        glm::vec4 src(0.0f, 0.0f, 1920.0f, 1080.0f);
+        glm::vec4 dst(-100.0f, 20.0f, 2000.0f, 1200.0f);
+        Bench::keep(RemoteGeometry::clip(src, dst, sContentSize));
+        Bench::keep(src);
+    });
+
+    glm::vec2 src[4] = {{0, 0}, {1920, 0}, {1920, 1080}, {0, 1080}};
+    glm::vec2 dst[4] = {{12, 30}, {1890, 4}, {1930, 1060}, {-8, 1100}};
+    bench.run("perspective transform", {}, [&]{
+        dst[0].x += 0.001f;
+        auto transform = PerspectiveTransformation::transform(src, dst);
+        Bench::keep(transform);
+    });
+}
+
+void runPersistenceBenchmarks(Bench& bench)
+{
+    for(auto controls : sGridSizes){
+        std::vector<std::pair<std::string, std::string>> params = {{"controls", ofToString(controls) + "x" + ofToString(controls)}};
+        auto record = makeWarpRecord("bench", controls);
+
+        WarpJsonWriter writer;
+        bench.run("warp write", params, [&]{
+            writer.write(record);
+            Bench::keep(writer.str().data());
+        });
+
+        auto text = writer.str();
+        WarpJsonReader reader;
+        WarpRecord read;
+        bench.run("warp read", params, [&]{
+            reader.read(text, read);
+            Bench::keep(read.controlPoints.data());
+        });
+    }
+
+    for(auto warps : {1, 10, 40}){
+        std::vector<std::pair<std::string, std::string>> params = {{"warps", ofToString(warps)}, {"controls", "10x10"}};
+        MappingRecord mapping;
+        for(int i = 0; i < warps; ++i){
+            auto & entry = mapping.addWarp();
+            entry.name = "bench-" + ofToString(i);
+            entry.type = sBilinearType;
+            entry.srcSize = glm::ivec2(sContentSize.x, sContentSize.y);
+            entry.srcArea = ofRectangle(0, 0, sContentSize.x, sContentSize.y);
+            entry.drawArea = entry.srcArea;
+            entry.warp = makeWarpRecord(entry.name, 10);
+        }
+
+        WarpJsonWriter writer;
+        bench.run("mapping write", params, [&]{
+            writer.write(mapping);
+            Bench::keep(writer.str().data());
+        });
+
+        auto text = writer.str();
+        WarpJsonReader reader;
+        MappingRecord read;
+        bench.run("mapping read", params, [&]{
+            read.clear();
+            reader.read(text, read);
+            Bench::keep(read.warps.data());
+        });
+    }
+}
@@ -0,0 +1,13 @@
+//
+//  Benchmarks.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "Bench.h"
+
+//mesh builds and updates across grid sizes and resolutions, index generation, control grid edits, picking, clipping and perspective transforms
+void runGeometryBenchmarks(Bench& bench);
+//writing and reading warp and mapping records, the text loadWarps and saveWarps go through
+void runPersistenceBenchmarks(Bench& bench);
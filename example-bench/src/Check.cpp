@@ -0,0 +1,27 @@
+//
+//  Check.cpp
+//  RemoteProjectionMapper
+//
+
+#include "Check.h"
+
+void Check::run(const std::string& name, const std::function<void()>& body)
+{
+    if(!settings.filter.empty() && name.find(settings.filter) == std::string::npos) return;
+
+    running = name;
+    failed = false;
+    body();
+    ++numRun;
+    if(failed){
+        ++numFailed;
+    }
+    running.clear();
+}
+
+void Check::expect(bool condition, const std::string& what)
+{
+    if(condition) return;
+    failed = true;
+    ofLogError("check") << running << ": " << what;
+}
@@ -0,0 +1,44 @@
+//
+//  Check.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+#include <functional>
+
+//runs checks and counts the ones that fail. a check fails if any of the expectations in its body doesn't hold,
+//every expectation that doesn't is logged with the name of its check.
+class Check {
+public:
+
+    struct Settings {
+        //only run checks whose name contains filter
+        std::string filter;
+    };
+
+    explicit Check(const Settings& settings) : settings(settings) {}
+
+    //run body as the check called name
+    void run(const std::string& name, const std::function<void()>& body);
+    //fail the running check unless condition holds, what says what was expected
+    void expect(bool condition, const std::string& what);
+
+    //expect a and b to be no more than tolerance apart
+    inline void expectNear(const glm::vec2& a, const glm::vec2& b, float tolerance, const std::string& what){
+        expect(glm::distance(a, b) <= tolerance, what + ": " + ofToString(a) + " != " + ofToString(b));
+    }
+
+    inline int getNumRun() const { return numRun; }
+    inline int getNumFailed() const { return numFailed; }
+
+private:
+
+    Settings settings;
+    std::string running;
+    bool failed{false};
+    int numRun{0};
+    int numFailed{0};
+};
@@ -0,0 +1,350 @@
+//
+//  Checks.cpp
+//  RemoteProjectionMapper
+//
+
+#include "Checks.h"
+#include "RemoteGeometry.h"
+#include "RemoteMeshBuilder.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+//a regular grid with its inner points pushed around a little, the same every run
+static std::vector<glm::vec2> makeControlPoints(int columns, int rows)
+{
+    std::vector<glm::vec2> points;
+    RemoteControlGrid::reset(points, columns, rows);
+    for(int x = 1; x < columns - 1; ++x){
+        for(int y = 1; y < rows - 1; ++y){
+            points[x * rows + y] += 0.03f * glm::vec2(std::sin(x * 1.3f + y), std::cos(x - y * 0.7f));
+        }
+    }
+    return points;
+}
+
+static bool isNear(const std::vector<glm::vec2>& a, const std::vector<glm::vec2>& b, float tolerance)
+{
+    if(a.size() != b.size()) return false;
+    for(size_t i = 0; i < a.size(); ++i){
+        if(glm::distance(a[i], b[i]) > tolerance) return false;
+    }
+    return true;
+}
+
+static bool parseGrid(const char* text, int& columns, int& rows, std::vector<glm::vec2>& points, std::string& error)
+{
+    return RemoteControlGrid::parse(text, std::strlen(text), columns, rows, points, error);
+}
+
+void runGeometryChecks(Check& check)
+{
+    check.run("grid reset", [&check]{
+        std::vector<glm::vec2> points;
+        RemoteControlGrid::reset(points, 3, 2, glm::vec2(2.0f), glm::vec2(1.0f));
+        check.expect(points.size() == 6, "3x2 points");
+        // Column by column.
+        check.expectNear(points[1], glm::vec2(1.0f, 3.0f), 1e-6f, "point (0, 1)");
+        check.expectNear(points[4], glm::vec2(3.0f, 1.0f), 1e-6f, "point (2, 0)");
+    });
+
+    check.run("grid extrapolation", [&check]{
+        std::vector<glm::vec2> points;
+        RemoteControlGrid::reset(points, 3, 3);
+        check.expectNear(RemoteControlGrid::getPoint(points, 3, 3, -1, 1), glm::vec2(-0.5f, 0.5f), 1e-6f, "left of the grid");
+        check.expectNear(RemoteControlGrid::getPoint(points, 3, 3, 1, 3), glm::vec2(0.5f, 1.5f), 1e-6f, "below the grid");
+        check.expectNear(RemoteControlGrid::getPoint(points, 3, 3, 3, -1), glm::vec2(1.5f, -0.5f), 1e-6f, "past a corner");
+    });
+
+    check.run("grid rotate", [&check]{
+        auto points = makeControlPoints(4, 3);
+        auto rotated = points;
+        for(int i = 0; i < 4; ++i){
+            RemoteControlGrid::rotateClockwise(rotated, i % 2 ? 3 : 4, i % 2 ? 4 : 3);
+        }
+        check.expect(isNear(rotated, points, 0.0f), "four quarter turns clockwise");
+
+        rotated = points;
+        RemoteControlGrid::rotateClockwise(rotated, 4, 3);
+        RemoteControlGrid::rotateCounterclockwise(rotated, 3, 4);
+        check.expect(isNear(rotated, points, 0.0f), "a quarter turn back and forth");
+
+        // A 2x2 grid turns like the perspective corners, top left, top right, bottom right, bottom left.
+        glm::vec2 corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        std::vector<glm::vec2> grid = {corners[0], corners[3], corners[1], corners[2]};
+        RemoteControlGrid::rotateClockwise(grid, 2, 2);
+        RemoteGeometry::rotateCorners(corners, true);
+        check.expect(grid[0] == corners[0] && grid[1] == corners[3] && grid[2] == corners[1] && grid[3] == corners[2], "grid and corners turn the same way");
+        RemoteGeometry::rotateCorners(corners, false);
+        check.expect(corners[0] == glm::vec2(0.0f, 0.0f) && corners[2] == glm::vec2(1.0f, 1.0f), "corners turn back");
+    });
+
+    check.run("grid flip", [&check]{
+        auto points = makeControlPoints(4, 3);
+        auto flipped = points;
+        RemoteControlGrid::flipHorizontal(flipped, 4, 3);
+        check.expect(flipped[0] == points[9] && flipped[11] == points[2], "horizontal swaps the columns");
+        RemoteControlGrid::flipHorizontal(flipped, 4, 3);
+        check.expect(isNear(flipped, points, 0.0f), "horizontal twice");
+
+        RemoteControlGrid::flipVertical(flipped, 4, 3);
+        check.expect(flipped[0] == points[2] && flipped[3] == points[5], "vertical reverses the columns");
+        RemoteControlGrid::flipVertical(flipped, 4, 3);
+        check.expect(isNear(flipped, points, 0.0f), "vertical twice");
+
+        glm::vec2 corners[4] = {{0.0f, 0.0f}, {1.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 1.0f}};
+        RemoteGeometry::flipCornersHorizontal(corners);
+        check.expect(corners[0] == glm::vec2(1.0f, 0.0f) && corners[3] == glm::vec2(1.0f, 1.0f), "horizontal corners");
+        RemoteGeometry::flipCornersVertical(corners);
+        check.expect(corners[0] == glm::vec2(1.0f, 1.0f) && corners[2] == glm::vec2(0.0f, 0.0f), "vertical corners");
+    });
+
+    check.run("grid resample", [&check]{
+        // A regular grid stays regular along lines and curves.
+        std::vector<glm::vec2> regular, expected;
+        RemoteControlGrid::reset(regular, 3, 3);
+        for(auto linear : {true, false}){
+            auto resampled = regular;
+            RemoteControlGrid::resampleColumns(resampled, 3, 3, 5, linear);
+            RemoteControlGrid::reset(expected, 5, 3);
+            check.expect(isNear(resampled, expected, 1e-3f), linear ? "linear columns" : "curved columns");
+
+            resampled = regular;
+            RemoteControlGrid::resampleRows(resampled, 3, 3, 6, linear);
+            RemoteControlGrid::reset(expected, 3, 6);
+            check.expect(isNear(resampled, expected, 1e-3f), linear ? "linear rows" : "curved rows");
+        }
+
+        // The outer columns stay where they are, the ones in between are spread out evenly.
+        auto points = makeControlPoints(5, 4);
+        auto resampled = points;
+        RemoteControlGrid::resampleColumns(resampled, 5, 4, 7, true);
+        check.expect(resampled.size() == 28, "7x4 points");
+        if(resampled.size() == 28){
+            for(int y = 0; y < 4; ++y){
+                check.expectNear(resampled[y], points[y], 1e-5f, "first column");
+                check.expectNear(resampled[24 + y], points[16 + y], 1e-5f, "last column");
+            }
+        }
+    });
+
+    check.run("grid subdivide", [&check]{
+        std::vector<glm::vec2> regular, expected;
+        RemoteControlGrid::reset(regular, 3, 3);
+
+        auto points = regular;
+        check.expect(RemoteControlGrid::insertColumn(points, 3, 3, 0.25f, true), "column between columns");
+        RemoteControlGrid::reset(expected, 5, 3);
+        expected.erase(expected.begin() + 9, expected.begin() + 12);
+        check.expect(isNear(points, expected, 1e-6f), "column at a quarter");
+
+        points = regular;
+        check.expect(RemoteControlGrid::insertRow(points, 3, 3, 0.75f, false), "row between rows");
+        RemoteControlGrid::reset(expected, 3, 5);
+        for(int col = 2; col >= 0; --col){
+            expected.erase(expected.begin() + col * 5 + 1);
+        }
+        check.expect(isNear(points, expected, 1e-4f), "row at three quarters");
+
+        check.expect(!RemoteControlGrid::insertColumn(points, 3, 4, 0.5f, true), "no column on an existing one");
+    });
+
+    check.run("grid parse", [&check]{
+        int columns, rows;
+        std::vector<glm::vec2> points;
+        std::string error;
+
+        check.expect(parseGrid("# grid\n0 0, 0.5 0; 1 0\r\n\n0 1 0.5 1 1 1 # end", columns, rows, points, error), "comments, separators and blank lines: " + error);
+        check.expect(columns == 3 && rows == 2 && points.size() == 6, "3x2 grid");
+        if(points.size() == 6){
+            // Read row by row, stored column by column.
+            check.expectNear(points[1], glm::vec2(0.0f, 1.0f), 0.0f, "point (0, 1)");
+            check.expectNear(points[2], glm::vec2(0.5f, 0.0f), 0.0f, "point (1, 0)");
+        }
+
+        check.expect(!parseGrid("0 0 1 0\n0 1\n", columns, rows, points, error), "rows of different length");
+        check.expect(!parseGrid("0 0 1 x\n0 1 1 1\n", columns, rows, points, error), "not a number");
+        check.expect(!parseGrid("0 0 1 0 2\n0 1 1 1 2\n", columns, rows, points, error), "odd number of coordinates");
+        check.expect(!parseGrid("0 0 1 0\n", columns, rows, points, error), "a single row");
+        check.expect(!parseGrid("0 0 1 nan\n0 1 1 1\n", columns, rows, points, error), "nan");
+        check.expect(!parseGrid("0 0 1 0\n0 inf 1 1\n", columns, rows, points, error), "infinity");
+        check.expect(!parseGrid("0 0 1 0\n0 1e39 1 1\n", columns, rows, points, error), "out of range");
+    });
+
+    check.run("clip", [&check]{
+        glm::vec4 src(0.0f, 0.0f, 100.0f, 100.0f);
+        glm::vec4 dst(0.0f, 0.0f, 100.0f, 100.0f);
+        check.expect(!RemoteGeometry::clip(src, dst, glm::vec2(100.0f)), "inside");
+
+        dst = glm::vec4(-50.0f, 0.0f, 100.0f, 100.0f);
+        check.expect(RemoteGeometry::clip(src, dst, glm::vec2(100.0f)), "left of the target");
+        check.expect(dst.x == 0.0f && src.x == 50.0f, "moved src along");
+
+        auto corners = RemoteGeometry::getTextureCorners(glm::vec4(10.0f, 20.0f, 110.0f, 220.0f), glm::vec2(200.0f, 400.0f), true, true);
+        check.expect(corners == glm::vec4(0.05f, 0.55f, 0.55f, 0.05f), "normalized and flipped texture corners");
+        corners = RemoteGeometry::getTextureCorners(glm::vec4(10.0f, 20.0f, 110.0f, 220.0f), glm::vec2(200.0f, 400.0f), false, false);
+        check.expect(corners == glm::vec4(10.0f, 20.0f, 110.0f, 220.0f), "rectangle texture corners");
+    });
+
+    check.run("picking", [&check]{
+        auto points = makeControlPoints(8, 8);
+        float distance;
+        auto index = RemoteGeometry::findClosestPoint(points.data(), points.size(), points[27] + glm::vec2(0.001f), &distance);
+        check.expect(index == 27, "closest point");
+        check.expect(std::abs(distance - glm::length(glm::vec2(0.001f))) < 1e-5f, "distance to it");
+
+        std::vector<size_t> indices;
+        RemoteGeometry::findPointsInArea(points.data(), points.size(), glm::vec2(-0.01f), glm::vec2(0.2f), indices);
+        check.expect(indices.size() == 4, "points in the top left corner");
+    });
+
+    check.run("homography", [&check]{
+        glm::vec2 src[4] = {{0.0f, 0.0f}, {1920.0f, 0.0f}, {1920.0f, 1080.0f}, {0.0f, 1080.0f}};
+        glm::vec2 dst[4] = {{100.0f, 50.0f}, {1800.0f, 0.0f}, {1900.0f, 1000.0f}, {0.0f, 1080.0f}};
+        auto transform = PerspectiveTransformation::transform(src, dst);
+        auto inverted = PerspectiveTransformation::transform(dst, src);
+        for(int i = 0; i < 4; ++i){
+            check.expectNear(PerspectiveTransformation::project(transform, src[i]), dst[i], 0.05f, "corner " + ofToString(i));
+        }
+        glm::vec2 point(700.0f, 300.0f);
+        check.expectNear(PerspectiveTransformation::project(inverted, PerspectiveTransformation::project(transform, point)), point, 0.05f, "there and back");
+    });
+
+    check.run("grid indices", [&check]{
+        for(auto columns : {2, 9, 17}){
+            int rows = 5;
+            std::vector<uint32_t> indices(RemoteGridIndices::countTriangles(columns, rows));
+            RemoteGridIndices::triangles(columns, rows, indices.data());
+            // Every quad shows up once, as two triangles.
+            std::vector<int> quads((columns - 1) * (rows - 1), 0);
+            for(size_t i = 0; i < indices.size(); i += 6){
+                auto topLeft = indices[i];
+                quads[(topLeft / rows) * (rows - 1) + topLeft % rows]++;
+            }
+            check.expect(std::all_of(quads.begin(), quads.end(), [](int count){ return count == 1; }), ofToString(columns) + " columns of triangles");
+
+            std::vector<uint32_t> strips(RemoteGridIndices::countTriangleStrips(columns, rows));
+            auto restart = std::numeric_limits<uint32_t>::max();
+            RemoteGridIndices::triangleStrips(columns, rows, restart, strips.data());
+            check.expect(std::count(strips.begin(), strips.end(), restart) == columns - 2, ofToString(columns) + " columns of strips");
+        }
+    });
+
+    check.run("compact vertices", [&check]{
+        std::vector<glm::vec2> positions;
+        for(auto & point : makeControlPoints(16, 16)){
+            positions.push_back(point * glm::vec2(7680.0f, 4320.0f));
+        }
+        auto bounds = RemoteCompactMesh::getBounds(positions.data(), positions.size(), RemoteCompactMesh::sMargin);
+        check.expect(RemoteCompactMesh::contains(bounds, positions.data(), positions.size()), "bounds contain the positions");
+
+        std::vector<RemoteCompactVertex> vertices(positions.size());
+        auto error = RemoteCompactMesh::encodePositions(positions.data(), positions.size(), bounds, vertices.data());
+        check.expect(error < RemoteCompactMesh::sBudget, "8K positions within budget, off by " + ofToString(error));
+        auto decoded = RemoteCompactMesh::decodePosition(vertices[100], bounds);
+        check.expectNear(decoded, positions[100], RemoteCompactMesh::sBudget, "decoded position");
+    });
+}
+
+//twice the signed area of the triangle a, b, c, positive when it's wound like the regular mesh
+static float cross(const glm::vec2& a, const glm::vec2& b, const glm::vec2& c)
+{
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+void runTessellationChecks(Check& check)
+{
+    // A nearly flat warp, one with a curved edge and one pushed around everywhere.
+    std::vector<std::string> shapes = {"flat", "curved edge", "uneven"};
+    for(size_t shape = 0; shape < shapes.size(); ++shape){
+        for(auto tolerance : {0.25f, 0.5f, 1.0f}){
+            check.run("tessellation " + shapes[shape] + " " + ofToString(tolerance), [&check, shape, tolerance]{
+                RemoteMeshBuilder builder;
+                builder.settings.numControlsX = 4;
+                builder.settings.numControlsY = 4;
+                builder.settings.linear = false;
+                builder.settings.adaptive = true;
+                builder.settings.resolution = 16;
+                builder.settings.size = glm::vec2(1920.0f, 1080.0f);
+                builder.settings.windowSize = builder.settings.size;
+                RemoteControlGrid::reset(builder.controlPoints, 4, 4, glm::vec2(0.9f), glm::vec2(0.05f));
+                if(shape == 1){
+                    for(int x = 0; x < 4; ++x){
+                        builder.controlPoints[x * 4].y -= 0.05f * std::sin(PI * x / 3.0f);
+                    }
+                }else if(shape == 2){
+                    builder.controlPoints = makeControlPoints(4, 4);
+                }
+
+                // The regular mesh the tessellated one has to stay close to.
+                builder.build();
+                auto regular = builder.mesh;
+                builder.settings.tolerance = tolerance;
+                builder.build();
+                auto & mesh = builder.mesh;
+                check.expect(mesh.tessellated, "tessellated");
+                check.expect(mesh.positions.size() <= regular.positions.size(), "no more vertices than the regular mesh");
+                check.expect(mesh.texCoords.size() == mesh.positions.size() && mesh.indices.size() % 3 == 0, "texture coordinates and triangles");
+                if(!mesh.tessellated || mesh.texCoords.size() != mesh.positions.size()) return;
+
+                // Every edge is shared by two triangles, except those on the border, and they're all wound the same way:
+                // no cracks, no overlaps.
+                std::map<std::pair<uint32_t, uint32_t>, int> edges;
+                float area = 0.0f;
+                bool wound = true;
+                for(size_t i = 0; i < mesh.indices.size(); i += 3){
+                    for(int k = 0; k < 3; ++k){
+                        auto a = mesh.indices[i + k];
+                        auto b = mesh.indices[i + (k + 1) % 3];
+                        edges[{std::min(a, b), std::max(a, b)}]++;
+                    }
+                    auto twice = cross(mesh.texCoords[mesh.indices[i]], mesh.texCoords[mesh.indices[i + 1]], mesh.texCoords[mesh.indices[i + 2]]);
+                    wound = wound && twice > 0.0f;
+                    area += 0.5f * twice;
+                }
+                check.expect(wound, "triangles wound the same way");
+                int overshared = 0;
+                int loose = 0;
+                for(auto & edge : edges){
+                    if(edge.second > 2){
+                        ++overshared;
+                    }else if(edge.second == 1){
+                        auto & p = mesh.texCoords[edge.first.first];
+                        auto & q = mesh.texCoords[edge.first.second];
+                        if(!((p.x == 0.0f && q.x == 0.0f) || (p.x == 1.0f && q.x == 1.0f) || (p.y == 0.0f && q.y == 0.0f) || (p.y == 1.0f && q.y == 1.0f))){
+                            ++loose;
+                        }
+                    }
+                }
+                check.expect(overshared == 0, ofToString(overshared) + " edges shared by more than two triangles");
+                check.expect(loose == 0, ofToString(loose) + " unshared edges inside the mesh");
+                check.expect(std::abs(area - 1.0f) < 1e-4f, "covers the texture, area " + ofToString(area));
+
+                // Vertices of the regular mesh, interpolated from the triangle they fall in, stay within tolerance.
+                float deviation = 0.0f;
+                for(size_t s = 0; s < regular.positions.size(); s += 7){
+                    int x = int(s) / regular.resolutionY;
+                    int y = int(s) % regular.resolutionY;
+                    glm::vec2 t(x / float(regular.resolutionX - 1), y / float(regular.resolutionY - 1));
+                    for(size_t i = 0; i < mesh.indices.size(); i += 3){
+                        auto i0 = mesh.indices[i];
+                        auto i1 = mesh.indices[i + 1];
+                        auto i2 = mesh.indices[i + 2];
+                        auto twice = cross(mesh.texCoords[i0], mesh.texCoords[i1], mesh.texCoords[i2]);
+                        auto l0 = cross(t, mesh.texCoords[i1], mesh.texCoords[i2]) / twice;
+                        auto l1 = cross(mesh.texCoords[i0], t, mesh.texCoords[i2]) / twice;
+                        auto l2 = 1.0f - l0 - l1;
+                        if(l0 >= -1e-6f && l1 >= -1e-6f && l2 >= -1e-6f){
+                            auto p = l0 * mesh.positions[i0] + l1 * mesh.positions[i1] + l2 * mesh.positions[i2];
+                            deviation = std::max(deviation, glm::distance(p, regular.positions[s]));
+                            break;
+                        }
+                    }
+                }
+                check.expect(deviation <= tolerance, "deviates " + ofToString(deviation) + " pixels");
+            });
+        }
+    }
+}
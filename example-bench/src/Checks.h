@@ -0,0 +1,13 @@
+//
+//  Checks.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "Check.h"
+
+//control grid edits and parsing, corners, clipping, picking, homographies, index generation and vertex packing
+void runGeometryChecks(Check& check);
+//meshes tessellated to a tolerance against the regular mesh they're tessellated from
+void runTessellationChecks(Check& check);
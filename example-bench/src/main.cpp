@@ -0,0 +1,54 @@
+#include "ofMain.h"
+#include "Bench.h"
+#include "Benchmarks.h"
+#include "Checks.h"
+
+//========================================================================
+//no window and no GL context, only the CPU side of the library is measured
+int main(int argc, char* argv[]){
+    Bench::Settings settings;
+    std::string output = "bench.json";
+    bool checks = false;
+
+    // --check --filter <name part> --samples <n> --min-time <seconds per sample> --out <file>
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--check"){
+            checks = true;
+            continue;
+        }
+        if(i + 1 == argc) break;
+        std::string value = argv[++i];
+        if(arg == "--filter"){
+            settings.filter = value;
+        }else if(arg == "--samples"){
+            settings.samples = std::max(1, ofToInt(value));
+        }else if(arg == "--min-time"){
+            settings.minSampleTime = ofToDouble(value);
+        }else if(arg == "--out"){
+            output = value;
+        }
+    }
+
+    //--check runs the checks instead of the benchmarks and fails if any of them does
+    if(checks){
+        Check check({settings.filter});
+        runGeometryChecks(check);
+        runTessellationChecks(check);
+        ofLogNotice("check") << check.getNumRun() - check.getNumFailed() << " of " << check.getNumRun() << " checks passed";
+        return check.getNumFailed() > 0 ? 1 : 0;
+    }
+
+    Bench bench(settings);
+    runGeometryBenchmarks(bench);
+    runPersistenceBenchmarks(bench);
+
+    ofBuffer json;
+    json.set(bench.toJson());
+    if(!ofBufferToFile(output, json)){
+        ofLogError("bench") << "couldn't write " << output;
+        return 1;
+    }
+    ofLogNotice("bench") << bench.getResults().size() << " results written to " << ofToDataPath(output, true);
+    return 0;
+}
@@ -0,0 +1,167 @@
+//
+//  LoadGenerator.cpp
+//  RemoteProjectionMapper
+//
+
+#include "LoadGenerator.h"
+
+#include <cstdlib>
+#include <new>
+
+//count every heap allocation per thread, the replaced operator new is used by the whole app
+namespace {
+    thread_local size_t threadAllocations = 0;
+}
+
+void* operator new(std::size_t size)
+{
+    ++threadAllocations;
+    if(void* pointer = std::malloc(size ? size : 1)){
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+//params every warp shares, updating them goes through the command queue
+static const std::vector<std::string> sFloatParams = {
+    "-brightness",
+    "-gamma red",
+    "-gamma green",
+    "-gamma blue",
+    "-edge left",
+    "-edge right",
+    "-edge exponent",
+    "-src x",
+    "-draw width",
+};
+
+static const std::vector<std::string> sPresets = {
+    "loadgen-a",
+    "loadgen-b",
+};
+
+size_t LoadGenerator::getThreadAllocations()
+{
+    return threadAllocations;
+}
+
+LoadGenerator::~LoadGenerator()
+{
+    stop();
+}
+
+void LoadGenerator::start(const std::vector<std::string>& warpNames, const Settings& settings)
+{
+    stop();
+    this->warpNames = warpNames;
+    this->settings = settings;
+    results = Results();
+    // Reserve up front so collecting results doesn't show up as allocations.
+    results.dispatchLatencies.reserve(size_t(std::max(settings.paramRate, 1.0f) * 600));
+    fired.store(0);
+    running = true;
+    thread = std::thread([this]{
+        run();
+    });
+}
+
+LoadGenerator::Results LoadGenerator::stop()
+{
+    if(thread.joinable()){
+        running = false;
+        thread.join();
+    }
+    return results;
+}
+
+void LoadGenerator::run()
+{
+    if(warpNames.empty()) return;
+
+    std::uniform_int_distribution<size_t> pickWarp(0, warpNames.size() - 1);
+    std::uniform_int_distribution<size_t> pickParam(0, sFloatParams.size() - 1);
+    std::uniform_int_distribution<size_t> pickPreset(0, sPresets.size() - 1);
+    std::uniform_int_distribution<int> pickPresetAction(0, 2);
+    std::uniform_real_distribution<float> pickValue(0.0f, 1.0f);
+
+    // Each kind of event is due at its own rate, the earliest one is fired next.
+    auto interval = [](float rate){
+        return rate > 0.0f ? uint64_t(1000000.0 / rate) : UINT64_MAX;
+    };
+    uint64_t paramInterval = interval(settings.paramRate);
+    uint64_t presetInterval = interval(settings.presetRate);
+    uint64_t editInterval = interval(settings.editRate);
+    uint64_t start = ofGetElapsedTimeMicros();
+    uint64_t nextParam = start;
+    uint64_t nextPreset = presetInterval == UINT64_MAX ? UINT64_MAX : start + presetInterval;
+    uint64_t nextEdit = editInterval == UINT64_MAX ? UINT64_MAX : start + editInterval;
+    std::vector<bool> editing(warpNames.size(), false);
+
+    RemoteUIServerCallBackArg arg;
+    while(running){
+        uint64_t next = std::min(nextParam, std::min(nextPreset, nextEdit));
+        if(next == UINT64_MAX) break;
+        uint64_t now = ofGetElapsedTimeMicros();
+        if(now < next){
+            std::this_thread::sleep_for(std::chrono::microseconds(std::min<uint64_t>(next - now, 1000)));
+            continue;
+        }
+
+        auto warp = pickWarp(random);
+        arg = RemoteUIServerCallBackArg();
+        arg.group = "[warp] " + warpNames[warp];
+        if(next == nextParam){
+            arg.action = CLIENT_UPDATED_PARAM;
+            arg.paramName = warpNames[warp] + sFloatParams[pickParam(random)];
+            arg.param.type = REMOTEUI_PARAM_FLOAT;
+            arg.param.floatVal = pickValue(random);
+            nextParam += paramInterval;
+        }else if(next == nextPreset){
+            static const RemoteUIServerCallBackArgAction actions[] = {
+                CLIENT_DID_SET_GROUP_PRESET,
+                CLIENT_SAVED_GROUP_PRESET,
+                CLIENT_DELETED_GROUP_PRESET
+            };
+            arg.action = actions[pickPresetAction(random)];
+            arg.msg = sPresets[pickPreset(random)];
+            nextPreset += presetInterval;
+        }else{
+            arg.action = CLIENT_UPDATED_PARAM;
+            arg.paramName = warpNames[warp] + "-editMesh";
+            arg.param.type = REMOTEUI_PARAM_BOOL;
+            editing[warp] = !editing[warp];
+            arg.param.boolVal = editing[warp];
+            nextEdit += editInterval;
+        }
+        fire(arg);
+    }
+}
+
+void LoadGenerator::fire(RemoteUIServerCallBackArg& arg)
+{
+    auto event = fired.load(std::memory_order_relaxed);
+    auto allocations = threadAllocations;
+    uint64_t start = ofGetElapsedTimeMicros();
+    fireTimes[event % sFireTimes] = start;
+
+    ofNotifyEvent(RUI_GET_OF_EVENT(), arg);
+
+    uint64_t end = ofGetElapsedTimeMicros();
+    results.allocations += threadAllocations - allocations;
+    if(results.dispatchLatencies.size() < results.dispatchLatencies.capacity()){
+        results.dispatchLatencies.push_back(uint32_t(std::min<uint64_t>(end - start, UINT32_MAX)));
+    }
+    ++results.events;
+    // Publish only after the handlers queued their commands, so the render thread knows the event reached the queues.
+    fired.store(event + 1, std::memory_order_release);
+}
@@ -0,0 +1,65 @@
+//
+//  LoadGenerator.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxRemoteUIServer.h"
+
+#include <atomic>
+#include <random>
+#include <thread>
+
+//stands in for a busy RemoteUI client: fires synthetic RemoteUI events at the mapper's warps from a background thread,
+//the same way the RemoteUI server delivers them, and measures how long the handlers block the sender
+class LoadGenerator {
+public:
+
+    struct Settings {
+        //float param updates per second, spread over all warps
+        float paramRate{1000.0f};
+        //group preset loads, saves and deletes per second
+        float presetRate{2.0f};
+        //edit mode toggles per second
+        float editRate{1.0f};
+    };
+
+    struct Results {
+        size_t events{0};
+        //microseconds the event handlers took on the sending thread
+        std::vector<uint32_t> dispatchLatencies;
+        //heap allocations made by the event handlers
+        size_t allocations{0};
+    };
+
+    ~LoadGenerator();
+
+    void start(const std::vector<std::string>& warpNames, const Settings& settings);
+    //stop firing and return what was measured
+    Results stop();
+
+    //number of events fired so far, the event with index i was fired at getFireTime(i)
+    inline uint64_t getNumFired() const { return fired.load(std::memory_order_acquire); }
+    inline uint64_t getFireTime(uint64_t event) const { return fireTimes[event % sFireTimes]; }
+
+    static const size_t sFireTimes = 1 << 16;
+
+    //heap allocations made by the calling thread so far
+    static size_t getThreadAllocations();
+
+private:
+
+    void run();
+    void fire(RemoteUIServerCallBackArg& arg);
+
+    Settings settings;
+    std::vector<std::string> warpNames;
+    std::thread thread;
+    std::atomic<bool> running{false};
+    std::atomic<uint64_t> fired{0};
+    std::vector<uint64_t> fireTimes = std::vector<uint64_t>(sFireTimes);
+    Results results;
+    std::mt19937 random;
+};
@@ -0,0 +1,36 @@
+#include "ofMain.h"
+#include "ofApp.h"
+
+//========================================================================
+int main(int argc, char* argv[]){
+    ofGLFWWindowSettings winSettings;
+    winSettings.width = 1280;
+    winSettings.height = 800;
+    winSettings.windowMode = OF_WINDOW;
+    winSettings.visible = false; //headless, the warps still need a GL context
+    winSettings.setGLVersion(3, 2);
+    
+    auto win = ofCreateWindow(winSettings);
+    auto app = std::make_shared<ofApp>();
+    
+    // --warps <n> --param-rate <per second> --preset-rate <per second> --edit-rate <per second> --seconds <n>
+    for(int i = 1; i + 1 < argc; i += 2){
+        std::string arg = argv[i];
+        float value = ofToFloat(argv[i + 1]);
+        if(arg == "--warps"){
+            app->numWarps = int(value);
+        }else if(arg == "--param-rate"){
+            app->settings.paramRate = value;
+        }else if(arg == "--preset-rate"){
+            app->settings.presetRate = value;
+        }else if(arg == "--edit-rate"){
+            app->settings.editRate = value;
+        }else if(arg == "--seconds"){
+            app->seconds = value;
+        }
+    }
+    
+    ofRunApp(win, std::move(app));
+    ofRunMainLoop();
+    
+}
@@ -0,0 +1,114 @@
+//
+//  ofApp.cpp
+//  RemoteProjectionMapper
+//
+
+#include "ofApp.h"
+
+void ofApp::setup(){
+    
+    ofSetFrameRate(60);
+    ofSetVerticalSync(false);
+    
+    // Start from an empty save location so earlier runs don't change the results.
+    auto location = ofToDataPath("loadgen");
+    ofDirectory::removeDirectory(location, true);
+    ofDirectory::createDirectory(location, false, true);
+    mProjectionMapper.setSaveLocation(location);
+    mProjectionMapper.init(false); //no RemoteUI server, the generator is the client
+    
+    mContent.allocate(1024, 768, GL_RGBA);
+    
+    std::vector<std::string> names;
+    for(int i = 0; i < numWarps; ++i){
+        auto name = "loadgen-" + ofToString(i);
+        mWarps.push_back(mProjectionMapper.createWarp<RemoteWarpBilinear>(name, WarpSettings()
+                                                                          .srcSize(mContent.getWidth(), mContent.getHeight())
+                                                                          .saveLocation(location)
+                                                                          .srcArea(ofRectangle(0, 0, mContent.getWidth(), mContent.getHeight()))
+                                                                          .drawArea(ofRectangle(0, 0, ofGetWidth(), ofGetHeight()))
+                                                                          ));
+        names.push_back(name);
+    }
+    
+    // Draw once so the meshes exist before the clock starts.
+    mProjectionMapper.drawWarps(mContent.getTexture());
+    for(auto & warp : mWarps){
+        mSetupRebuilds += warp->getNumMeshRebuilds();
+        mSetupUpdates += warp->getNumMeshUpdates();
+    }
+    
+    mApplyLatencies.reserve(1 << 20);
+    mFrameTimes.reserve(1 << 16);
+    mStartTime = ofGetElapsedTimeMicros();
+    mGenerator.start(names, settings);
+    ofLogNotice("loadgen") << "firing at " << numWarps << " warps for " << seconds << " seconds";
+}
+
+void ofApp::draw(){
+    if(mDone) return;
+    
+    // Every event published before drawWarps starts is applied by it, the queues are drained completely.
+    auto fired = mGenerator.getNumFired();
+    auto allocations = LoadGenerator::getThreadAllocations();
+    uint64_t start = ofGetElapsedTimeMicros();
+    
+    mProjectionMapper.drawWarps(mContent.getTexture());
+    
+    uint64_t end = ofGetElapsedTimeMicros();
+    mFrameAllocations += LoadGenerator::getThreadAllocations() - allocations;
+    if(mFrameTimes.size() < mFrameTimes.capacity()){
+        mFrameTimes.push_back(uint32_t(end - start));
+    }
+    if(fired - mApplied > LoadGenerator::sFireTimes){
+        // The ring of fire times wrapped, those events can't be measured anymore.
+        mApplied = fired - LoadGenerator::sFireTimes;
+    }
+    for(; mApplied < fired && mApplyLatencies.size() < mApplyLatencies.capacity(); ++mApplied){
+        mApplyLatencies.push_back(uint32_t(end - mGenerator.getFireTime(mApplied)));
+    }
+    mApplied = fired;
+    
+    if(end - mStartTime >= uint64_t(seconds * 1000000.0f)){
+        mDone = true;
+        report();
+        ofExit();
+    }
+}
+
+void ofApp::exit(){
+    mGenerator.stop();
+}
+
+static std::string percentiles(std::vector<uint32_t> values){
+    if(values.empty()) return "-";
+    std::sort(values.begin(), values.end());
+    auto at = [&values](double p){
+        return values[std::min(values.size() - 1, size_t(p * values.size()))];
+    };
+    std::stringstream stream;
+    stream << "p50 " << at(0.5) << "us, p90 " << at(0.9) << "us, p99 " << at(0.99) << "us, max " << values.back() << "us";
+    return stream.str();
+}
+
+void ofApp::report(){
+    auto results = mGenerator.stop();
+    double elapsed = (ofGetElapsedTimeMicros() - mStartTime) / 1000000.0;
+    
+    size_t rebuilds = 0;
+    size_t updates = 0;
+    for(auto & warp : mWarps){
+        rebuilds += warp->getNumMeshRebuilds();
+        updates += warp->getNumMeshUpdates();
+    }
+    rebuilds -= mSetupRebuilds;
+    updates -= mSetupUpdates;
+    
+    ofLogNotice("loadgen") << results.events << " events in " << elapsed << "s (" << results.events / elapsed << "/s) at " << mWarps.size() << " warps";
+    ofLogNotice("loadgen") << "dispatch latency: " << percentiles(results.dispatchLatencies);
+    ofLogNotice("loadgen") << "apply latency:    " << percentiles(mApplyLatencies);
+    ofLogNotice("loadgen") << "frame time:       " << percentiles(mFrameTimes);
+    ofLogNotice("loadgen") << "allocations:      " << (results.events ? double(results.allocations) / results.events : 0.0) << " per event while dispatching, "
+                           << (mFrameTimes.empty() ? 0.0 : double(mFrameAllocations) / mFrameTimes.size()) << " per frame while applying";
+    ofLogNotice("loadgen") << "mesh rebuilds:    " << rebuilds << " full (" << (results.events ? double(rebuilds) / results.events : 0.0) << " per event), " << updates << " partial";
+}
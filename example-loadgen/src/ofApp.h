@@ -0,0 +1,45 @@
+//
+//  ofApp.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxRemoteProjectionMapper.h"
+#include "LoadGenerator.h"
+
+//drives the mapper with synthetic RemoteUI events for a while and reports latency, allocations and mesh rebuilds
+class ofApp : public ofBaseApp{
+    
+public:
+    void setup();
+    void draw();
+    void exit();
+    
+    int numWarps{40};
+    float seconds{10.0f};
+    LoadGenerator::Settings settings;
+    
+private:
+    
+    void report();
+    
+    ofxRemoteProjectionMapper mProjectionMapper;
+    std::vector<std::shared_ptr<RemoteWarpBilinear>> mWarps;
+    ofFbo mContent;
+    LoadGenerator mGenerator;
+    
+    //events whose end to end latency has been measured
+    uint64_t mApplied{0};
+    //microseconds from firing an event to the end of the frame that applied it
+    std::vector<uint32_t> mApplyLatencies;
+    std::vector<uint32_t> mFrameTimes;
+    size_t mFrameAllocations{0};
+    //mesh rebuilds and updates before the clock started
+    size_t mSetupRebuilds{0};
+    size_t mSetupUpdates{0};
+    uint64_t mStartTime{0};
+    bool mDone{false};
+    
+};
@@ -2,7 +2,7 @@
 #include "ofApp.h"
 
 //========================================================================
-int main( ){
+int main(int argc, char* argv[]){
     ofGLFWWindowSettings winSettings;
     winSettings.numSamples = 8;
     winSettings.width = 1280;
@@ -14,6 +14,17 @@ int main( ){
     auto win = ofCreateWindow(winSettings);
     auto app = std::make_shared<ofApp>();
     
+    // --leader or --follower <name> to try replication with several instances on one machine, see README
+    for(int i = 1; i < argc; ++i){
+        std::string arg = argv[i];
+        if(arg == "--leader"){
+            app->replicationRole = arg.substr(2);
+        }else if(arg == "--follower" && i + 1 < argc){
+            app->replicationRole = arg.substr(2);
+            app->nodeName = argv[++i];
+        }
+    }
+    
     ofRunApp(win, std::move(app));
     ofRunMainLoop();
     
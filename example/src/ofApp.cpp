@@ -14,8 +14,24 @@ void ofApp::setup(){
     ofSetVerticalSync(true);
     ofEnableAlphaBlending();
     
-    mProjectionMapper.setSaveLocation(ofToDataPath("mapping"));
-    mProjectionMapper.init(); //call this before creating any textures
+    if(replicationRole == "follower"){
+        //every follower on the machine keeps its own copy of the mappings, starting from the leader's warps
+        auto location = ofToDataPath("mapping-" + nodeName);
+        if(!ofFile::doesFileExist(location + "/ProjectionMapping.json")){
+            ofDirectory::createDirectory(location, false, true);
+            ofFile::copyFromTo(ofToDataPath("mapping/ProjectionMapping.json"), location + "/ProjectionMapping.json", false);
+        }
+        mProjectionMapper.setSaveLocation(location);
+        mProjectionMapper.init(false); //followers are edited through the leader
+        mProjectionMapper.enableReplicationFollower();
+    }else{
+        mProjectionMapper.setSaveLocation(ofToDataPath("mapping"));
+        mProjectionMapper.init(); //call this before creating any textures
+        mProjectionMapper.enableGridChannel("127.0.0.1"); //control grids are edited over OSC, see README
+        if(replicationRole == "leader"){
+            mProjectionMapper.enableReplicationLeader();
+        }
+    }
     
     mImage.load("test.png");
     mImage.getTexture().enableMipmap();
@@ -37,6 +53,10 @@ void ofApp::setup(){
      */
 }
 
+void ofApp::update(){
+    mProjectionMapper.update(); //geometry of changed warps is computed on a thread pool, drawWarps only uploads and draws
+}
+
 void ofApp::draw(){
     mProjectionMapper.drawWarps(mImage.getTexture());
 }
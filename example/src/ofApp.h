@@ -15,10 +15,15 @@ class ofApp : public ofBaseApp{
     
 public:
     void setup();
+    void update();
     void draw();
     
     ofxRemoteProjectionMapper mProjectionMapper;
     ofImage mImage;
     
+    //"leader", "follower" or empty, set from the command line
+    std::string replicationRole;
+    std::string nodeName;
+    
 };
 
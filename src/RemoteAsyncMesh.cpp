@@ -0,0 +1,141 @@
+//
+//  RemoteAsyncMesh.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteAsyncMesh.h"
+#include "RemoteThreadPool.h"
+
+void RemoteAsyncMesh::request(const RemoteMeshBuilder::Settings& settings, const std::vector<glm::vec2>& controlPoints, bool rebuild, const glm::ivec2& firstMoved, const glm::ivec2& lastMoved, bool wait)
+{
+    bool start = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.settings = settings;
+        pending.controlPoints = controlPoints;
+        if(!hasPending){
+            pending.rebuild = false;
+            pending.moved = false;
+        }
+        if(rebuild){
+            pending.rebuild = true;
+        }else if(pending.moved){
+            pending.firstMoved = glm::min(pending.firstMoved, firstMoved);
+            pending.lastMoved = glm::max(pending.lastMoved, lastMoved);
+        }else{
+            pending.firstMoved = firstMoved;
+            pending.lastMoved = lastMoved;
+            pending.moved = true;
+        }
+        hasPending = true;
+        if(!running){
+            running = true;
+            start = true;
+        }
+    }
+    if(!start) return;
+
+    if(wait){
+        run();
+    }else{
+        // The job keeps the mesh alive, the warp may be gone before it runs.
+        auto self = shared_from_this();
+        RemoteThreadPool::getShared().enqueue([self]{
+            self->run();
+        });
+    }
+}
+
+void RemoteAsyncMesh::run()
+{
+    while(true){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if(!hasPending){
+                running = false;
+                return;
+            }
+            std::swap(pending, taken);
+            hasPending = false;
+        }
+
+        builder.settings = taken.settings;
+        builder.controlPoints.swap(taken.controlPoints);
+        if(taken.rebuild || builder.mesh.positions.empty()){
+            RemoteWarpStats::Timer timer(*stats, RemoteWarpStats::STAGE_BUILD_MESH);
+            builder.build();
+        }else if(taken.moved){
+            RemoteWarpStats::Timer timer(*stats, RemoteWarpStats::STAGE_UPDATE_MESH);
+            builder.update(taken.firstMoved, taken.lastMoved);
+        }
+        publish();
+    }
+}
+
+void RemoteAsyncMesh::publish()
+{
+    auto & mesh = builder.mesh;
+    auto & buffer = buffers.edit();
+
+    // The mesh published before may never be consumed, include what it changed as well.
+    bool rebuilt = mesh.rebuilt || publishedRebuilt;
+    int firstColumn = mesh.firstColumn;
+    int lastColumn = mesh.lastColumn;
+    if(publishedFirstColumn <= publishedLastColumn){
+        if(firstColumn <= lastColumn){
+            firstColumn = std::min(firstColumn, publishedFirstColumn);
+            lastColumn = std::max(lastColumn, publishedLastColumn);
+        }else{
+            firstColumn = publishedFirstColumn;
+            lastColumn = publishedLastColumn;
+        }
+    }
+
+    buffer.resolutionX = mesh.resolutionX;
+    buffer.resolutionY = mesh.resolutionY;
+    buffer.rebuilt = rebuilt;
+    buffer.firstColumn = firstColumn;
+    buffer.lastColumn = lastColumn;
+    buffer.tessellated = mesh.tessellated;
+    buffer.compactBounds = mesh.compactBounds;
+    if(rebuilt || buffer.positions.size() != mesh.positions.size() || buffer.compact.size() != mesh.compact.size()){
+        buffer.positions = mesh.positions;
+        buffer.texCoords = mesh.texCoords;
+        buffer.indices = mesh.indices;
+        buffer.compact = mesh.compact;
+    }else if(firstColumn <= lastColumn){
+        auto first = firstColumn * mesh.resolutionY;
+        auto last = (lastColumn + 1) * mesh.resolutionY;
+        std::copy(mesh.positions.begin() + first, mesh.positions.begin() + last, buffer.positions.begin() + first);
+        if(!mesh.compact.empty()){
+            std::copy(mesh.compact.begin() + first, mesh.compact.begin() + last, buffer.compact.begin() + first);
+        }
+    }
+
+    if(buffers.publish()){
+        // The one before was picked up, the next mesh only has to carry this one's changes.
+        publishedRebuilt = mesh.rebuilt;
+        publishedFirstColumn = mesh.firstColumn;
+        publishedLastColumn = mesh.lastColumn;
+    }else{
+        publishedRebuilt = rebuilt;
+        publishedFirstColumn = firstColumn;
+        publishedLastColumn = lastColumn;
+    }
+    builder.clearChanges();
+
+    // Only the job resizes these, the render thread only reads the buffer it consumed.
+    size_t bytes = taken.controlPoints.capacity() * sizeof(glm::vec2) + builder.getCapacityBytes();
+    for(int i = 0; i < 3; ++i){
+        auto & published = buffers.getBuffer(i);
+        bytes += published.positions.capacity() * sizeof(glm::vec2) + published.texCoords.capacity() * sizeof(glm::vec2) + published.indices.capacity() * sizeof(uint32_t)
+            + published.compact.capacity() * sizeof(RemoteCompactVertex);
+    }
+    jobBytes.store(bytes, std::memory_order_relaxed);
+}
+
+size_t RemoteAsyncMesh::getCapacityBytes()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return pending.controlPoints.capacity() * sizeof(glm::vec2) + jobBytes.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,72 @@
+//
+//  RemoteAsyncMesh.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "RemoteMeshBuilder.h"
+#include "RemoteTripleBuffer.h"
+#include "RemoteWarpStats.h"
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+//! builds a warp's mesh on the shared thread pool. the render thread hands over requests and picks up finished meshes,
+//! it never waits for one: until a new mesh is finished it keeps drawing the one it has.
+//!
+//! at most one job runs per warp, requests made while it runs are merged and built by the same job once it's done.
+//! finished meshes go through a triple buffer, a mesh that was never picked up passes what it changed on to the next one.
+class RemoteAsyncMesh : public std::enable_shared_from_this<RemoteAsyncMesh> {
+public:
+
+    //! builds are timed into stats
+    explicit RemoteAsyncMesh(std::shared_ptr<RemoteWarpStats> stats) : stats(std::move(stats)) {}
+
+    //! render thread: ask for the mesh of a new state of the warp, rebuild it or only update the control points between firstMoved and lastMoved.
+    //! with wait set the mesh is built on the calling thread when no job is running
+    void request(const RemoteMeshBuilder::Settings& settings, const std::vector<glm::vec2>& controlPoints, bool rebuild, const glm::ivec2& firstMoved, const glm::ivec2& lastMoved, bool wait = false);
+
+    //! render thread: return the newest mesh finished since the last call, nullptr if there is none.
+    //! only what changed since the mesh returned before is filled in, the rest of the buffer is stale
+    inline const RemoteMeshBuilder::Mesh* consume(){ return buffers.consume(); }
+
+    //! bytes allocated for requests, the builder and the triple buffered meshes, as of the last finished build
+    size_t getCapacityBytes();
+
+private:
+
+    struct Request {
+        RemoteMeshBuilder::Settings settings;
+        std::vector<glm::vec2> controlPoints;
+        bool rebuild{false};
+        bool moved{false};
+        glm::ivec2 firstMoved;
+        glm::ivec2 lastMoved;
+    };
+
+    //! build requests until there are none left
+    void run();
+    //! copy what the builder changed into the next buffer and publish it
+    void publish();
+
+    std::mutex mutex;
+    //! guarded by mutex
+    Request pending;
+    bool hasPending{false};
+    bool running{false};
+
+    // only touched by the running job
+    Request taken;
+    RemoteMeshBuilder builder;
+    //! what the last published buffer changed, passed on if it's never consumed
+    bool publishedRebuilt{false};
+    int publishedFirstColumn{0};
+    int publishedLastColumn{-1};
+
+    RemoteTripleBuffer<RemoteMeshBuilder::Mesh> buffers;
+    //! what the running job holds, counted when it publishes
+    std::atomic<size_t> jobBytes{0};
+    std::shared_ptr<RemoteWarpStats> stats;
+};
@@ -0,0 +1,93 @@
+//
+//  RemoteClientMirror.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteClientMirror.h"
+
+size_t RemoteClientMirror::push()
+{
+    auto server = RUI_GET_INSTANCE();
+    auto current = server->getAllParamNamesList();
+    if(resetRequested.exchange(false, std::memory_order_acq_rel) || current != names){
+        names = std::move(current);
+        pushAll();
+        return names.size();
+    }
+
+    size_t count = 0;
+    for(const auto & name : names){
+        auto found = sent.find(name);
+        if(found == sent.end()) continue;
+        auto & entry = found->second;
+        auto value = quantize(entry.param);
+        if(value == entry.value) continue;
+        entry.value = value;
+        readValue(entry.param);
+        server->sendUntrackedParamUpdate(entry.param, name);
+        ++count;
+    }
+    return count;
+}
+
+void RemoteClientMirror::pushAll()
+{
+    auto server = RUI_GET_INSTANCE();
+    sent.clear();
+    for(const auto & name : names){
+        Sent entry;
+        entry.param = server->getParamForName(name);
+        entry.value = quantize(entry.param);
+        sent.emplace(name, entry);
+    }
+    RUI_PUSH_TO_CLIENT();
+}
+
+int64_t RemoteClientMirror::quantize(const RemoteUIParam& param)
+{
+    switch(param.type){
+        case REMOTEUI_PARAM_FLOAT:
+        {
+            if(!param.floatValAddr) return 0;
+            float value = *param.floatValAddr;
+            float range = param.maxFloat - param.minFloat;
+            if(range <= 0.0f){
+                int32_t bits;
+                std::memcpy(&bits, &value, sizeof(bits));
+                return bits;
+            }
+            return std::llround(double(value - param.minFloat) / double(range) * sQuantizationSteps);
+        }
+        case REMOTEUI_PARAM_INT:
+        case REMOTEUI_PARAM_ENUM:
+            return param.intValAddr ? *param.intValAddr : 0;
+        case REMOTEUI_PARAM_BOOL:
+            return param.boolValAddr ? *param.boolValAddr : 0;
+        case REMOTEUI_PARAM_STRING:
+            return param.stringValAddr ? int64_t(std::hash<std::string>()(*param.stringValAddr)) : 0;
+        default:
+            // Colors and spacers aren't edited by the mapper, they only go out with full pushes.
+            return 0;
+    }
+}
+
+void RemoteClientMirror::readValue(RemoteUIParam& param)
+{
+    switch(param.type){
+        case REMOTEUI_PARAM_FLOAT:
+            param.floatVal = *param.floatValAddr;
+            break;
+        case REMOTEUI_PARAM_INT:
+        case REMOTEUI_PARAM_ENUM:
+            param.intVal = *param.intValAddr;
+            break;
+        case REMOTEUI_PARAM_BOOL:
+            param.boolVal = *param.boolValAddr;
+            break;
+        case REMOTEUI_PARAM_STRING:
+            param.stringVal = *param.stringValAddr;
+            break;
+        default:
+            break;
+    }
+}
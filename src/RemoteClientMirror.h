@@ -0,0 +1,47 @@
+//
+//  RemoteClientMirror.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofxRemoteUIServer.h"
+
+#include <atomic>
+#include <unordered_map>
+
+//! remembers the value of every RemoteUI param as it was last sent to the client, so pushes only carry the params that changed.
+//!
+//! floats are compared after quantizing them to sQuantizationSteps steps across their range, jitter below that isn't sent.
+//! whenever params were added or removed, or a client connected, the next push sends everything once to rebuild the mirror.
+class RemoteClientMirror {
+public:
+
+    //! any thread: send everything with the next push, a new client doesn't know any of the values yet
+    inline void reset(){ resetRequested.store(true, std::memory_order_release); }
+
+    //! render thread: send the params whose value changed since they were last sent, returns the number of params sent
+    size_t push();
+
+    //! number of steps a float param's range is quantized to before comparing it
+    static const int sQuantizationSteps = 1 << 16;
+
+private:
+
+    struct Sent {
+        RemoteUIParam param;
+        //! quantized value last sent
+        int64_t value{0};
+    };
+
+    //! quantized value of a param, read through the address RemoteUI holds for it
+    static int64_t quantize(const RemoteUIParam& param);
+    //! copy the value behind the param's address into the param itself so it can be sent
+    static void readValue(RemoteUIParam& param);
+
+    void pushAll();
+
+    std::atomic<bool> resetRequested{true};
+    std::unordered_map<std::string, Sent> sent;
+    std::vector<std::string> names;
+};
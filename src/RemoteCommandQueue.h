@@ -0,0 +1,57 @@
+//
+//  RemoteCommandQueue.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+//! bounded single producer single consumer queue.
+//! push() is only called from the thread delivering RemoteUI events and pop() only from the render thread,
+//! neither side locks. slots are reused, so commands holding strings stop allocating once they have grown.
+template<typename T, size_t Capacity>
+class RemoteCommandQueue {
+public:
+
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+
+    //! copy command into the queue, returns false and drops it when the queue is full
+    bool push(const T& command)
+    {
+        auto tail = this->tail.load(std::memory_order_relaxed);
+        if(tail - head.load(std::memory_order_acquire) == Capacity){
+            return false;
+        }
+        slots[tail & (Capacity - 1)] = command;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    //! copy the oldest command out of the queue, returns false when it is empty
+    bool pop(T& command)
+    {
+        auto head = this->head.load(std::memory_order_relaxed);
+        if(head == tail.load(std::memory_order_acquire)){
+            return false;
+        }
+        command = slots[head & (Capacity - 1)];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool empty() const
+    {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+private:
+
+    std::array<T, Capacity> slots;
+    //! written by the consumer only
+    alignas(64) std::atomic<size_t> head{0};
+    //! written by the producer only
+    alignas(64) std::atomic<size_t> tail{0};
+};
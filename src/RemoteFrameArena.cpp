@@ -0,0 +1,75 @@
+//
+//  RemoteFrameArena.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteFrameArena.h"
+
+#include <algorithm>
+#include <cstdint>
+
+const size_t RemoteFrameArena::sBlockSize = 64 * 1024;
+
+RemoteFrameArena::Scope::Scope(RemoteFrameArena& arena)
+: arena(arena)
+, block(arena.block)
+, offset(arena.offset)
+{
+}
+
+RemoteFrameArena::Scope::~Scope()
+{
+    arena.block = block;
+    arena.offset = offset;
+}
+
+RemoteFrameArena& RemoteFrameArena::get()
+{
+    static thread_local RemoteFrameArena arena;
+    return arena;
+}
+
+void* RemoteFrameArena::allocate(size_t bytes, size_t alignment)
+{
+    // Continue in the current block, then in the ones after it that were kept from earlier frames.
+    for(; block < blocks.size(); ++block, offset = 0){
+        auto & current = blocks[block];
+        auto address = reinterpret_cast<uintptr_t>(current.data.get()) + offset;
+        auto padding = (alignment - address % alignment) % alignment;
+        if(offset + padding + bytes <= current.size){
+            offset += padding + bytes;
+            return current.data.get() + offset - bytes;
+        }
+    }
+
+    // new[] aligns for any fundamental type.
+    auto size = std::max(sBlockSize, bytes);
+    blocks.push_back(Block{std::unique_ptr<char[]>(new char[size]), size});
+    block = blocks.size() - 1;
+    offset = bytes;
+    return blocks.back().data.get();
+}
+
+void RemoteFrameArena::reset()
+{
+    block = 0;
+    offset = 0;
+}
+
+size_t RemoteFrameArena::getBytesUsed() const
+{
+    size_t used = offset;
+    for(size_t i = 0; i < block && i < blocks.size(); ++i){
+        used += blocks[i].size;
+    }
+    return used;
+}
+
+size_t RemoteFrameArena::getCapacity() const
+{
+    size_t capacity = 0;
+    for(auto & current : blocks){
+        capacity += current.size;
+    }
+    return capacity;
+}
@@ -0,0 +1,86 @@
+//
+//  RemoteFrameArena.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+//! bump allocator for short-lived temporaries. memory comes from large blocks that are kept once allocated, so after the
+//! first frames allocating from it never reaches malloc and the heap doesn't fragment over long uptimes.
+//! everything allocated is released at once, by reset() at the end of the frame or by a Scope going out of scope.
+class RemoteFrameArena {
+public:
+
+    //! marks the arena on construction and releases everything allocated after the mark on destruction.
+    //! nothing allocated inside may be used after the scope ends
+    class Scope {
+    public:
+        explicit Scope(RemoteFrameArena& arena = RemoteFrameArena::get());
+        ~Scope();
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        RemoteFrameArena& arena;
+        size_t block;
+        size_t offset;
+    };
+
+    //! size of a block, larger allocations get a block of their own
+    static const size_t sBlockSize;
+
+    //! the calling thread's arena. the mapper resets the render thread's at the end of drawWarps,
+    //! apps drawing warps without a mapper reset it themselves once per frame
+    static RemoteFrameArena& get();
+
+    void* allocate(size_t bytes, size_t alignment);
+    //! release everything, the blocks are kept for the next frame
+    void reset();
+
+    //! bytes handed out since the last reset, including padding
+    size_t getBytesUsed() const;
+    //! bytes of all blocks
+    size_t getCapacity() const;
+
+private:
+
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    //! block allocations currently come from and the offset into it
+    size_t block{0};
+    size_t offset{0};
+};
+
+//! std allocator drawing from a RemoteFrameArena, deallocate is a no-op
+template<typename T>
+class RemoteArenaAllocator {
+public:
+    using value_type = T;
+
+    RemoteArenaAllocator(RemoteFrameArena& arena = RemoteFrameArena::get()) noexcept : arena(&arena) {}
+    template<typename U>
+    RemoteArenaAllocator(const RemoteArenaAllocator<U>& other) noexcept : arena(other.getArena()) {}
+
+    inline T* allocate(size_t n){ return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    inline void deallocate(T*, size_t) noexcept {}
+
+    inline RemoteFrameArena* getArena() const noexcept { return arena; }
+
+    template<typename U>
+    inline bool operator==(const RemoteArenaAllocator<U>& other) const noexcept { return arena == other.getArena(); }
+    template<typename U>
+    inline bool operator!=(const RemoteArenaAllocator<U>& other) const noexcept { return arena != other.getArena(); }
+
+private:
+    RemoteFrameArena* arena;
+};
+
+//! vector for temporaries, valid until the arena is reset or the enclosing Scope ends
+template<typename T>
+using RemoteArenaVector = std::vector<T, RemoteArenaAllocator<T>>;
@@ -0,0 +1,698 @@
+//
+//  RemoteGeometry.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteGeometry.h"
+#include "RemoteFrameArena.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+
+//--------------------------------------------------------------
+void RemoteControlGrid::reset(std::vector<glm::vec2> & points, int columns, int rows, const glm::vec2 & scale, const glm::vec2 & offset)
+{
+    points.clear();
+    for (auto x = 0; x < columns; ++x)
+    {
+        for (auto y = 0; y < rows; ++y)
+        {
+            points.push_back(glm::vec2(x / float(columns - 1), y / float(rows - 1)) * scale + offset);
+        }
+    }
+}
+
+//--------------------------------------------------------------
+glm::vec2 RemoteControlGrid::getPoint(const glm::vec2 * points, int columns, int rows, int col, int row)
+{
+    auto maxCol = columns - 1;
+    auto maxRow = rows - 1;
+    
+    // Here's the magic: extrapolate points beyond the edges.
+    if (col < 0)
+    {
+        return (2.0f * getPoint(points, columns, rows, 0, row) - getPoint(points, columns, rows, 0 - col, row));
+    }
+    if (row < 0)
+    {
+        return (2.0f * getPoint(points, columns, rows, col, 0) - getPoint(points, columns, rows, col, 0 - row));
+    }
+    if (col > maxCol)
+    {
+        return (2.0f * getPoint(points, columns, rows, maxCol, row) - getPoint(points, columns, rows, 2 * maxCol - col, row));
+    }
+    if (row > maxRow)
+    {
+        return (2.0f * getPoint(points, columns, rows, col, maxRow) - getPoint(points, columns, rows, col, 2 * maxRow - row));
+    }
+    
+    // Points on the edges or within the mesh can simply be looked up.
+    auto idx = (col * rows) + row;
+    return points[idx];
+}
+
+//--------------------------------------------------------------
+glm::vec2 RemoteControlGrid::interpolate(const glm::vec2 * points, int count, int stride, float t, bool linear)
+{
+    auto segment = std::min(int(t), count - 2);
+    auto u = t - segment;
+    
+    // A line of points is a grid of one row.
+    auto knot = [points, count, stride](int i){
+        auto max = count - 1;
+        if (i < 0) return 2.0f * points[0] - points[-i * stride];
+        if (i > max) return 2.0f * points[max * stride] - points[(2 * max - i) * stride];
+        return points[i * stride];
+    };
+    
+    if (linear)
+    {
+        return (1.0f - u) * knot(segment) + u * knot(segment + 1);
+    }
+    glm::vec2 knots[4] = { knot(segment - 1), knot(segment), knot(segment + 1), knot(segment + 2) };
+    return RemoteGeometry::cubicInterpolate(knots, u);
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::resample(const glm::vec2 * points, int count, int stride, int n, bool linear, glm::vec2 * out, int outStride)
+{
+    // Trace the line or curve through the points, then walk along it in even steps.
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> curve;
+    curve.reserve(linear ? count : (count - 1) * sCurveResolution + 1);
+    if (linear)
+    {
+        for (auto i = 0; i < count; ++i)
+        {
+            curve.push_back(points[i * stride]);
+        }
+    }
+    else
+    {
+        for (auto i = 0; i < (count - 1) * sCurveResolution; ++i)
+        {
+            curve.push_back(interpolate(points, count, stride, i / float(sCurveResolution), false));
+        }
+        curve.push_back(points[(count - 1) * stride]);
+    }
+    
+    RemoteArenaVector<float> lengths(curve.size());
+    lengths[0] = 0.0f;
+    for (size_t i = 1; i < curve.size(); ++i)
+    {
+        lengths[i] = lengths[i - 1] + glm::distance(curve[i - 1], curve[i]);
+    }
+    
+    size_t segment = 0;
+    for (auto i = 0; i < n; ++i)
+    {
+        auto length = lengths.back() * i / float(n - 1);
+        while (segment + 2 < curve.size() && lengths[segment + 1] < length)
+        {
+            ++segment;
+        }
+        auto span = lengths[segment + 1] - lengths[segment];
+        auto u = span > 0.0f ? glm::clamp((length - lengths[segment]) / span, 0.0f, 1.0f) : 0.0f;
+        out[i * outStride] = glm::mix(curve[segment], curve[segment + 1], u);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::resampleColumns(std::vector<glm::vec2> & points, int columns, int rows, int n, bool linear)
+{
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> resampled(n * rows);
+    for (auto row = 0; row < rows; ++row)
+    {
+        resample(points.data() + row, columns, rows, n, linear, resampled.data() + row, rows);
+    }
+    points.assign(resampled.begin(), resampled.end());
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::resampleRows(std::vector<glm::vec2> & points, int columns, int rows, int n, bool linear)
+{
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> resampled(columns * n);
+    for (auto col = 0; col < columns; ++col)
+    {
+        resample(points.data() + col * rows, rows, 1, n, linear, resampled.data() + col * n, 1);
+    }
+    points.assign(resampled.begin(), resampled.end());
+}
+
+//--------------------------------------------------------------
+bool RemoteControlGrid::insertColumn(std::vector<glm::vec2> & points, int columns, int rows, float percent, bool linear)
+{
+    auto t = glm::clamp(percent, 0.0f, 1.0f) * (columns - 1);
+    auto before = std::min(int(t), columns - 2);
+    auto u = t - before;
+    if (u < 1e-4f || u > 1.0f - 1e-4f) return false;
+    
+    // Columns are contiguous, the new one goes in as a block.
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> column(rows);
+    for (auto row = 0; row < rows; ++row)
+    {
+        column[row] = interpolate(points.data() + row, columns, rows, t, linear);
+    }
+    points.insert(points.begin() + (before + 1) * rows, column.begin(), column.end());
+    return true;
+}
+
+//--------------------------------------------------------------
+bool RemoteControlGrid::insertRow(std::vector<glm::vec2> & points, int columns, int rows, float percent, bool linear)
+{
+    auto t = glm::clamp(percent, 0.0f, 1.0f) * (rows - 1);
+    auto before = std::min(int(t), rows - 2);
+    auto u = t - before;
+    if (u < 1e-4f || u > 1.0f - 1e-4f) return false;
+    
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> inserted;
+    inserted.reserve(columns * (rows + 1));
+    for (auto col = 0; col < columns; ++col)
+    {
+        auto column = points.data() + col * rows;
+        inserted.insert(inserted.end(), column, column + before + 1);
+        inserted.push_back(interpolate(column, rows, 1, t, linear));
+        inserted.insert(inserted.end(), column + before + 1, column + rows);
+    }
+    points.assign(inserted.begin(), inserted.end());
+    return true;
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::flipHorizontal(std::vector<glm::vec2> & points, int columns, int rows)
+{
+    for (auto x = 0; x < columns / 2; ++x)
+    {
+        std::swap_ranges(points.begin() + x * rows, points.begin() + (x + 1) * rows, points.begin() + (columns - 1 - x) * rows);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::flipVertical(std::vector<glm::vec2> & points, int columns, int rows)
+{
+    for (auto x = 0; x < columns; ++x)
+    {
+        std::reverse(points.begin() + x * rows, points.begin() + (x + 1) * rows);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::rotateClockwise(std::vector<glm::vec2> & points, int columns, int rows)
+{
+    // Every corner takes the position of the corner after it clockwise, like the perspective warp's corners:
+    // the new point (x, y) is the old point (columns - 1 - y, x).
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> rotated(points.size());
+    for (auto x = 0; x < rows; ++x)
+    {
+        for (auto y = 0; y < columns; ++y)
+        {
+            rotated[x * columns + y] = points[(columns - 1 - y) * rows + x];
+        }
+    }
+    points.assign(rotated.begin(), rotated.end());
+}
+
+//--------------------------------------------------------------
+void RemoteControlGrid::rotateCounterclockwise(std::vector<glm::vec2> & points, int columns, int rows)
+{
+    // The new point (x, y) is the old point (y, rows - 1 - x).
+    RemoteFrameArena::Scope scope;
+    RemoteArenaVector<glm::vec2> rotated(points.size());
+    for (auto x = 0; x < rows; ++x)
+    {
+        for (auto y = 0; y < columns; ++y)
+        {
+            rotated[x * columns + y] = points[y * rows + (rows - 1 - x)];
+        }
+    }
+    points.assign(rotated.begin(), rotated.end());
+}
+
+//--------------------------------------------------------------
+bool RemoteControlGrid::parse(const char * text, size_t length, int & columns, int & rows, std::vector<glm::vec2> & points, std::string & error)
+{
+    // The file lists the grid row by row, it's stored column by column.
+    RemoteFrameArena::Scope scope;
+    // Every coordinate takes at least a digit and a separator.
+    RemoteArenaVector<float> values;
+    values.reserve(length / 2 + 1);
+    RemoteArenaVector<char> line;
+    line.reserve(length + 1);
+    columns = 0;
+    rows = 0;
+    
+    auto end = text + length;
+    auto lineNumber = 0;
+    for (auto begin = text; begin < end; )
+    {
+        auto lineEnd = std::find(begin, end, '\n');
+        line.assign(begin, std::find(begin, lineEnd, '#'));
+        line.push_back('\0');
+        begin = lineEnd == end ? end : lineEnd + 1;
+        ++lineNumber;
+        
+        // Copied so strtof stops at the end of the line.
+        auto count = values.size();
+        for (auto c = line.data(); *c; )
+        {
+            if (std::isspace((unsigned char)*c) || *c == ',' || *c == ';')
+            {
+                ++c;
+                continue;
+            }
+            char * next;
+            auto value = std::strtof(c, &next);
+            if (next == c)
+            {
+                error = "unexpected '" + std::string(1, *c) + "' on line " + std::to_string(lineNumber);
+                return false;
+            }
+            if (!std::isfinite(value))
+            {
+                error = "non-finite coordinate on line " + std::to_string(lineNumber);
+                return false;
+            }
+            values.push_back(value);
+            c = next;
+        }
+        
+        count = values.size() - count;
+        if (count == 0) continue;
+        if (count % 2)
+        {
+            error = "odd number of coordinates on line " + std::to_string(lineNumber);
+            return false;
+        }
+        if (rows > 0 && int(count / 2) != columns)
+        {
+            error = "line " + std::to_string(lineNumber) + " has " + std::to_string(count / 2) + " points, expected " + std::to_string(columns);
+            return false;
+        }
+        columns = int(count / 2);
+        ++rows;
+    }
+    
+    if (columns < 2 || rows < 2)
+    {
+        error = "a grid needs at least 2 by 2 points";
+        return false;
+    }
+    
+    points.resize(columns * rows);
+    for (auto x = 0; x < columns; ++x)
+    {
+        for (auto y = 0; y < rows; ++y)
+        {
+            auto i = (y * columns + x) * 2;
+            points[x * rows + y] = glm::vec2(values[i], values[i + 1]);
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+glm::vec4 RemoteCompactMesh::getBounds(const glm::vec2 * positions, size_t count, float margin)
+{
+    if (count == 0) return glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+    
+    auto min = positions[0];
+    auto max = positions[0];
+    for (size_t i = 1; i < count; ++i)
+    {
+        min = glm::min(min, positions[i]);
+        max = glm::max(max, positions[i]);
+    }
+    // Keep flat meshes from dividing by 0.
+    auto size = glm::max(max - min, glm::vec2(1.0f));
+    auto origin = min - size * margin;
+    size *= 1.0f + 2.0f * margin;
+    return glm::vec4(origin.x, origin.y, size.x, size.y);
+}
+
+//--------------------------------------------------------------
+bool RemoteCompactMesh::contains(const glm::vec4 & bounds, const glm::vec2 * positions, size_t count)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        if (positions[i].x < bounds.x || positions[i].y < bounds.y || positions[i].x > bounds.x + bounds.z || positions[i].y > bounds.y + bounds.w)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//--------------------------------------------------------------
+float RemoteCompactMesh::encodePositions(const glm::vec2 * positions, size_t count, const glm::vec4 & bounds, RemoteCompactVertex * vertices)
+{
+    auto error = 0.0f;
+    for (size_t i = 0; i < count; ++i)
+    {
+        vertices[i].x = encode((positions[i].x - bounds.x) / bounds.z);
+        vertices[i].y = encode((positions[i].y - bounds.y) / bounds.w);
+        error = std::max(error, glm::length(decodePosition(vertices[i], bounds) - positions[i]));
+    }
+    return error;
+}
+
+//--------------------------------------------------------------
+void RemoteCompactMesh::encodeTexCoords(const glm::vec2 * texCoords, size_t count, RemoteCompactVertex * vertices)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        vertices[i].u = encode(texCoords[i].x);
+        vertices[i].v = encode(texCoords[i].y);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteCompactMesh::encodeGridTexCoords(int columns, int rows, RemoteCompactVertex * vertices)
+{
+    for (auto x = 0; x < columns; ++x)
+    {
+        auto u = encode(x / float(columns - 1));
+        for (auto y = 0; y < rows; ++y)
+        {
+            vertices->u = u;
+            vertices->v = encode(y / float(rows - 1));
+            ++vertices;
+        }
+    }
+}
+
+//--------------------------------------------------------------
+// From http://www.paulinternet.nl/?page=bicubic : fast catmull-rom calculation
+glm::vec2 RemoteGeometry::cubicInterpolate(const glm::vec2 * knots, float t)
+{
+    return (knots[1] + 0.5f * t * (knots[2] - knots[0] + t * (2.0f * knots[0] - 5.0f * knots[1] + 4.0f * knots[2] - knots[3] + t * (3.0f * (knots[1] - knots[2]) + knots[3] - knots[0]))));
+}
+
+//--------------------------------------------------------------
+void RemoteGeometry::forwardDifference(const glm::vec2 * cubic, float t, float step, int count, glm::vec2 * points)
+{
+    // The value and its first three differences at t, the third one stays the same from point to point. they're summed in
+    // double, in float the rounding adds up to a tenth of a pixel over a few hundred points.
+    double h = step;
+    double h2 = h * h;
+    double h3 = h2 * h;
+    for (auto axis = 0; axis < 2; ++axis)
+    {
+        double c0 = cubic[0][axis];
+        double c1 = cubic[1][axis];
+        double c2 = cubic[2][axis];
+        double c3 = cubic[3][axis];
+        double f = c0 + t * (c1 + t * (c2 + t * c3));
+        double d1 = c1 * h + c2 * (2.0 * t * h + h2) + c3 * (3.0 * t * t * h + 3.0 * t * h2 + h3);
+        double d2 = c2 * 2.0 * h2 + c3 * (6.0 * t * h2 + 6.0 * h3);
+        double d3 = c3 * 6.0 * h3;
+        for (auto i = 0; i < count; ++i)
+        {
+            points[i][axis] = float(f);
+            f += d1;
+            d1 += d2;
+            d2 += d3;
+        }
+    }
+}
+
+//--------------------------------------------------------------
+RemotePatch RemotePatch::catmullRom(const glm::vec2 * knots)
+{
+    // The Catmull-Rom basis in power form, row i holds the weights of the knots for t^i. see cubicInterpolate
+    static const float basis[4][4] =
+    {
+        { 0.0f,  1.0f,  0.0f,  0.0f },
+        {-0.5f,  0.0f,  0.5f,  0.0f },
+        { 1.0f, -2.5f,  2.0f, -0.5f },
+        {-0.5f,  1.5f, -1.5f,  0.5f },
+    };
+    
+    // M * G, then times M^T.
+    glm::vec2 columns[4][4];
+    for (auto i = 0; i < 4; ++i)
+    {
+        for (auto j = 0; j < 4; ++j)
+        {
+            columns[i][j] = glm::vec2(0.0f);
+            for (auto k = 0; k < 4; ++k)
+            {
+                columns[i][j] += basis[i][k] * knots[k * 4 + j];
+            }
+        }
+    }
+    RemotePatch patch;
+    for (auto i = 0; i < 4; ++i)
+    {
+        for (auto j = 0; j < 4; ++j)
+        {
+            patch.c[i][j] = glm::vec2(0.0f);
+            for (auto k = 0; k < 4; ++k)
+            {
+                patch.c[i][j] += columns[i][k] * basis[j][k];
+            }
+        }
+    }
+    return patch;
+}
+
+//--------------------------------------------------------------
+RemotePatch RemotePatch::bilinear(const glm::vec2 & p00, const glm::vec2 & p10, const glm::vec2 & p01, const glm::vec2 & p11)
+{
+    RemotePatch patch;
+    for (auto & row : patch.c)
+    {
+        for (auto & c : row)
+        {
+            c = glm::vec2(0.0f);
+        }
+    }
+    patch.c[0][0] = p00;
+    patch.c[1][0] = p10 - p00;
+    patch.c[0][1] = p01 - p00;
+    patch.c[1][1] = p11 - p10 - p01 + p00;
+    return patch;
+}
+
+//--------------------------------------------------------------
+bool RemoteGeometry::clip(glm::vec4 & src, glm::vec4 & dst, const glm::vec2 & size)
+{
+    bool clipped = false;
+    
+    auto srcWidth = src.z - src.x;
+    auto srcHeight = src.w - src.y;
+    
+    float x1 = dst.x / size.x;
+    float x2 = dst.z / size.x;
+    float y1 = dst.y / size.y;
+    float y2 = dst.w / size.y;
+    
+    if (x1 < 0.0f)
+    {
+        dst.x = 0.0f;
+        src.x -= (x1 * srcWidth);
+        clipped = true;
+    }
+    else if (x1 > 1.0f)
+    {
+        dst.x = size.x;
+        src.x -= ((1.0f / x1) * srcWidth);
+        clipped = true;
+    }
+    
+    if (x2 < 0.0f)
+    {
+        dst.z = 0.0f;
+        src.z -= (x2 * srcWidth);
+        clipped = true;
+    }
+    else if (x2 > 1.0f)
+    {
+        dst.z = size.x;
+        src.z -= ((1.0f / x2) * srcWidth);
+        clipped = true;
+    }
+    
+    if (y1 < 0.0f)
+    {
+        dst.y = 0.0f;
+        src.y -= (y1 * srcHeight);
+        clipped = true;
+    }
+    else if (y1 > 1.0f)
+    {
+        dst.y = size.y;
+        src.y -= ((1.0f / y1) * srcHeight);
+        clipped = true;
+    }
+    
+    if (y2 < 0.0f)
+    {
+        dst.w = 0.0f;
+        src.w -= (y2 * srcHeight);
+        clipped = true;
+    }
+    else if (y2 > 1.0f)
+    {
+        dst.w = size.y;
+        src.w -= ((1.0f / y2) * srcHeight);
+        clipped = true;
+    }
+    
+    return clipped;
+}
+
+//--------------------------------------------------------------
+glm::vec4 RemoteGeometry::getTextureCorners(const glm::vec4 & src, const glm::vec2 & size, bool normalized, bool flipped)
+{
+    auto corners = flipped ? glm::vec4(src.x, src.w, src.z, src.y) : src;
+    if (normalized)
+    {
+        corners.x /= size.x;
+        corners.y /= size.y;
+        corners.z /= size.x;
+        corners.w /= size.y;
+    }
+    return corners;
+}
+
+//--------------------------------------------------------------
+void RemoteGeometry::rotateCorners(glm::vec2 * corners, bool clockwise)
+{
+    std::rotate(corners, corners + (clockwise ? 1 : 3), corners + 4);
+}
+
+//--------------------------------------------------------------
+void RemoteGeometry::flipCornersHorizontal(glm::vec2 * corners)
+{
+    std::swap(corners[0], corners[1]);
+    std::swap(corners[2], corners[3]);
+}
+
+//--------------------------------------------------------------
+void RemoteGeometry::flipCornersVertical(glm::vec2 * corners)
+{
+    std::swap(corners[0], corners[3]);
+    std::swap(corners[1], corners[2]);
+}
+
+//--------------------------------------------------------------
+size_t RemoteGeometry::findClosestPoint(const glm::vec2 * points, size_t count, const glm::vec2 & pos, float * distance)
+{
+    size_t index = 0;
+    auto minDistance = std::numeric_limits<float>::max();
+    
+    for (size_t i = 0; i < count; ++i)
+    {
+        auto candidate = glm::distance(pos, points[i]);
+        if (candidate < minDistance)
+        {
+            minDistance = candidate;
+            index = i;
+        }
+    }
+    
+    *distance = minDistance;
+    return index;
+}
+
+//--------------------------------------------------------------
+glm::mat4 PerspectiveTransformation::transform(const glm::vec2 src[4], const glm::vec2 dst[4])
+{
+    float p[8][9] =
+    {
+        { -src[0][0], -src[0][1], -1, 0, 0, 0, src[0][0] * dst[0][0], src[0][1] * dst[0][0], -dst[0][0] }, // h11
+        { 0, 0, 0, -src[0][0], -src[0][1], -1, src[0][0] * dst[0][1], src[0][1] * dst[0][1], -dst[0][1] }, // h12
+        { -src[1][0], -src[1][1], -1, 0, 0, 0, src[1][0] * dst[1][0], src[1][1] * dst[1][0], -dst[1][0] }, // h13
+        { 0, 0, 0, -src[1][0], -src[1][1], -1, src[1][0] * dst[1][1], src[1][1] * dst[1][1], -dst[1][1] }, // h21
+        { -src[2][0], -src[2][1], -1, 0, 0, 0, src[2][0] * dst[2][0], src[2][1] * dst[2][0], -dst[2][0] }, // h22
+        { 0, 0, 0, -src[2][0], -src[2][1], -1, src[2][0] * dst[2][1], src[2][1] * dst[2][1], -dst[2][1] }, // h23
+        { -src[3][0], -src[3][1], -1, 0, 0, 0, src[3][0] * dst[3][0], src[3][1] * dst[3][0], -dst[3][0] }, // h31
+        { 0, 0, 0, -src[3][0], -src[3][1], -1, src[3][0] * dst[3][1], src[3][1] * dst[3][1], -dst[3][1] }, // h32
+    };
+    
+    PerspectiveTransformation::gaussianElimination(&p[0][0], 9);
+    
+    return glm::mat4(p[0][8], p[3][8], 0, p[6][8],
+                     p[1][8], p[4][8], 0, p[7][8],
+                     0, 0, 1, 0,
+                     p[2][8], p[5][8], 0, 1);
+}
+
+//--------------------------------------------------------------
+glm::vec2 PerspectiveTransformation::project(const glm::mat4 & transform, const glm::vec2 & point)
+{
+    auto pt = transform * glm::vec4(point.x, point.y, 0.0f, 1.0f);
+    
+    if (pt.w != 0) pt.w = 1.0f / pt.w;
+    pt *= pt.w;
+    
+    return glm::vec2(pt.x, pt.y);
+}
+
+//--------------------------------------------------------------
+void PerspectiveTransformation::gaussianElimination(float * input, int n)
+{
+    auto i = 0;
+    auto j = 0;
+    auto m = n - 1;
+    
+    while (i < m && j < n)
+    {
+        auto iMax = i;
+        for (auto k = i + 1; k < m; ++k)
+        {
+            if (fabs(input[k * n + j]) > fabs(input[iMax * n + j]))
+            {
+                iMax = k;
+            }
+        }
+        
+        if (input[iMax * n + j] != 0)
+        {
+            if (i != iMax)
+            {
+                for (auto k = 0; k < n; ++k)
+                {
+                    auto ikIn = input[i * n + k];
+                    input[i * n + k] = input[iMax * n + k];
+                    input[iMax * n + k] = ikIn;
+                }
+            }
+            
+            float ijIn = input[i * n + j];
+            for (auto k = 0; k < n; ++k)
+            {
+                input[i * n + k] /= ijIn;
+            }
+            
+            for (auto u = i + 1; u < m; ++u)
+            {
+                auto ujIn = input[u * n + j];
+                for (auto k = 0; k < n; ++k)
+                {
+                    input[u * n + k] -= ujIn * input[i * n + k];
+                }
+            }
+            
+            ++i;
+        }
+        ++j;
+    }
+    
+    for (auto i = m - 2; i >= 0; --i)
+    {
+        for (auto j = i + 1; j < n - 1; ++j)
+        {
+            input[i * n + m] -= input[i * n + j] * input[j * n + m];
+        }
+    }
+}
+
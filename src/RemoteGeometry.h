@@ -0,0 +1,253 @@
+//
+//  RemoteGeometry.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+//! the geometry of the warps in plain C++ on contiguous buffers, it depends on glm and the standard library only. the warp
+//! classes adapt it to GL and RemoteUI, tools and benchmarks can use it without a window.
+
+//! operations on a grid of control points stored column by column, point (col, row) is at col * rows + row.
+//! the grid functions that reshape it take the points in place, their temporaries come from the calling thread's frame arena.
+class RemoteControlGrid {
+public:
+
+    //! a regular grid over the unit square, scaled and offset
+    static void reset(std::vector<glm::vec2> & points, int columns, int rows, const glm::vec2 & scale = glm::vec2(1.0f), const glm::vec2 & offset = glm::vec2(0.0f));
+
+    //! return the specified control point of a grid, points beyond the edges are extrapolated
+    static glm::vec2 getPoint(const glm::vec2 * points, int columns, int rows, int col, int row);
+    static inline glm::vec2 getPoint(const std::vector<glm::vec2> & points, int columns, int rows, int col, int row){ return getPoint(points.data(), columns, rows, col, row); }
+
+    //! refit every row to n columns spaced evenly along the row's line or curve
+    static void resampleColumns(std::vector<glm::vec2> & points, int columns, int rows, int n, bool linear);
+    //! refit every column to n rows spaced evenly along the column's line or curve
+    static void resampleRows(std::vector<glm::vec2> & points, int columns, int rows, int n, bool linear);
+
+    //! insert a column at percent of the way across the grid, on the rows' lines or curves so the shape stays the same.
+    //! returns false when percent is on an existing column
+    static bool insertColumn(std::vector<glm::vec2> & points, int columns, int rows, float percent, bool linear);
+    //! insert a row at percent of the way down the grid
+    static bool insertRow(std::vector<glm::vec2> & points, int columns, int rows, float percent, bool linear);
+
+    static void flipHorizontal(std::vector<glm::vec2> & points, int columns, int rows);
+    static void flipVertical(std::vector<glm::vec2> & points, int columns, int rows);
+    //! turn the content a quarter clockwise over the points, the grid ends up with rows columns and columns rows
+    static void rotateClockwise(std::vector<glm::vec2> & points, int columns, int rows);
+    static void rotateCounterclockwise(std::vector<glm::vec2> & points, int columns, int rows);
+    
+    //! read a grid from text with one row of points per line, as "x y" pairs separated by spaces, tabs, commas or semicolons.
+    //! empty lines and everything after a # are skipped. returns false and sets error if the rows differ in length or the
+    //! grid is smaller than 2 by 2
+    static bool parse(const char * text, size_t length, int & columns, int & rows, std::vector<glm::vec2> & points, std::string & error);
+
+    //! vertices per curve segment when resampling curves
+    static const int sCurveResolution = 20;
+
+private:
+
+    //! fit n points evenly spaced along count points, stride apart, to out, outStride apart
+    static void resample(const glm::vec2 * points, int count, int stride, int n, bool linear, glm::vec2 * out, int outStride);
+    //! the point on count points, stride apart, at t in [0..count - 1]
+    static glm::vec2 interpolate(const glm::vec2 * points, int count, int stride, float t, bool linear);
+
+    RemoteControlGrid() = default;
+};
+
+//! a bicubic patch in power form, p(u, v) is the sum of u^i * v^j * c[i][j] for u and v in [0..1]. bilinear patches only
+//! use the terms up to u * v. evaluating one takes a few multiply-adds instead of interpolating 16 knots
+struct RemotePatch {
+
+    glm::vec2 c[4][4];
+
+    //! the Catmull-Rom patch between the middle four of 4 by 4 knots, knot (i, j) at knots[i * 4 + j], as M * G * M^T
+    static RemotePatch catmullRom(const glm::vec2 * knots);
+    //! the bilinear patch between corners (0, 0), (1, 0), (0, 1) and (1, 1)
+    static RemotePatch bilinear(const glm::vec2 & p00, const glm::vec2 & p10, const glm::vec2 & p01, const glm::vec2 & p11);
+
+    //! the cubic in v the patch follows at u, in power form
+    inline void column(float u, glm::vec2 * cubic) const
+    {
+        for (auto j = 0; j < 4; ++j)
+        {
+            cubic[j] = c[0][j] + u * (c[1][j] + u * (c[2][j] + u * c[3][j]));
+        }
+    }
+    inline glm::vec2 evaluate(float u, float v) const
+    {
+        glm::vec2 cubic[4];
+        column(u, cubic);
+        return cubic[0] + v * (cubic[1] + v * (cubic[2] + v * cubic[3]));
+    }
+};
+
+//! triangle indices for a grid of columns by rows vertices stored column by column, vertex (x, y) is x * rows + y
+class RemoteGridIndices {
+public:
+
+    //! quads per band of triangles, two rows of a band's vertices fit a 16 entry vertex cache
+    static const int sBandWidth = 7;
+
+    //! number of indices triangles and triangleStrips emit
+    static inline size_t countTriangles(int columns, int rows){ return 6 * size_t(columns - 1) * (rows - 1); }
+    static inline size_t countTriangleStrips(int columns, int rows){ return size_t(columns - 1) * 2 * rows + (columns - 2); }
+
+    //! two triangles per quad, walked row by row through bands of sBandWidth columns of quads so every vertex is still in
+    //! the vertex cache when the row below reuses it, which transforms most vertices once instead of twice
+    template<typename Index>
+    static void triangles(int columns, int rows, Index * indices)
+    {
+        for (auto band = 0; band < columns - 1; band += sBandWidth)
+        {
+            auto end = std::min(band + sBandWidth, columns - 1);
+            for (auto y = 0; y < rows - 1; ++y)
+            {
+                for (auto x = band; x < end; ++x)
+                {
+                    Index topLeft = x * rows + y;
+                    Index topRight = (x + 1) * rows + y;
+                    *indices++ = topLeft;
+                    *indices++ = topRight;
+                    *indices++ = topRight + 1;
+                    *indices++ = topLeft;
+                    *indices++ = topRight + 1;
+                    *indices++ = topLeft + 1;
+                }
+            }
+        }
+    }
+
+    //! one triangle strip down every column of quads, separated by restart. the quads are split along the other diagonal,
+    //! with the same winding as triangles, in a third of the indices
+    template<typename Index>
+    static void triangleStrips(int columns, int rows, Index restart, Index * indices)
+    {
+        for (auto x = 0; x < columns - 1; ++x)
+        {
+            if (x > 0)
+            {
+                *indices++ = restart;
+            }
+            for (auto y = 0; y < rows; ++y)
+            {
+                *indices++ = x * rows + y;
+                *indices++ = (x + 1) * rows + y;
+            }
+        }
+    }
+
+private:
+
+    RemoteGridIndices() = default;
+};
+
+//! a vertex packed into 8 bytes, read by GL as normalized unsigned shorts: the position as fractions of the bounds its mesh
+//! was encoded in and the texture coordinate as fractions of 0 to 1
+struct RemoteCompactVertex {
+    uint16_t x;
+    uint16_t y;
+    uint16_t u;
+    uint16_t v;
+};
+
+//! packs mesh vertices into compact vertices, and unpacks them the way the shader does to check what the packing cost
+class RemoteCompactMesh {
+public:
+
+    //! pixels a position may end up off before a mesh is better drawn from float vertices
+    static constexpr float sBudget = 0.25f;
+    //! how far bounds reach past the positions, as a fraction of their size
+    static constexpr float sMargin = 0.125f;
+
+    //! bounds as (left, top, width, height) covering count positions, grown by margin times their size on every side so the
+    //! positions can move a little without packing the whole mesh again
+    static glm::vec4 getBounds(const glm::vec2 * positions, size_t count, float margin);
+    //! returns true if all count positions are inside bounds
+    static bool contains(const glm::vec4 & bounds, const glm::vec2 * positions, size_t count);
+
+    //! pack count positions within bounds, returns the largest distance in pixels between a position and its decoded value
+    static float encodePositions(const glm::vec2 * positions, size_t count, const glm::vec4 & bounds, RemoteCompactVertex * vertices);
+    static void encodeTexCoords(const glm::vec2 * texCoords, size_t count, RemoteCompactVertex * vertices);
+    //! pack the texture coordinates spanning 0 to 1 of a grid of columns by rows vertices stored column by column
+    static void encodeGridTexCoords(int columns, int rows, RemoteCompactVertex * vertices);
+
+    static inline glm::vec2 decodePosition(const RemoteCompactVertex & vertex, const glm::vec4 & bounds)
+    {
+        return glm::vec2(bounds.x, bounds.y) + glm::vec2(decode(vertex.x), decode(vertex.y)) * glm::vec2(bounds.z, bounds.w);
+    }
+    static inline glm::vec2 decodeTexCoord(const RemoteCompactVertex & vertex){ return glm::vec2(decode(vertex.u), decode(vertex.v)); }
+
+private:
+
+    //! a fraction of 0 to 1 as a normalized unsigned short and back
+    static inline uint16_t encode(float t){ return uint16_t(std::min(std::max(t, 0.0f), 1.0f) * 65535.0f + 0.5f); }
+    static inline float decode(uint16_t c){ return c / 65535.0f; }
+
+    RemoteCompactMesh() = default;
+};
+
+class RemoteGeometry {
+public:
+
+    //! perform fast Catmull-Rom interpolation on 4 knots, and return the interpolated value at t
+    static glm::vec2 cubicInterpolate(const glm::vec2 * knots, float t);
+    //! write count points of a cubic in power form at t, t + step, t + 2 * step... by forward differencing, three additions
+    //! per point
+    static void forwardDifference(const glm::vec2 * cubic, float t, float step, int count, glm::vec2 * points);
+
+    //! clip src and dst, both as (left, top, right, bottom), to a target of size, moving src along with dst.
+    //! returns true if anything was clipped
+    static bool clip(glm::vec4 & src, glm::vec4 & dst, const glm::vec2 & size);
+    //! texture coordinates of the corners of src, as (left, top, right, bottom), in a texture of size. normalized divides
+    //! them by the size for textures addressed from 0 to 1, flipped swaps top and bottom
+    static glm::vec4 getTextureCorners(const glm::vec4 & src, const glm::vec2 & size, bool normalized, bool flipped);
+
+    //! turn four corners, in order top left, top right, bottom right, bottom left, a quarter. clockwise every corner takes
+    //! the position of the one after it
+    static void rotateCorners(glm::vec2 * corners, bool clockwise);
+    static void flipCornersHorizontal(glm::vec2 * corners);
+    static void flipCornersVertical(glm::vec2 * corners);
+
+    //! index of the point closest to pos, distance is set to how far it is
+    static size_t findClosestPoint(const glm::vec2 * points, size_t count, const glm::vec2 & pos, float * distance);
+    //! append the indices of the points inside the area from min to max to indices
+    template<typename Indices>
+    static void findPointsInArea(const glm::vec2 * points, size_t count, const glm::vec2 & min, const glm::vec2 & max, Indices & indices)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (points[i].x > min.x && points[i].y > min.y && points[i].x < max.x && points[i].y < max.y)
+            {
+                indices.push_back(i);
+            }
+        }
+    }
+
+private:
+
+    RemoteGeometry() = default;
+};
+
+//! homography mapping one quad onto another
+class PerspectiveTransformation {
+public:
+
+    static glm::mat4 transform(const glm::vec2 src[4], const glm::vec2 dst[4]);
+    //! map point through a homography, dividing by w
+    static glm::vec2 project(const glm::mat4 & transform, const glm::vec2 & point);
+    static void gaussianElimination(float * input, int n);
+
+private:
+
+    PerspectiveTransformation() = default;
+
+};
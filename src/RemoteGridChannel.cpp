@@ -0,0 +1,207 @@
+//
+//  RemoteGridChannel.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteGridChannel.h"
+
+const std::string RemoteGridChannel::sGridAddress = "/rpm/grid";
+const std::string RemoteGridChannel::sDeltaAddress = "/rpm/grid/delta";
+const std::string RemoteGridChannel::sResendAddress = "/rpm/grid/resend";
+const std::string RemoteGridChannel::sPointAddress = "/rpm/point";
+
+bool RemoteGridChannel::setup(const std::string& host, int sendPort, int receivePort)
+{
+    close();
+    if(!sender.setup(host, sendPort)){
+        ofLogError("RemoteGridChannel::setup") << "couldn't send to " << host << ":" << sendPort;
+        return false;
+    }
+    if(!receiver.setup(receivePort)){
+        ofLogError("RemoteGridChannel::setup") << "couldn't listen on port " << receivePort;
+        return false;
+    }
+    setupDone = true;
+    return true;
+}
+
+void RemoteGridChannel::close()
+{
+    if(setupDone){
+        receiver.stop();
+        sender.clear();
+        setupDone = false;
+    }
+    receivedSequences.clear();
+    // The next client may not have seen any grid.
+    sentGrids.clear();
+    resendRequests.clear();
+}
+
+void RemoteGridChannel::sendGrid(const std::string& warpName, int columns, int rows, const std::vector<glm::vec2>& points)
+{
+    if(!setupDone) return;
+
+    auto & grid = sentGrids[warpName];
+    if(grid.columns != columns || grid.rows != rows || grid.points.size() != points.size() * 2 || grid.deltas >= sKeyframeInterval){
+        sendFullGrid(warpName, grid, columns, rows, points);
+        return;
+    }
+    if(!packDelta(grid, points)){
+        sendFullGrid(warpName, grid, columns, rows, points);
+        return;
+    }
+    if(packedDelta.empty()) return;
+
+    ++grid.deltas;
+    message.clear();
+    message.setAddress(sDeltaAddress);
+    message.addStringArg(warpName);
+    message.addIntArg(int32_t(++sentSequences[warpName]));
+    message.addIntArg(columns);
+    message.addIntArg(rows);
+    blob.set(packedDelta.data(), packedDelta.size());
+    message.addBlobArg(blob);
+    sender.sendMessage(message, false);
+}
+
+bool RemoteGridChannel::packDelta(SentGrid& grid, const std::vector<glm::vec2>& points)
+{
+    static const size_t entrySize = 3 * sizeof(int16_t);
+
+    quantized.resize(points.size() * 2);
+    packedDelta.clear();
+    for(size_t i = 0; i < points.size(); ++i){
+        int32_t x = int32_t(std::lround(points[i].x * sGridScale));
+        int32_t y = int32_t(std::lround(points[i].y * sGridScale));
+        quantized[i * 2] = x;
+        quantized[i * 2 + 1] = y;
+        int32_t dx = x - grid.points[i * 2];
+        int32_t dy = y - grid.points[i * 2 + 1];
+        if(dx == 0 && dy == 0) continue;
+        if(i > UINT16_MAX || dx < INT16_MIN || dx > INT16_MAX || dy < INT16_MIN || dy > INT16_MAX){
+            return false;
+        }
+        int16_t entry[3] = { int16_t(uint16_t(i)), int16_t(dx), int16_t(dy) };
+        packedDelta.insert(packedDelta.end(), reinterpret_cast<const char*>(entry), reinterpret_cast<const char*>(entry) + entrySize);
+    }
+    // Past this point the full grid is smaller than the changes.
+    if(packedDelta.size() >= points.size() * 2 * sizeof(float)){
+        return false;
+    }
+    grid.points.swap(quantized);
+    return true;
+}
+
+void RemoteGridChannel::sendFullGrid(const std::string& warpName, SentGrid& grid, int columns, int rows, const std::vector<glm::vec2>& points)
+{
+    packed.resize(points.size() * 2);
+    grid.columns = columns;
+    grid.rows = rows;
+    grid.points.resize(points.size() * 2);
+    grid.deltas = 0;
+    for(size_t i = 0; i < points.size(); ++i){
+        packed[i * 2] = points[i].x;
+        packed[i * 2 + 1] = points[i].y;
+        // The client quantizes the floats the same way before applying deltas on top.
+        grid.points[i * 2] = int32_t(std::lround(points[i].x * sGridScale));
+        grid.points[i * 2 + 1] = int32_t(std::lround(points[i].y * sGridScale));
+    }
+
+    message.clear();
+    message.setAddress(sGridAddress);
+    message.addStringArg(warpName);
+    message.addIntArg(int32_t(++sentSequences[warpName]));
+    message.addIntArg(columns);
+    message.addIntArg(rows);
+    blob.set(reinterpret_cast<const char*>(packed.data()), packed.size() * sizeof(float));
+    message.addBlobArg(blob);
+    sender.sendMessage(message, false);
+}
+
+bool RemoteGridChannel::getNextUpdate(Update& update)
+{
+    if(!setupDone) return false;
+
+    while(receiver.getNextMessage(message)){
+        const auto & address = message.getAddress();
+        if(address == sGridAddress){
+            if(!hasArgTypes(message, "siiib")) continue;
+
+            update.warpName = message.getArgAsString(0);
+            update.sequence = uint32_t(message.getArgAsInt32(1));
+            update.index = -1;
+            update.columns = message.getArgAsInt32(2);
+            update.rows = message.getArgAsInt32(3);
+            if(update.columns < 2 || update.rows < 2) continue;
+
+            blob = message.getArgAsBlob(4);
+            size_t count = size_t(update.columns) * size_t(update.rows);
+            if(blob.size() != count * 2 * sizeof(float)){
+                ofLogWarning("RemoteGridChannel") << "dropping grid for " << update.warpName << " with " << blob.size() << " bytes, expected " << count * 2 * sizeof(float);
+                continue;
+            }
+            if(!acceptSequence(update.warpName, update.sequence)) continue;
+
+            update.points.resize(count);
+            std::memcpy(&update.points[0].x, blob.getData(), blob.size());
+            return true;
+        }else if(address == sPointAddress){
+            if(!hasArgTypes(message, "siiff")) continue;
+
+            update.warpName = message.getArgAsString(0);
+            update.sequence = uint32_t(message.getArgAsInt32(1));
+            update.index = message.getArgAsInt32(2);
+            update.columns = 0;
+            update.rows = 0;
+            if(update.index < 0 || !acceptSequence(update.warpName, update.sequence)) continue;
+
+            update.points.resize(1);
+            update.points[0] = glm::vec2(message.getArgAsFloat(3), message.getArgAsFloat(4));
+            return true;
+        }else if(address == sResendAddress){
+            if(!hasArgTypes(message, "s")) continue;
+
+            auto warpName = message.getArgAsString(0);
+            // Forget what the client had, the next grid sent is a full one.
+            sentGrids.erase(warpName);
+            resendRequests.insert(warpName);
+        }
+    }
+    return false;
+}
+
+bool RemoteGridChannel::takeResendRequest(const std::string& warpName)
+{
+    return resendRequests.erase(warpName) != 0;
+}
+
+bool RemoteGridChannel::acceptSequence(const std::string& warpName, uint32_t sequence)
+{
+    auto found = receivedSequences.find(warpName);
+    if(found == receivedSequences.end()){
+        receivedSequences.emplace(warpName, sequence);
+        return true;
+    }
+    // Compare as a signed difference so the sequence can wrap around.
+    int32_t difference = int32_t(sequence - found->second);
+    if(difference <= 0 && difference > -int32_t(sRestartDistance)){
+        return false;
+    }
+    // Newer, or so far behind that the client must have restarted counting.
+    found->second = sequence;
+    return true;
+}
+
+bool RemoteGridChannel::hasArgTypes(const ofxOscMessage& message, const char* types)
+{
+    size_t count = std::strlen(types);
+    if(message.getNumArgs() < count) return false;
+    for(size_t i = 0; i < count; ++i){
+        // The type enum holds the OSC type tags.
+        if(message.getArgType(i) != ofxOscArgType(types[i])){
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,100 @@
+//
+//  RemoteGridChannel.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+
+#include <set>
+
+//! carries whole control grids as single OSC messages, so RemoteUI only has to share scalar settings.
+//!
+//! /rpm/grid         s warp, i sequence, i columns, i rows, b points
+//! /rpm/grid/delta   s warp, i sequence, i columns, i rows, b changes   (mapper to client only)
+//! /rpm/grid/resend  s warp                                           (client to mapper only)
+//! /rpm/point        s warp, i sequence, i index, f x, f y
+//!
+//! points are packed as little endian float32 x, y pairs in the warp's control point order (column major).
+//! every message carries a per warp sequence number, updates older than the newest one received are dropped. a sequence more
+//! than sRestartDistance behind the newest one comes from a client that restarted counting and is accepted.
+//! messages whose arguments don't have the types above are dropped.
+//!
+//! grids sent to the client are quantized to 1 / sGridScale in normalized warp space. after the first full grid the mapper
+//! only sends the points that changed, as little endian uint16 index, int16 dx, int16 dy entries holding the difference of
+//! the quantized coordinates to the previous message. a delta applies on top of sequence - 1 only, a client that missed a
+//! message, or has no grid for the warp yet, asks for a full one with /rpm/grid/resend. a full grid is also sent after
+//! sKeyframeInterval deltas.
+class RemoteGridChannel {
+public:
+
+    struct Update {
+        std::string warpName;
+        uint32_t sequence{0};
+        //! control point index for /rpm/point, -1 for a whole grid
+        int index{-1};
+        int columns{0};
+        int rows{0};
+        std::vector<glm::vec2> points;
+    };
+
+    //! send grids to host:sendPort and listen for edits on receivePort
+    bool setup(const std::string& host, int sendPort, int receivePort);
+    void close();
+    bool isSetup() const { return setupDone; }
+
+    //! send the grid of a warp, only the points that changed if the client has the previous one
+    void sendGrid(const std::string& warpName, int columns, int rows, const std::vector<glm::vec2>& points);
+
+    //! take the next received edit, returns false when there is none left
+    bool getNextUpdate(Update& update);
+    //! returns true once after the client asked for the full grid of a warp
+    bool takeResendRequest(const std::string& warpName);
+
+    static const std::string sGridAddress;
+    static const std::string sDeltaAddress;
+    static const std::string sResendAddress;
+    static const std::string sPointAddress;
+
+    //! quantization steps per unit of normalized warp space
+    static const int sGridScale = 1 << 16;
+    //! a full grid is sent after this many deltas
+    static const uint32_t sKeyframeInterval = 64;
+    //! received sequences further behind than this start the warp's count over
+    static const uint32_t sRestartDistance = 1024;
+
+private:
+
+    struct SentGrid {
+        int columns{0};
+        int rows{0};
+        //! quantized x, y of every point as last sent
+        std::vector<int32_t> points;
+        uint32_t deltas{0};
+    };
+
+    //! pack the changes to a grid the client already has, returns false if a full grid is smaller or a change doesn't fit
+    bool packDelta(SentGrid& grid, const std::vector<glm::vec2>& points);
+    void sendFullGrid(const std::string& warpName, SentGrid& grid, int columns, int rows, const std::vector<glm::vec2>& points);
+
+    //! true if sequence is newer than the last one received for the warp, or the client restarted
+    bool acceptSequence(const std::string& warpName, uint32_t sequence);
+    //! true if message has at least as many arguments as types and they match it, one OSC type tag per argument
+    static bool hasArgTypes(const ofxOscMessage& message, const char* types);
+
+    ofxOscSender sender;
+    ofxOscReceiver receiver;
+    bool setupDone{false};
+
+    ofxOscMessage message;
+    std::vector<float> packed;
+    std::vector<char> packedDelta;
+    std::vector<int32_t> quantized;
+    ofBuffer blob;
+    std::map<std::string, uint32_t> sentSequences;
+    std::map<std::string, SentGrid> sentGrids;
+    std::set<std::string> resendRequests;
+    std::map<std::string, uint32_t> receivedSequences;
+};
@@ -0,0 +1,235 @@
+//
+//  RemoteMappingWatcher.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteMappingWatcher.h"
+
+#ifdef TARGET_LINUX
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+RemoteMappingWatcher::~RemoteMappingWatcher()
+{
+    stop();
+}
+
+void RemoteMappingWatcher::start(const std::filesystem::path& root, const std::string& mappingFilename, const std::string& warpFilename)
+{
+    stop();
+    this->root = root;
+    this->mappingFilename = mappingFilename;
+    this->warpFilename = warpFilename;
+    running = true;
+    thread = std::thread(&RemoteMappingWatcher::threadedFunction, this);
+}
+
+void RemoteMappingWatcher::stop()
+{
+    running = false;
+    if(thread.joinable()){
+        thread.join();
+    }
+}
+
+std::vector<RemoteMappingWatcher::Change> RemoteMappingWatcher::takeChanges()
+{
+    std::vector<Change> taken;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::swap(taken, changes);
+    return taken;
+}
+
+size_t RemoteMappingWatcher::hashContents(const std::string& contents)
+{
+    return std::hash<std::string>()(contents);
+}
+
+void RemoteMappingWatcher::threadedFunction()
+{
+#ifdef TARGET_LINUX
+    if(!forcePolling && watchInotify()){
+        return;
+    }
+#endif
+    watchPolling();
+}
+
+bool RemoteMappingWatcher::handleChangedFile(const std::filesystem::path& file)
+{
+    Change change;
+    change.path = file;
+
+    std::vector<std::string> parts;
+    for(auto & part : file.lexically_relative(root)){
+        parts.push_back(part.string());
+    }
+
+    if(parts.size() == 1 && parts[0] == mappingFilename){
+        // mapper level file, leave warp and preset empty
+    }else if(parts.size() == 3 && parts[2] == warpFilename){
+        change.warpName = parts[0];
+        change.preset = parts[1];
+    }else{
+        return true;
+    }
+
+    std::ifstream in(file, std::ios::binary);
+    if(!in) return false;
+    std::string contents((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if(contents.empty()) return false;
+
+    bool parsed = change.warpName.empty() ? reader.read(contents, change.mapping) : reader.read(contents, change.warp);
+    if(!parsed) return false;
+    change.hash = hashContents(contents);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    // A newer version of the same file replaces one that hasn't been applied yet.
+    auto found = std::find_if(changes.begin(), changes.end(), [&file](const Change& c){
+        return c.path == file;
+    });
+    if(found != changes.end()){
+        changes.erase(found);
+    }
+    changes.emplace_back(std::move(change));
+    return true;
+}
+
+#ifdef TARGET_LINUX
+bool RemoteMappingWatcher::watchInotify()
+{
+    int fd = inotify_init1(IN_NONBLOCK);
+    if(fd < 0){
+        ofLogWarning("RemoteMappingWatcher") << "inotify unavailable, falling back to polling";
+        return false;
+    }
+
+    const uint32_t fileMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF;
+    std::map<int, std::filesystem::path> watches;
+
+    // root, warp and preset directories are watched, deeper levels never hold mapping files.
+    std::function<void(const std::filesystem::path&, int)> addWatch = [&](const std::filesystem::path& dir, int depth){
+        int wd = inotify_add_watch(fd, dir.string().c_str(), fileMask);
+        if(wd < 0) return;
+        watches[wd] = dir;
+        if(depth >= 2) return;
+        std::error_code ec;
+        for(auto & entry : std::filesystem::directory_iterator(dir, ec)){
+            if(entry.is_directory()){
+                addWatch(entry.path(), depth + 1);
+            }
+        }
+    };
+    addWatch(root, 0);
+
+    if(watches.empty()){
+        close(fd);
+        ofLogWarning("RemoteMappingWatcher") << "couldn't watch " << root << ", falling back to polling";
+        return false;
+    }
+
+    alignas(inotify_event) char buffer[4096];
+    while(running){
+        pollfd pfd{fd, POLLIN, 0};
+        if(poll(&pfd, 1, 200) <= 0) continue;
+
+        ssize_t length;
+        while((length = read(fd, buffer, sizeof(buffer))) > 0){
+            for(char* ptr = buffer; ptr < buffer + length; ){
+                auto event = reinterpret_cast<const inotify_event*>(ptr);
+                ptr += sizeof(inotify_event) + event->len;
+
+                auto dir = watches.find(event->wd);
+                if(dir == watches.end()) continue;
+
+                if(event->mask & IN_DELETE_SELF){
+                    watches.erase(dir);
+                    continue;
+                }
+                if(event->len == 0) continue;
+
+                auto path = dir->second/event->name;
+                if(event->mask & IN_ISDIR){
+                    auto depth = std::distance(path.lexically_relative(root).begin(), path.lexically_relative(root).end());
+                    if(depth <= 2){
+                        addWatch(path, depth);
+                        // Files may have landed before the watch was in place.
+                        std::error_code ec;
+                        for(auto & entry : std::filesystem::recursive_directory_iterator(path, ec)){
+                            if(entry.is_regular_file() && !handleChangedFile(entry.path())){
+                                ofLogWarning("RemoteMappingWatcher") << "ignoring unparsable mapping file " << entry.path();
+                            }
+                        }
+                    }
+                }else if(event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)){
+                    // The writer is done with the file, a failure won't fix itself.
+                    if(!handleChangedFile(path)){
+                        ofLogWarning("RemoteMappingWatcher") << "ignoring unparsable mapping file " << path;
+                    }
+                }
+            }
+        }
+    }
+
+    close(fd);
+    return true;
+}
+#endif
+
+void RemoteMappingWatcher::watchPolling()
+{
+    // A file's write time and size, a file still being written may keep its write time once it is complete.
+    typedef std::pair<std::filesystem::file_time_type, uintmax_t> Stamp;
+    std::map<std::filesystem::path, Stamp> applied;
+    std::map<std::filesystem::path, Stamp> failed;
+
+    auto scan = [&](bool notify){
+        std::error_code ec;
+        auto check = [&](const std::filesystem::path& file){
+            Stamp stamp(std::filesystem::last_write_time(file, ec), 0);
+            if(ec) return;
+            stamp.second = std::filesystem::file_size(file, ec);
+            if(ec) return;
+            auto & known = applied[file];
+            if(known == stamp) return;
+            
+            if(!notify || handleChangedFile(file)){
+                known = stamp;
+                failed.erase(file);
+                return;
+            }
+            // Probably caught mid write, read it again next poll. once it fails twice unchanged it is broken.
+            auto found = failed.find(file);
+            if(found != failed.end() && found->second == stamp){
+                ofLogWarning("RemoteMappingWatcher") << "ignoring unparsable mapping file " << file;
+                known = stamp;
+                failed.erase(found);
+            }else{
+                failed[file] = stamp;
+            }
+        };
+
+        check(root/mappingFilename);
+        for(auto & warpDir : std::filesystem::directory_iterator(root, ec)){
+            if(!warpDir.is_directory()) continue;
+            for(auto & presetDir : std::filesystem::directory_iterator(warpDir.path(), ec)){
+                if(presetDir.is_directory()){
+                    check(presetDir.path()/warpFilename);
+                }
+            }
+        }
+    };
+
+    scan(false);
+    auto interval = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<float>(pollInterval));
+    auto next = std::chrono::steady_clock::now() + interval;
+    while(running){
+        // Sleep in short steps so stop() doesn't wait for a whole interval.
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        if(std::chrono::steady_clock::now() < next) continue;
+        scan(true);
+        next = std::chrono::steady_clock::now() + interval;
+    }
+}
@@ -0,0 +1,76 @@
+//
+//  RemoteMappingWatcher.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "RemoteWarpJson.h"
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+//! watches a mapper's save location for mapping files changed by another process.
+//! changed files are read and parsed on a background thread, the mapper collects the results
+//! with takeChanges() at a frame boundary. uses inotify on linux and polls everywhere else.
+class RemoteMappingWatcher {
+public:
+
+    struct Change {
+        //! empty for the mapper's ProjectionMapping.json
+        std::string warpName;
+        std::string preset;
+        std::filesystem::path path;
+        //! parsed contents, mapping for ProjectionMapping.json and warp for a warp's controlpoints.json
+        MappingRecord mapping;
+        WarpRecord warp;
+        //! hash of the file contents, lets warps skip files they wrote themselves
+        size_t hash{0};
+    };
+
+    RemoteMappingWatcher() = default;
+    ~RemoteMappingWatcher();
+
+    RemoteMappingWatcher(const RemoteMappingWatcher&) = delete;
+    RemoteMappingWatcher& operator=(const RemoteMappingWatcher&) = delete;
+
+    void start(const std::filesystem::path& root, const std::string& mappingFilename, const std::string& warpFilename);
+    void stop();
+    bool isRunning() const { return running; }
+
+    //! force the polling backend, even where inotify is available
+    void setPolling(bool polling, float intervalSeconds = .5f){ forcePolling = polling; pollInterval = intervalSeconds; }
+
+    //! return the changes parsed since the last call, oldest first
+    std::vector<Change> takeChanges();
+
+    static size_t hashContents(const std::string& contents);
+
+private:
+
+    void threadedFunction();
+#ifdef TARGET_LINUX
+    bool watchInotify();
+#endif
+    void watchPolling();
+
+    //! classify a changed path and queue it if it is one of the mapping files. returns false if a mapping file couldn't be
+    //! read or parsed, it may still be being written
+    bool handleChangedFile(const std::filesystem::path& file);
+
+    std::filesystem::path root;
+    std::string mappingFilename;
+    std::string warpFilename;
+
+    std::thread thread;
+    std::atomic<bool> running{false};
+    bool forcePolling{false};
+    float pollInterval{.5f};
+
+    //! only used on the watcher thread
+    WarpJsonReader reader;
+
+    std::mutex mutex;
+    std::vector<Change> changes;
+};
@@ -0,0 +1,403 @@
+//
+//  RemoteMeshBuilder.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteMeshBuilder.h"
+
+#include <algorithm>
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::build()
+{
+    this->patches.clear();
+    this->buildMesh();
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::buildMesh()
+{
+    auto quads = RemoteMeshBuilder::getQuads(this->settings, this->controlPoints);
+    this->setup(quads.x, quads.y);
+    
+    if (this->settings.tolerance > 0.0f)
+    {
+        this->updatePatches(glm::ivec2(0), glm::ivec2(-1));
+        this->tessellate();
+        this->mesh.compact.clear();
+        this->pack(0, this->mesh.resolutionX - 1);
+    }
+    else
+    {
+        // Build placeholder data, update fills it in.
+        this->mesh.tessellated = false;
+        this->mesh.texCoords.clear();
+        this->mesh.indices.clear();
+        this->mesh.compact.clear();
+        this->mesh.positions.assign(this->mesh.resolutionX * this->mesh.resolutionY, glm::vec2(0.0f));
+        this->update(glm::ivec2(0), glm::ivec2(this->settings.numControlsX - 1, this->settings.numControlsY - 1));
+    }
+    this->mesh.rebuilt = true;
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::clearChanges()
+{
+    this->mesh.rebuilt = false;
+    this->mesh.firstColumn = 0;
+    this->mesh.lastColumn = -1;
+}
+
+//--------------------------------------------------------------
+size_t RemoteMeshBuilder::getCapacityBytes() const
+{
+    return this->controlPoints.capacity() * sizeof(glm::vec2) + this->mesh.positions.capacity() * sizeof(glm::vec2)
+        + this->mesh.texCoords.capacity() * sizeof(glm::vec2) + this->mesh.indices.capacity() * sizeof(uint32_t)
+        + this->mesh.compact.capacity() * sizeof(RemoteCompactVertex)
+        + this->patches.capacity() * sizeof(RemotePatch) + this->leaves.capacity() * sizeof(glm::ivec4) + this->gridIndices.capacity() * sizeof(int32_t);
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::setup(int resolutionX, int resolutionY)
+{
+    // Convert from number of quads to number of vertices.
+    ++resolutionX;
+    ++resolutionY;
+    
+    // Find a value for resolutionX and resolutionY that can be evenly divided by numControlsX and numControlsY.
+    if (this->settings.numControlsX < resolutionX)
+    {
+        int dx = (resolutionX - 1) % (this->settings.numControlsX - 1);
+        if (dx >= (this->settings.numControlsX / 2))
+        {
+            dx -= (this->settings.numControlsX - 1);
+        }
+        resolutionX -= dx;
+    }
+    else
+    {
+        resolutionX = this->settings.numControlsX;
+    }
+    
+    if (this->settings.numControlsY < resolutionY)
+    {
+        int dy = (resolutionY - 1) % (this->settings.numControlsY - 1);
+        if (dy >= (this->settings.numControlsY / 2))
+        {
+            dy -= (this->settings.numControlsY - 1);
+        }
+        resolutionY -= dy;
+    }
+    else
+    {
+        resolutionY = this->settings.numControlsY;
+    }
+    
+    this->mesh.resolutionX = resolutionX;
+    this->mesh.resolutionY = resolutionY;
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::update(const glm::ivec2 & firstControl, const glm::ivec2 & lastControl)
+{
+    if (this->controlPoints.size() != size_t(this->settings.numControlsX * this->settings.numControlsY)) return;
+    
+    // A control point shapes the patches up to two columns and rows before it and one after it,
+    // or only the two patches it is a corner of when interpolating linearly.
+    auto before = this->settings.linear ? 1 : 2;
+    auto after = this->settings.linear ? 0 : 1;
+    auto numPatches = glm::ivec2(this->settings.numControlsX - 1, this->settings.numControlsY - 1);
+    auto firstPatch = glm::max(firstControl - before, glm::ivec2(0));
+    auto lastPatch = glm::min(lastControl + after, numPatches - 1);
+    this->updatePatches(firstPatch, lastPatch);
+    
+    // How far a point reaches into a tessellated mesh depends on the whole surface.
+    if (this->mesh.tessellated || this->settings.tolerance > 0.0f)
+    {
+        this->buildMesh();
+        return;
+    }
+    
+    if (this->mesh.positions.size() != size_t(this->mesh.resolutionX * this->mesh.resolutionY)) return;
+    
+    // setup picks resolutions that divide evenly into the control grid.
+    auto stepX = (this->mesh.resolutionX - 1) / (this->settings.numControlsX - 1);
+    auto stepY = (this->mesh.resolutionY - 1) / (this->settings.numControlsY - 1);
+    // The last patches hold the far edges as well.
+    auto firstX = firstPatch.x * stepX;
+    auto lastX = lastPatch.x == numPatches.x - 1 ? this->mesh.resolutionX - 1 : lastPatch.x * stepX + stepX - 1;
+    auto firstY = firstPatch.y * stepY;
+    auto lastY = lastPatch.y == numPatches.y - 1 ? this->mesh.resolutionY - 1 : lastPatch.y * stepY + stepY - 1;
+    
+    for (auto x = firstX; x <= lastX; ++x)
+    {
+        auto col = std::min(x / stepX, numPatches.x - 1);
+        auto u = (x - col * stepX) / (float)stepX;
+        auto column = this->mesh.positions.data() + x * this->mesh.resolutionY;
+        for (auto y = firstY; y <= lastY;)
+        {
+            // Run down the column one patch at a time, the patch is a cubic in v along it.
+            auto row = std::min(y / stepY, numPatches.y - 1);
+            auto end = row == numPatches.y - 1 ? lastY : std::min((row + 1) * stepY - 1, lastY);
+            glm::vec2 cubic[4];
+            this->getPatch(col, row).column(u, cubic);
+            RemoteGeometry::forwardDifference(cubic, (y - row * stepY) / (float)stepY, 1.0f / stepY, end - y + 1, column + y);
+            y = end + 1;
+        }
+    }
+    
+    if (this->mesh.firstColumn <= this->mesh.lastColumn)
+    {
+        this->mesh.firstColumn = std::min(this->mesh.firstColumn, firstX);
+        this->mesh.lastColumn = std::max(this->mesh.lastColumn, lastX);
+    }
+    else
+    {
+        this->mesh.firstColumn = firstX;
+        this->mesh.lastColumn = lastX;
+    }
+    
+    this->pack(firstX, lastX);
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::pack(int firstColumn, int lastColumn)
+{
+    auto & compact = this->mesh.compact;
+    bool packed = !compact.empty();
+    if (!this->settings.compact)
+    {
+        compact.clear();
+        this->mesh.rebuilt |= packed;
+        return;
+    }
+    
+    auto & positions = this->mesh.positions;
+    auto first = firstColumn * this->mesh.resolutionY;
+    auto count = (lastColumn - firstColumn + 1) * this->mesh.resolutionY;
+    if (packed && compact.size() == positions.size() && RemoteCompactMesh::contains(this->mesh.compactBounds, positions.data() + first, count))
+    {
+        RemoteCompactMesh::encodePositions(positions.data() + first, count, this->mesh.compactBounds, compact.data() + first);
+        return;
+    }
+    
+    // The positions moved out of their bounds, pack everything again.
+    this->mesh.compactBounds = RemoteCompactMesh::getBounds(positions.data(), positions.size(), RemoteCompactMesh::sMargin);
+    compact.resize(positions.size());
+    auto error = RemoteCompactMesh::encodePositions(positions.data(), positions.size(), this->mesh.compactBounds, compact.data());
+    if (this->mesh.tessellated)
+    {
+        RemoteCompactMesh::encodeTexCoords(this->mesh.texCoords.data(), this->mesh.texCoords.size(), compact.data());
+    }
+    else
+    {
+        RemoteCompactMesh::encodeGridTexCoords(this->mesh.resolutionX, this->mesh.resolutionY, compact.data());
+    }
+    if (error > RemoteCompactMesh::sBudget)
+    {
+        compact.clear();
+    }
+    this->mesh.rebuilt |= packed != !compact.empty();
+    this->mesh.firstColumn = 0;
+    this->mesh.lastColumn = this->mesh.resolutionX - 1;
+}
+
+//--------------------------------------------------------------
+glm::ivec2 RemoteMeshBuilder::getQuads(const Settings & settings, const std::vector<glm::vec2> & controlPoints)
+{
+    if (settings.adaptive)
+    {
+        // Determine a suitable mesh resolution based on the dimensions of the window
+        // and the size of the mesh in pixels.
+        auto meshSize = RemoteMeshBuilder::getMeshSize(controlPoints, settings.windowSize);
+        return glm::ivec2(meshSize.x / settings.resolution, meshSize.y / settings.resolution);
+    }
+    else
+    {
+        // Use a fixed mesh resolution.
+        return glm::ivec2(settings.size.x / settings.resolution, settings.size.y / settings.resolution);
+    }
+}
+
+//--------------------------------------------------------------
+glm::vec2 RemoteMeshBuilder::getMeshSize(const std::vector<glm::vec2> & controlPoints, const glm::vec2 & windowSize)
+{
+    auto min = glm::vec2(1.0f);
+    auto max = glm::vec2(0.0f);
+    
+    for (auto & pt : controlPoints)
+    {
+        min = glm::min(pt, min);
+        max = glm::max(pt, max);
+    }
+    
+    return (max - min) * windowSize;
+}
+
+//--------------------------------------------------------------
+glm::vec2 RemoteMeshBuilder::evaluate(float u, float v) const
+{
+    // Determine col and row, the far edges belong to the last patches.
+    auto col = std::min((int)u, this->settings.numControlsX - 2);
+    auto row = std::min((int)v, this->settings.numControlsY - 2);
+    
+    // Normalize coordinates to [0..1]
+    return this->getPatch(col, row).evaluate(u - col, v - row);
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::updatePatches(const glm::ivec2 & firstPatch, const glm::ivec2 & lastPatch)
+{
+    auto columns = this->settings.numControlsX - 1;
+    auto rows = this->settings.numControlsY - 1;
+    auto first = firstPatch;
+    auto last = lastPatch;
+    if (this->patches.size() != size_t(columns * rows) || this->patchesLinear != this->settings.linear || this->patchesScale != this->settings.windowSize)
+    {
+        this->patches.resize(columns * rows);
+        this->patchesLinear = this->settings.linear;
+        this->patchesScale = this->settings.windowSize;
+        first = glm::ivec2(0);
+        last = glm::ivec2(columns - 1, rows - 1);
+    }
+    
+    for (auto col = first.x; col <= last.x; ++col)
+    {
+        for (auto row = first.y; row <= last.y; ++row)
+        {
+            auto & patch = this->patches[col * rows + row];
+            if (this->settings.linear)
+            {
+                patch = RemotePatch::bilinear(this->getPoint(col, row) * this->settings.windowSize, this->getPoint(col + 1, row) * this->settings.windowSize,
+                                              this->getPoint(col, row + 1) * this->settings.windowSize, this->getPoint(col + 1, row + 1) * this->settings.windowSize);
+            }
+            else
+            {
+                glm::vec2 knots[16];
+                for (int i = 0; i < 4; ++i)
+                {
+                    for (int j = 0; j < 4; ++j)
+                    {
+                        knots[i * 4 + j] = this->getPoint(col + i - 1, row + j - 1) * this->settings.windowSize;
+                    }
+                }
+                patch = RemotePatch::catmullRom(knots);
+            }
+        }
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::tessellate()
+{
+    auto resolutionX = this->mesh.resolutionX;
+    auto resolutionY = this->mesh.resolutionY;
+    auto stepX = (resolutionX - 1) / (this->settings.numControlsX - 1);
+    auto stepY = (resolutionY - 1) / (this->settings.numControlsY - 1);
+    this->gridScale = glm::vec2((this->settings.numControlsX - 1) / (float)(resolutionX - 1), (this->settings.numControlsY - 1) / (float)(resolutionY - 1));
+    
+    // Subdivide every patch on its own, so flat ones stay a single quad.
+    this->leaves.clear();
+    for (auto col = 0; col < this->settings.numControlsX - 1; ++col)
+    {
+        for (auto row = 0; row < this->settings.numControlsY - 1; ++row)
+        {
+            this->subdivide(col * stepX, row * stepY, (col + 1) * stepX, (row + 1) * stepY);
+        }
+    }
+    
+    // Number the corners of the leaves column by column, like the vertices of a regular mesh.
+    this->gridIndices.assign(resolutionX * resolutionY, -1);
+    for (auto & leaf : this->leaves)
+    {
+        this->gridIndices[leaf.x * resolutionY + leaf.y] = 0;
+        this->gridIndices[leaf.z * resolutionY + leaf.y] = 0;
+        this->gridIndices[leaf.x * resolutionY + leaf.w] = 0;
+        this->gridIndices[leaf.z * resolutionY + leaf.w] = 0;
+    }
+    auto & positions = this->mesh.positions;
+    auto & texCoords = this->mesh.texCoords;
+    auto & indices = this->mesh.indices;
+    positions.clear();
+    texCoords.clear();
+    indices.clear();
+    for (auto x = 0; x < resolutionX; ++x)
+    {
+        for (auto y = 0; y < resolutionY; ++y)
+        {
+            auto & index = this->gridIndices[x * resolutionY + y];
+            if (index < 0) continue;
+            index = (int32_t)positions.size();
+            positions.push_back(this->evaluateGrid(x, y));
+            texCoords.push_back(glm::vec2(x / (float)(resolutionX - 1), y / (float)(resolutionY - 1)));
+        }
+    }
+    
+    // A leaf next to smaller ones has their corners on its edges. Leaving them out would open cracks, so those leaves
+    // are split into a fan around their center that runs through every vertex on their edges.
+    static thread_local std::vector<uint32_t> outline;
+    for (auto & leaf : this->leaves)
+    {
+        outline.clear();
+        auto add = [&](int x, int y){
+            auto index = this->gridIndices[x * resolutionY + y];
+            if (index >= 0) outline.push_back(index);
+        };
+        for (auto x = leaf.x; x < leaf.z; ++x) add(x, leaf.y);
+        for (auto y = leaf.y; y < leaf.w; ++y) add(leaf.z, y);
+        for (auto x = leaf.z; x > leaf.x; --x) add(x, leaf.w);
+        for (auto y = leaf.w; y > leaf.y; --y) add(leaf.x, y);
+        
+        if (outline.size() == 4)
+        {
+            // Same triangles as a quad of a regular mesh.
+            indices.insert(indices.end(), {outline[0], outline[1], outline[2], outline[0], outline[2], outline[3]});
+        }
+        else
+        {
+            auto center = glm::vec2(leaf.x + leaf.z, leaf.y + leaf.w) * 0.5f;
+            auto centerIndex = (uint32_t)positions.size();
+            positions.push_back(this->evaluateGrid(center.x, center.y));
+            texCoords.push_back(center / glm::vec2(resolutionX - 1, resolutionY - 1));
+            for (size_t i = 0; i < outline.size(); ++i)
+            {
+                indices.insert(indices.end(), {centerIndex, outline[i], outline[(i + 1) % outline.size()]});
+            }
+        }
+    }
+    
+    this->mesh.tessellated = true;
+}
+
+//--------------------------------------------------------------
+void RemoteMeshBuilder::subdivide(int x0, int y0, int x1, int y1)
+{
+    if (x1 - x0 > 1 || y1 - y0 > 1)
+    {
+        // How far the two triangles of the area are off the surface at its center and the middle of its edges.
+        auto p00 = this->evaluateGrid(x0, y0);
+        auto p10 = this->evaluateGrid(x1, y0);
+        auto p01 = this->evaluateGrid(x0, y1);
+        auto p11 = this->evaluateGrid(x1, y1);
+        auto mx = (x0 + x1) * 0.5f;
+        auto my = (y0 + y1) * 0.5f;
+        auto error = glm::length(this->evaluateGrid(mx, my) - (p00 + p11) * 0.5f);
+        error = std::max(error, glm::length(this->evaluateGrid(mx, y0) - (p00 + p10) * 0.5f));
+        error = std::max(error, glm::length(this->evaluateGrid(mx, y1) - (p01 + p11) * 0.5f));
+        error = std::max(error, glm::length(this->evaluateGrid(x0, my) - (p00 + p01) * 0.5f));
+        error = std::max(error, glm::length(this->evaluateGrid(x1, my) - (p10 + p11) * 0.5f));
+        
+        if (error > this->settings.tolerance)
+        {
+            // Areas one vertex wide are only split along the other axis.
+            auto cx = x1 - x0 > 1 ? (x0 + x1) / 2 : x1;
+            auto cy = y1 - y0 > 1 ? (y0 + y1) / 2 : y1;
+            this->subdivide(x0, y0, cx, cy);
+            if (cx < x1) this->subdivide(cx, y0, x1, cy);
+            if (cy < y1) this->subdivide(x0, cy, cx, y1);
+            if (cx < x1 && cy < y1) this->subdivide(cx, cy, x1, y1);
+            return;
+        }
+    }
+    this->leaves.push_back(glm::ivec4(x0, y0, x1, y1));
+}
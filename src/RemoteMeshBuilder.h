@@ -0,0 +1,117 @@
+//
+//  RemoteMeshBuilder.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "RemoteGeometry.h"
+
+#include <cstdint>
+
+//! computes the mesh of a bilinear warp from a copy of its control points. like the rest of RemoteGeometry it never touches
+//! GL or openFrameworks, so it can run on any thread, the warp uploads the result.
+class RemoteMeshBuilder {
+public:
+
+    //! everything about the warp the mesh depends on besides the control points
+    struct Settings {
+        int numControlsX{2};
+        int numControlsY{2};
+        //! linear or curved interpolation
+        bool linear{false};
+        //! pick the mesh resolution from the size of the mesh on screen
+        bool adaptive{true};
+        //! detail of the generated mesh, higher is coarser
+        int resolution{16};
+        //! pixels the mesh may deviate from the interpolated surface. above 0 every patch is subdivided only as far as it needs to,
+        //! down to the detail of resolution, otherwise the mesh is a regular grid
+        float tolerance{0.0f};
+        //! pack the vertices into RemoteCompactVertex as well
+        bool compact{false};
+        //! size of the warp's content
+        glm::vec2 size;
+        glm::vec2 windowSize;
+    };
+
+    struct Mesh {
+        //! number of vertices along each axis
+        int resolutionX{0};
+        int resolutionY{0};
+        //! vertices are stored column by column, indices and texture coordinates only depend on the resolution, see RemoteMeshTopology
+        std::vector<glm::vec2> positions;
+        //! set when the whole mesh was built, everything has to be uploaded
+        bool rebuilt{false};
+        //! otherwise the columns of vertices that were updated, none when first > last
+        int firstColumn{0};
+        int lastColumn{-1};
+        //! set when the mesh was tessellated to a tolerance. it carries its own texture coordinates and triangle indices, and is
+        //! always rebuilt as a whole. resolutionX and resolutionY are the finest grid it was tessellated on
+        bool tessellated{false};
+        std::vector<glm::vec2> texCoords;
+        std::vector<uint32_t> indices;
+        //! with Settings::compact, every vertex packed with its texture coordinate, and the bounds the positions were packed in.
+        //! empty when the mesh is too large to pack within RemoteCompactMesh::sBudget, it's drawn from positions then. the
+        //! changed columns cover the packed vertices as well
+        std::vector<RemoteCompactVertex> compact;
+        glm::vec4 compactBounds{0.0f, 0.0f, 1.0f, 1.0f};
+    };
+
+    //! build the whole mesh for settings and controlPoints
+    void build();
+    //! update only the vertices influenced by the control points between the first and last column and row,
+    //! tessellated meshes are rebuilt
+    void update(const glm::ivec2 & firstControl, const glm::ivec2 & lastControl);
+    //! forget what changed, called once the changes were uploaded or handed on
+    void clearChanges();
+    //! bytes allocated for the control points and the mesh
+    size_t getCapacityBytes() const;
+    //! number of quads along each axis the mesh is set up for, with adaptive settings it follows the size of the control
+    //! points on screen. the mesh resolution only changes when this does
+    static glm::ivec2 getQuads(const Settings & settings, const std::vector<glm::vec2> & controlPoints);
+
+    //! inputs
+    Settings settings;
+    std::vector<glm::vec2> controlPoints;
+
+    //! output
+    Mesh mesh;
+
+private:
+
+    //! build the mesh from the patches, those that are out of date are recomputed
+    void buildMesh();
+    //! pick the number of vertices for a number of quads along each axis
+    void setup(int resolutionX, int resolutionY);
+    //! size of the control points' bounding box on screen
+    static glm::vec2 getMeshSize(const std::vector<glm::vec2> & controlPoints, const glm::vec2 & windowSize);
+    //! the surface at u, v in [0..numControls - 1], in window pixels
+    glm::vec2 evaluate(float u, float v) const;
+    //! recompute the patches from first to last, or all of them if the control grid or its interpolation changed since
+    void updatePatches(const glm::ivec2 & firstPatch, const glm::ivec2 & lastPatch);
+    inline const RemotePatch & getPatch(int col, int row) const { return this->patches[col * (this->settings.numControlsY - 1) + row]; }
+    
+    //! pack the vertices of columns first to last, or all of them with new bounds when they moved out of the old ones.
+    //! switching between packed and float vertices marks the mesh rebuilt
+    void pack(int firstColumn, int lastColumn);
+    
+    //! build a mesh whose patches are subdivided until they're within tolerance of the surface, on the grid of setup
+    void tessellate();
+    //! split the area between vertices x0, y0 and x1, y1 of the grid into quarters until it's flat enough, collecting the leaves
+    void subdivide(int x0, int y0, int x1, int y1);
+    //! the surface at vertex x, y of the grid setup picked
+    inline glm::vec2 evaluateGrid(float x, float y) const { return this->evaluate(x * this->gridScale.x, y * this->gridScale.y); }
+    
+    //! every patch between the control points in window pixels, column by column, and the settings they were computed for.
+    //! cleared by build, since the control points may have changed anywhere
+    std::vector<RemotePatch> patches;
+    bool patchesLinear{false};
+    glm::vec2 patchesScale;
+    
+    //! tessellation scratch: areas that are flat enough as (x0, y0, x1, y1), the vertex index of every grid vertex a leaf
+    //! has a corner on, -1 for the rest, and the conversion from grid vertices to [0..numControls - 1]
+    std::vector<glm::ivec4> leaves;
+    std::vector<int32_t> gridIndices;
+    glm::vec2 gridScale;
+    inline glm::vec2 getPoint(int col, int row) const { return RemoteControlGrid::getPoint(this->controlPoints, this->settings.numControlsX, this->settings.numControlsY, col, row); }
+};
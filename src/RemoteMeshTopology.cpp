@@ -0,0 +1,157 @@
+//
+//  RemoteMeshTopology.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteMeshTopology.h"
+#include "RemoteGeometry.h"
+
+RemoteMeshTopology::Primitive RemoteMeshTopology::sPrimitive = RemoteMeshTopology::PRIMITIVE_TRIANGLES;
+std::map<std::tuple<int, int, RemoteMeshTopology::Primitive>, std::weak_ptr<RemoteMeshTopology>> RemoteMeshTopology::sTopologies;
+
+void RemoteMeshTopology::setPrimitive(Primitive primitive)
+{
+    sPrimitive = primitive;
+}
+
+RemoteMeshTopology::Primitive RemoteMeshTopology::getPrimitive()
+{
+    return sPrimitive;
+}
+
+std::shared_ptr<RemoteMeshTopology> RemoteMeshTopology::get(int resolutionX, int resolutionY)
+{
+    auto & cached = sTopologies[std::make_tuple(resolutionX, resolutionY, sPrimitive)];
+    auto topology = cached.lock();
+    if(!topology){
+        topology = std::make_shared<RemoteMeshTopology>(resolutionX, resolutionY, sPrimitive);
+        cached = topology;
+
+        // Drop the resolutions no warp uses anymore.
+        for(auto it = sTopologies.begin(); it != sTopologies.end();){
+            if(it->second.expired()){
+                it = sTopologies.erase(it);
+            }else{
+                ++it;
+            }
+        }
+    }
+    return topology;
+}
+
+void RemoteMeshTopology::getCachedBytes(size_t & texCoordBytes, size_t & indexBytes)
+{
+    texCoordBytes = 0;
+    indexBytes = 0;
+    for(auto & cached : sTopologies){
+        if(auto topology = cached.second.lock()){
+            texCoordBytes += topology->getTexCoordBytes();
+            indexBytes += topology->getIndexBytes();
+        }
+    }
+}
+
+RemoteMeshTopology::RemoteMeshTopology(int resolutionX, int resolutionY, Primitive primitive)
+: resolutionX(resolutionX)
+, resolutionY(resolutionY)
+, primitive(primitive)
+, indexType(getIndexType(resolutionX * resolutionY))
+{
+    std::vector<glm::vec2> texCoords(resolutionX * resolutionY);
+    int j = 0;
+    for (int x = 0; x < resolutionX; ++x)
+    {
+        for (int y = 0; y < resolutionY; ++y)
+        {
+            texCoords[j++] = glm::vec2(x / (float)(resolutionX - 1), y / (float)(resolutionY - 1));
+        }
+    }
+
+    indexBuffer.allocate();
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        std::vector<uint16_t> indices;
+        if (primitive == PRIMITIVE_TRIANGLE_STRIPS)
+        {
+            indices.resize(RemoteGridIndices::countTriangleStrips(resolutionX, resolutionY));
+            RemoteGridIndices::triangleStrips(resolutionX, resolutionY, std::numeric_limits<uint16_t>::max(), indices.data());
+        }
+        else
+        {
+            indices.resize(RemoteGridIndices::countTriangles(resolutionX, resolutionY));
+            RemoteGridIndices::triangles(resolutionX, resolutionY, indices.data());
+        }
+        numIndices = indices.size();
+        indexBuffer.setData(indices, GL_STATIC_DRAW);
+    }
+    else
+    {
+        std::vector<uint32_t> indices;
+        if (primitive == PRIMITIVE_TRIANGLE_STRIPS)
+        {
+            indices.resize(RemoteGridIndices::countTriangleStrips(resolutionX, resolutionY));
+            RemoteGridIndices::triangleStrips(resolutionX, resolutionY, std::numeric_limits<uint32_t>::max(), indices.data());
+        }
+        else
+        {
+            indices.resize(RemoteGridIndices::countTriangles(resolutionX, resolutionY));
+            RemoteGridIndices::triangles(resolutionX, resolutionY, indices.data());
+        }
+        numIndices = indices.size();
+        indexBuffer.setData(indices, GL_STATIC_DRAW);
+    }
+    texCoordBuffer.allocate();
+    texCoordBuffer.setData(texCoords, GL_STATIC_DRAW);
+}
+
+void RemoteMeshTopology::draw(ofVbo & vbo)
+{
+    drawElements(vbo, indexBuffer, primitive == PRIMITIVE_TRIANGLE_STRIPS ? GL_TRIANGLE_STRIP : GL_TRIANGLES, numIndices, indexType);
+}
+
+void RemoteMeshTopology::draw(GLuint vertexArray)
+{
+    drawElements(vertexArray, indexBuffer, primitive == PRIMITIVE_TRIANGLE_STRIPS ? GL_TRIANGLE_STRIP : GL_TRIANGLES, numIndices, indexType);
+}
+
+void RemoteMeshTopology::drawElements(ofVbo & vbo, ofBufferObject & indices, GLenum mode, int count, GLenum type)
+{
+    // ofVbo only draws ofIndexType indices, so bind ours over its attributes. unbinding them again before the vbo keeps
+    // them out of its vertex array object.
+    vbo.bind();
+    indices.bind(GL_ELEMENT_ARRAY_BUFFER);
+    drawBound(mode, count, type);
+    indices.unbind(GL_ELEMENT_ARRAY_BUFFER);
+    vbo.unbind();
+}
+
+void RemoteMeshTopology::drawElements(GLuint vertexArray, ofBufferObject & indices, GLenum mode, int count, GLenum type)
+{
+    glBindVertexArray(vertexArray);
+    indices.bind(GL_ELEMENT_ARRAY_BUFFER);
+    drawBound(mode, count, type);
+    indices.unbind(GL_ELEMENT_ARRAY_BUFFER);
+    glBindVertexArray(0);
+}
+
+void RemoteMeshTopology::drawBound(GLenum mode, int count, GLenum type)
+{
+    if (mode == GL_TRIANGLE_STRIP)
+    {
+#ifdef TARGET_OPENGLES
+        glEnable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+#else
+        glEnable(GL_PRIMITIVE_RESTART);
+        glPrimitiveRestartIndex(type == GL_UNSIGNED_SHORT ? std::numeric_limits<uint16_t>::max() : std::numeric_limits<uint32_t>::max());
+#endif
+    }
+    glDrawElements(mode, count, type, nullptr);
+    if (mode == GL_TRIANGLE_STRIP)
+    {
+#ifdef TARGET_OPENGLES
+        glDisable(GL_PRIMITIVE_RESTART_FIXED_INDEX);
+#else
+        glDisable(GL_PRIMITIVE_RESTART);
+#endif
+    }
+}
@@ -0,0 +1,80 @@
+//
+//  RemoteMeshTopology.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+#include <limits>
+#include <map>
+#include <memory>
+#include <tuple>
+
+//! GPU buffers for the part of a bilinear warp's mesh that only depends on its resolution: the triangle indices and
+//! texture coordinates spanning 0 to 1, the warp's texture corners are applied in the shader. warps with the same
+//! resolution share them, they're freed when the last warp using them lets go. indices are 16 bit whenever the vertices
+//! fit, 32 bit otherwise. render thread only
+class RemoteMeshTopology {
+public:
+
+    enum Primitive {
+        //! two triangles per quad, ordered for the vertex cache
+        PRIMITIVE_TRIANGLES,
+        //! a triangle strip per column of quads, joined by primitive restart. needs GL 3.1 or GLES 3
+        PRIMITIVE_TRIANGLE_STRIPS,
+    };
+
+    //! how topologies are indexed, warps switch over on their next draw
+    static void setPrimitive(Primitive primitive);
+    static Primitive getPrimitive();
+
+    //! the topology of a grid of resolutionX by resolutionY vertices, stored column by column, with the current primitive.
+    //! uploaded on first use
+    static std::shared_ptr<RemoteMeshTopology> get(int resolutionX, int resolutionY);
+
+    RemoteMeshTopology(int resolutionX, int resolutionY, Primitive primitive);
+
+    inline int getResolutionX() const { return resolutionX; }
+    inline int getResolutionY() const { return resolutionY; }
+    inline Primitive getIndexPrimitive() const { return primitive; }
+    inline int getNumIndices() const { return numIndices; }
+    //! GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    inline GLenum getIndexType() const { return indexType; }
+    inline ofBufferObject& getIndexBuffer() { return indexBuffer; }
+    inline ofBufferObject& getTexCoordBuffer() { return texCoordBuffer; }
+    inline size_t getIndexBytes() const { return numIndices * getIndexSize(indexType); }
+    inline size_t getTexCoordBytes() const { return resolutionX * resolutionY * sizeof(glm::vec2); }
+
+    //! draw the vertices of vbo with the topology's indices, the vbo's own index data is ignored
+    void draw(ofVbo & vbo);
+    //! draw the vertices of a vertex array object with the topology's indices
+    void draw(GLuint vertexArray);
+    //! draw count indices of type from indices over the vertices of vbo. strips restart at the highest index of the type
+    static void drawElements(ofVbo & vbo, ofBufferObject & indices, GLenum mode, int count, GLenum type);
+    static void drawElements(GLuint vertexArray, ofBufferObject & indices, GLenum mode, int count, GLenum type);
+
+    //! GL_UNSIGNED_SHORT when count vertices can be indexed with 16 bits, leaving the highest index for restarts
+    static inline GLenum getIndexType(size_t count) { return count < std::numeric_limits<uint16_t>::max() ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; }
+    static inline size_t getIndexSize(GLenum type) { return type == GL_UNSIGNED_SHORT ? sizeof(uint16_t) : sizeof(uint32_t); }
+
+    //! add up the buffers of every topology in use, each counted once
+    static void getCachedBytes(size_t & texCoordBytes, size_t & indexBytes);
+
+private:
+
+    //! draw from the bound vertices and indices, with primitive restart for strips
+    static void drawBound(GLenum mode, int count, GLenum type);
+
+    int resolutionX;
+    int resolutionY;
+    Primitive primitive;
+    int numIndices;
+    GLenum indexType;
+    ofBufferObject indexBuffer;
+    ofBufferObject texCoordBuffer;
+
+    static Primitive sPrimitive;
+    static std::map<std::tuple<int, int, Primitive>, std::weak_ptr<RemoteMeshTopology>> sTopologies;
+};
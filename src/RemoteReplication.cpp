@@ -0,0 +1,389 @@
+//
+//  RemoteReplication.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteReplication.h"
+#include "RemoteWarpJournal.h"
+#include "osc/OscOutboundPacketStream.h"
+#include "osc/OscReceivedElements.h"
+#include "Poco/Exception.h"
+#include "Poco/Timespan.h"
+
+#include <random>
+
+const std::string RemoteReplication::sDeltaAddress = "/rpm/sync/delta";
+const std::string RemoteReplication::sPresetAddress = "/rpm/sync/preset";
+const std::string RemoteReplication::sBaseAddress = "/rpm/sync/base";
+const std::string RemoteReplication::sFrameAddress = "/rpm/sync/frame";
+const std::string RemoteReplication::sHelloAddress = "/rpm/sync/hello";
+const std::string RemoteReplication::sNackAddress = "/rpm/sync/nack";
+
+namespace {
+
+    // Room for the address and arguments in front of the records.
+    const size_t sPacketOverhead = 512;
+
+    bool isNewer(uint32_t sequence, uint32_t than)
+    {
+        // Compare as a signed difference so the sequence can wrap around.
+        return int32_t(sequence - than) > 0;
+    }
+
+}
+
+bool RemoteReplication::setupLeader(const std::string& group, int port)
+{
+    close();
+    try{
+        groupAddress = Poco::Net::SocketAddress(group, port);
+        socket = Poco::Net::MulticastSocket(Poco::Net::SocketAddress(Poco::Net::IPAddress(), 0));
+        // Followers on the same machine receive the group through loopback.
+        socket.setLoopback(true);
+        socket.setTimeToLive(1);
+    }catch(const Poco::Exception& e){
+        ofLogError("RemoteReplication::setupLeader") << "couldn't send to " << group << ":" << port << ": " << e.displayText();
+        return false;
+    }
+    sendBuffer.resize(RemoteReplication::sMaxRecordBytes + sPacketOverhead);
+    receiveBuffer.resize(1024);
+    history.assign(RemoteReplication::sHistorySize, Sent());
+    session = std::random_device()();
+    nextSequence = 1;
+    versions.clear();
+    // Followers that are already running have to drop what they mirrored from a previous leader.
+    resyncRequested = true;
+    role = ROLE_LEADER;
+    return true;
+}
+
+bool RemoteReplication::setupFollower(const std::string& group, int port)
+{
+    close();
+    try{
+        groupAddress = Poco::Net::SocketAddress(group, port);
+        // Reuse the address so several followers can run on one machine.
+        socket = Poco::Net::MulticastSocket(Poco::Net::SocketAddress(Poco::Net::IPAddress(), port), true);
+        socket.joinGroup(groupAddress.host());
+    }catch(const Poco::Exception& e){
+        ofLogError("RemoteReplication::setupFollower") << "couldn't join " << group << ":" << port << ": " << e.displayText();
+        return false;
+    }
+    sendBuffer.resize(sPacketOverhead);
+    receiveBuffer.resize(65536);
+    session = 0;
+    hasLeader = false;
+    synced = false;
+    outOfOrder.clear();
+    ready.clear();
+    leaderFrame = 0;
+    lastRequestTime = 0;
+    role = ROLE_FOLLOWER;
+    return true;
+}
+
+void RemoteReplication::close()
+{
+    if(role == ROLE_NONE) return;
+    try{
+        if(role == ROLE_FOLLOWER){
+            socket.leaveGroup(groupAddress.host());
+        }
+        socket.close();
+    }catch(const Poco::Exception& e){
+        ofLogWarning("RemoteReplication::close") << e.displayText();
+    }
+    history.clear();
+    outOfOrder.clear();
+    ready.clear();
+    role = ROLE_NONE;
+}
+
+void RemoteReplication::update()
+{
+    if(role == ROLE_NONE) return;
+
+    Poco::Net::SocketAddress from;
+    try{
+        while(socket.poll(Poco::Timespan(0), Poco::Net::Socket::SELECT_READ)){
+            auto size = socket.receiveFrom(receiveBuffer.data(), int(receiveBuffer.size()), from);
+            if(size <= 0) continue;
+            try{
+                osc::ReceivedPacket packet(receiveBuffer.data(), size);
+                if(!packet.IsMessage()) continue;
+                osc::ReceivedMessage message(packet);
+                if(role == ROLE_LEADER){
+                    receiveLeader(from, message);
+                }else{
+                    receiveFollower(from, message);
+                }
+            }catch(const osc::Exception& e){
+                ofLogWarning("RemoteReplication::update") << "dropping malformed packet from " << from.toString() << ": " << e.what();
+            }
+        }
+    }catch(const Poco::Exception& e){
+        ofLogError("RemoteReplication::update") << e.displayText();
+    }
+
+    if(role == ROLE_FOLLOWER && hasLeader){
+        auto now = ofGetElapsedTimeMillis();
+        if(!synced && now - lastRequestTime >= RemoteReplication::sRequestInterval){
+            // Ask for the whole state until a base arrives.
+            osc::OutboundPacketStream stream(sendBuffer.data(), sendBuffer.size());
+            stream << osc::BeginMessage(sHelloAddress.c_str()) << osc::EndMessage;
+            sendSize = stream.Size();
+            send(leaderAddress);
+            lastRequestTime = now;
+        }
+    }
+}
+
+void RemoteReplication::receiveLeader(const Poco::Net::SocketAddress& from, const osc::ReceivedMessage& message)
+{
+    auto address = message.AddressPattern();
+    if(sHelloAddress == address){
+        resyncRequested = true;
+    }else if(sNackAddress == address){
+        auto arg = message.ArgumentsBegin();
+        auto first = uint32_t((arg++)->AsInt32());
+        auto last = uint32_t((arg++)->AsInt32());
+        if(isNewer(first, last) || last - first >= RemoteReplication::sHistorySize){
+            resyncRequested = true;
+            return;
+        }
+        for(auto sequence = first; sequence != last + 1; ++sequence){
+            auto & sent = history[sequence % RemoteReplication::sHistorySize];
+            if(sent.sequence != sequence || sent.bytes.empty()){
+                // Too old to resend, start over from the current state.
+                resyncRequested = true;
+                return;
+            }
+            // Resend to the group, followers on one machine share the port so a unicast would only reach one of them.
+            socket.sendTo(sent.bytes.data(), int(sent.bytes.size()), groupAddress);
+        }
+    }
+}
+
+void RemoteReplication::receiveFollower(const Poco::Net::SocketAddress& from, const osc::ReceivedMessage& message)
+{
+    auto address = message.AddressPattern();
+    auto arg = message.ArgumentsBegin();
+    if(sFrameAddress == address){
+        auto frameSession = uint32_t((arg++)->AsInt32());
+        leaderFrame = uint64_t((arg++)->AsInt64());
+        auto last = uint32_t((arg++)->AsInt32());
+        // The leader sends frames from the socket it listens on for hellos and nacks.
+        leaderAddress = from;
+        hasLeader = true;
+        if(frameSession != session){
+            // A different leader, wait for its base.
+            synced = false;
+        }else if(synced && !isNewer(expectedSequence, last)){
+            // Packets at the end went missing, nothing after them would reveal the gap.
+            requestMissing(last);
+        }
+        return;
+    }
+
+    auto & packet = receivedPacket;
+    if(sDeltaAddress == address){
+        packet.type = Packet::PACKET_DELTA;
+        packet.sequence = uint32_t((arg++)->AsInt32());
+        packet.warpName = (arg++)->AsString();
+        packet.version = uint32_t((arg++)->AsInt32());
+        const void* data;
+        osc::osc_bundle_element_size_t size;
+        (arg++)->AsBlob(data, size);
+        auto bytes = static_cast<const char*>(data);
+        packet.records.assign(bytes, bytes + size);
+    }else if(sPresetAddress == address){
+        packet.type = Packet::PACKET_PRESET;
+        packet.sequence = uint32_t((arg++)->AsInt32());
+        packet.warpName = (arg++)->AsString();
+        packet.preset = (arg++)->AsString();
+        auto action = (arg++)->AsInt32();
+        if(action < Packet::PRESET_LOAD || action > Packet::PRESET_DELETE) return;
+        packet.action = Packet::PresetAction(action);
+        packet.frame = uint64_t((arg++)->AsInt64());
+    }else if(sBaseAddress == address){
+        packet.type = Packet::PACKET_BASE;
+        packet.sequence = uint32_t((arg++)->AsInt32());
+        packet.session = uint32_t((arg++)->AsInt32());
+    }else{
+        return;
+    }
+    receiveSequenced(packet);
+}
+
+void RemoteReplication::receiveSequenced(Packet& packet)
+{
+    if(packet.type == Packet::PACKET_BASE){
+        if(packet.session != session){
+            // Nothing from another session is worth keeping.
+            session = packet.session;
+            synced = false;
+            outOfOrder.clear();
+        }
+        if(!synced || !isNewer(expectedSequence, packet.sequence)){
+            // Everything before the base is superseded by the state that follows it.
+            expectedSequence = packet.sequence + 1;
+            synced = true;
+            while(!outOfOrder.empty() && !isNewer(outOfOrder.begin()->first, packet.sequence)){
+                outOfOrder.erase(outOfOrder.begin());
+            }
+        }
+    }else if(!synced || isNewer(expectedSequence, packet.sequence)){
+        // Not synced yet or a duplicate.
+        return;
+    }else if(packet.sequence == expectedSequence){
+        ready.push_back(std::move(packet));
+        ++expectedSequence;
+    }else{
+        outOfOrder[packet.sequence] = std::move(packet);
+        requestMissing(outOfOrder.begin()->first - 1);
+        return;
+    }
+
+    // Hand on the packets that were waiting for this one.
+    while(!outOfOrder.empty() && outOfOrder.begin()->first == expectedSequence){
+        ready.push_back(std::move(outOfOrder.begin()->second));
+        outOfOrder.erase(outOfOrder.begin());
+        ++expectedSequence;
+    }
+}
+
+void RemoteReplication::requestMissing(uint32_t last)
+{
+    auto now = ofGetElapsedTimeMillis();
+    if(!hasLeader || now - lastRequestTime < RemoteReplication::sRequestInterval) return;
+
+    osc::OutboundPacketStream stream(sendBuffer.data(), sendBuffer.size());
+    stream << osc::BeginMessage(sNackAddress.c_str()) << int32_t(expectedSequence) << int32_t(last) << osc::EndMessage;
+    sendSize = stream.Size();
+    send(leaderAddress);
+    lastRequestTime = now;
+}
+
+bool RemoteReplication::getNextPacket(Packet& packet)
+{
+    if(ready.empty()) return false;
+    packet = std::move(ready.front());
+    ready.pop_front();
+    return true;
+}
+
+void RemoteReplication::sendRecords(const std::string& warpName, const std::vector<char>& records)
+{
+    if(role != ROLE_LEADER) return;
+
+    auto & packet = sentPacket;
+    packet.type = Packet::PACKET_DELTA;
+    packet.warpName = warpName;
+    size_t offset = 0;
+    while(offset < records.size()){
+        // Split at record boundaries, a record never spans two packets.
+        size_t end = offset;
+        while(end < records.size()){
+            auto size = RemoteWarpJournal::getRecordSize(records.data() + end, records.size() - end);
+            if(size == 0 || (end > offset && end + size - offset > RemoteReplication::sMaxRecordBytes)) break;
+            end += size;
+        }
+        if(end == offset){
+            ofLogError("RemoteReplication::sendRecords") << "dropping unreadable records for " << warpName;
+            return;
+        }
+        packet.version = ++versions[warpName];
+        packet.records.assign(records.begin() + offset, records.begin() + end);
+        sendSequenced(packet);
+        offset = end;
+    }
+}
+
+void RemoteReplication::sendPreset(const std::string& warpName, const std::string& preset, Packet::PresetAction action, uint64_t frame)
+{
+    if(role != ROLE_LEADER) return;
+
+    auto & packet = sentPacket;
+    packet.type = Packet::PACKET_PRESET;
+    packet.warpName = warpName;
+    packet.preset = preset;
+    packet.action = action;
+    packet.frame = frame;
+    sendSequenced(packet);
+}
+
+void RemoteReplication::sendBase()
+{
+    if(role != ROLE_LEADER) return;
+
+    auto & packet = sentPacket;
+    packet.type = Packet::PACKET_BASE;
+    sendSequenced(packet);
+}
+
+void RemoteReplication::sendFrame(uint64_t frame)
+{
+    if(role != ROLE_LEADER) return;
+
+    osc::OutboundPacketStream stream(sendBuffer.data(), sendBuffer.size());
+    stream << osc::BeginMessage(sFrameAddress.c_str()) << int32_t(session) << osc::int64(frame) << int32_t(nextSequence - 1) << osc::EndMessage;
+    sendSize = stream.Size();
+    send(groupAddress);
+}
+
+bool RemoteReplication::takeResyncRequest()
+{
+    bool requested = resyncRequested;
+    resyncRequested = false;
+    return requested;
+}
+
+void RemoteReplication::sendSequenced(Packet& packet)
+{
+    packet.sequence = nextSequence++;
+    encode(packet);
+    if(sendSize == 0) return;
+
+    auto & sent = history[packet.sequence % RemoteReplication::sHistorySize];
+    sent.sequence = packet.sequence;
+    sent.bytes.assign(sendBuffer.begin(), sendBuffer.begin() + sendSize);
+    send(groupAddress);
+}
+
+void RemoteReplication::encode(const Packet& packet)
+{
+    auto size = packet.records.size() + packet.warpName.size() + packet.preset.size() + sPacketOverhead;
+    if(sendBuffer.size() < size){
+        sendBuffer.resize(size);
+    }
+    sendSize = 0;
+    try{
+        osc::OutboundPacketStream stream(sendBuffer.data(), sendBuffer.size());
+        switch (packet.type) {
+            case Packet::PACKET_DELTA:
+                stream << osc::BeginMessage(sDeltaAddress.c_str()) << int32_t(packet.sequence) << packet.warpName.c_str() << int32_t(packet.version)
+                    << osc::Blob(packet.records.data(), osc::osc_bundle_element_size_t(packet.records.size())) << osc::EndMessage;
+                break;
+            case Packet::PACKET_PRESET:
+                stream << osc::BeginMessage(sPresetAddress.c_str()) << int32_t(packet.sequence) << packet.warpName.c_str() << packet.preset.c_str()
+                    << int32_t(packet.action) << osc::int64(packet.frame) << osc::EndMessage;
+                break;
+            case Packet::PACKET_BASE:
+                stream << osc::BeginMessage(sBaseAddress.c_str()) << int32_t(packet.sequence) << int32_t(session) << osc::EndMessage;
+                break;
+        }
+        sendSize = stream.Size();
+    }catch(const osc::Exception& e){
+        ofLogError("RemoteReplication::encode") << "couldn't encode packet " << packet.sequence << ": " << e.what();
+    }
+}
+
+void RemoteReplication::send(const Poco::Net::SocketAddress& address)
+{
+    if(sendSize == 0) return;
+    try{
+        socket.sendTo(sendBuffer.data(), int(sendSize), address);
+    }catch(const Poco::Exception& e){
+        ofLogError("RemoteReplication::send") << "couldn't send to " << address.toString() << ": " << e.displayText();
+    }
+}
@@ -0,0 +1,161 @@
+//
+//  RemoteReplication.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "Poco/Net/MulticastSocket.h"
+#include "Poco/Net/SocketAddress.h"
+
+#include <deque>
+#include <map>
+
+namespace osc {
+    class ReceivedMessage;
+}
+
+//! mirrors warp edits from a leader node to follower nodes over UDP multicast.
+//!
+//! leader to followers, on the multicast group:
+//! /rpm/sync/delta   i sequence, s warp, i version, b records
+//! /rpm/sync/preset  i sequence, s warp, s preset, i action, h frame
+//! /rpm/sync/base    i sequence, i session
+//! /rpm/sync/frame   i session, h frame, i last sequence
+//!
+//! followers to the leader, unicast:
+//! /rpm/sync/hello
+//! /rpm/sync/nack    i first, i last
+//!
+//! records are RemoteWarpJournal records. every packet but frame carries a sequence number, followers hand them on strictly
+//! in order and ask the leader to resend the ones they missed. when a resend isn't possible any more the leader answers with
+//! a base packet followed by the whole state of every warp, a base tells followers to forget everything sent before it.
+//! every time a node becomes leader it picks a new session, followers start over when the session changes.
+class RemoteReplication {
+public:
+
+    typedef enum
+    {
+        ROLE_NONE,
+        ROLE_LEADER,
+        ROLE_FOLLOWER
+    } Role;
+
+    struct Packet {
+
+        typedef enum
+        {
+            PACKET_DELTA,
+            PACKET_PRESET,
+            PACKET_BASE
+        } Type;
+
+        typedef enum
+        {
+            PRESET_LOAD,
+            PRESET_SAVE,
+            PRESET_DELETE
+        } PresetAction;
+
+        Type type{PACKET_DELTA};
+        uint32_t sequence{0};
+        std::string warpName;
+        //! delta: number of deltas the leader sent for the warp so far
+        uint32_t version{0};
+        std::vector<char> records;
+        //! preset: preset to load, save to or delete
+        std::string preset;
+        PresetAction action{PRESET_LOAD};
+        //! preset: leader frame to apply it on
+        uint64_t frame{0};
+        //! base: session of the leader
+        uint32_t session{0};
+    };
+
+    bool setupLeader(const std::string& group, int port);
+    bool setupFollower(const std::string& group, int port);
+    void close();
+    inline Role getRole() const { return role; }
+
+    //! leader: answer repair requests. follower: receive everything that arrived and ask for whatever is missing
+    void update();
+
+    //! leader: broadcast journal records of a warp, split at record boundaries when they don't fit one datagram
+    void sendRecords(const std::string& warpName, const std::vector<char>& records);
+    //! leader: broadcast a preset load, save or delete that every node applies on frame
+    void sendPreset(const std::string& warpName, const std::string& preset, Packet::PresetAction action, uint64_t frame);
+    //! leader: broadcast the frame that is about to be drawn, also tells followers which sequence to expect
+    void sendFrame(uint64_t frame);
+    //! leader: returns true once after a follower asked for the whole state
+    bool takeResyncRequest();
+    //! leader: start a resync, has to be followed by the state of every warp
+    void sendBase();
+
+    //! follower: take the next packet in sequence order, returns false when the next one hasn't arrived yet
+    bool getNextPacket(Packet& packet);
+    //! follower: newest frame the leader announced
+    inline uint64_t getLeaderFrame() const { return leaderFrame; }
+
+    static const std::string sDeltaAddress;
+    static const std::string sPresetAddress;
+    static const std::string sBaseAddress;
+    static const std::string sFrameAddress;
+    static const std::string sHelloAddress;
+    static const std::string sNackAddress;
+
+    //! number of sent packets the leader keeps around for resends
+    static const size_t sHistorySize = 1024;
+    //! records sent in a single delta packet, larger deltas are split
+    static const size_t sMaxRecordBytes = 8192;
+    //! milliseconds a follower waits before repeating a hello or nack
+    static const uint64_t sRequestInterval = 50;
+
+private:
+
+    //! encode and send a sequenced packet to the group, keeping it for resends
+    void sendSequenced(Packet& packet);
+    void encode(const Packet& packet);
+    void send(const Poco::Net::SocketAddress& address);
+
+    void receiveLeader(const Poco::Net::SocketAddress& from, const osc::ReceivedMessage& message);
+    void receiveFollower(const Poco::Net::SocketAddress& from, const osc::ReceivedMessage& message);
+    //! follower: put a sequenced packet in order
+    void receiveSequenced(Packet& packet);
+    //! follower: ask the leader for the packets between the expected sequence and last
+    void requestMissing(uint32_t last);
+
+    Role role{ROLE_NONE};
+    uint32_t session{0};
+    Poco::Net::MulticastSocket socket;
+    Poco::Net::SocketAddress groupAddress;
+    std::vector<char> sendBuffer;
+    size_t sendSize{0};
+    std::vector<char> receiveBuffer;
+    Packet receivedPacket;
+
+    // leader
+    uint32_t nextSequence{1};
+    std::map<std::string, uint32_t> versions;
+    struct Sent {
+        uint32_t sequence{0};
+        std::vector<char> bytes;
+    };
+    std::vector<Sent> history;
+    bool resyncRequested{false};
+    Packet sentPacket;
+
+    // follower
+    bool hasLeader{false};
+    Poco::Net::SocketAddress leaderAddress;
+    bool synced{false};
+    uint32_t expectedSequence{0};
+    //! ordered oldest first across a wrap of the sequence, they never span more than half its range
+    struct SequenceOrder {
+        inline bool operator()(uint32_t a, uint32_t b) const { return int32_t(a - b) < 0; }
+    };
+    std::map<uint32_t, Packet, SequenceOrder> outOfOrder;
+    std::deque<Packet> ready;
+    uint64_t leaderFrame{0};
+    uint64_t lastRequestTime{0};
+};
@@ -0,0 +1,54 @@
+//
+//  RemoteShadow.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <atomic>
+
+//! value shared with RemoteUI on behalf of a warp.
+//! RemoteUI writes it from the thread delivering its events while the render thread reads it back and
+//! re-syncs it after applying commands, so every access from the warps goes through an atomic load or store.
+//! RemoteUI is handed the underlying storage, which is why T must be lock free and laid out like a plain T.
+template<typename T>
+class RemoteShadow {
+public:
+
+    static_assert(std::atomic<T>::is_always_lock_free, "RemoteShadow needs a lock free atomic");
+    static_assert(sizeof(std::atomic<T>) == sizeof(T), "RemoteUI binds to the storage of the atomic");
+
+    RemoteShadow(T value = T()) : value(value) {}
+    RemoteShadow(const RemoteShadow&) = delete;
+    RemoteShadow& operator=(const RemoteShadow&) = delete;
+
+    T load() const
+    {
+        return value.load(std::memory_order_relaxed);
+    }
+
+    void store(T value)
+    {
+        this->value.store(value, std::memory_order_relaxed);
+    }
+
+    operator T() const
+    {
+        return load();
+    }
+
+    RemoteShadow& operator=(T value)
+    {
+        store(value);
+        return *this;
+    }
+
+    //! storage to hand to RUI_SHARE_PARAM, never touch it through this reference from the warp
+    T& bind()
+    {
+        return *reinterpret_cast<T*>(&value);
+    }
+
+private:
+    std::atomic<T> value;
+};
@@ -0,0 +1,63 @@
+//
+//  RemoteStatsStream.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteStatsStream.h"
+
+const std::string RemoteStatsStream::sStatsAddress = "/rpm/stats";
+
+bool RemoteStatsStream::setup(const std::string& host, int port, float interval)
+{
+    close();
+    if(!sender.setup(host, port)){
+        ofLogError("RemoteStatsStream::setup") << "couldn't send to " << host << ":" << port;
+        return false;
+    }
+    this->interval = std::max<uint64_t>(1, interval * 1000);
+    lastSent = ofGetElapsedTimeMillis();
+    frames = 0;
+    setupDone = true;
+    return true;
+}
+
+void RemoteStatsStream::close()
+{
+    if(setupDone){
+        sender.clear();
+        setupDone = false;
+    }
+}
+
+bool RemoteStatsStream::frame()
+{
+    if(!setupDone) return false;
+    ++frames;
+    auto now = ofGetElapsedTimeMillis();
+    if(now - lastSent < interval) return false;
+    lastSent = now;
+    sentFrames = frames;
+    frames = 0;
+    return true;
+}
+
+void RemoteStatsStream::send(const std::string& warpName, RemoteWarpStats& stats)
+{
+    message.clear();
+    message.setAddress(sStatsAddress);
+    message.addStringArg(warpName);
+    message.addIntArg(sentFrames);
+    for(int stage = 0; stage < RemoteWarpStats::NUM_STAGES; ++stage){
+        auto summary = stats.summarize(RemoteWarpStats::Stage(stage));
+        message.addIntArg(summary.p50);
+        message.addIntArg(summary.p99);
+        message.addIntArg(summary.max);
+    }
+    auto counters = stats.takeCounters();
+    message.addIntArg(counters.rebuilds);
+    message.addIntArg(counters.updates);
+    message.addIntArg(counters.uploads);
+    message.addInt64Arg(counters.verticesUploaded);
+    message.addInt64Arg(counters.bytesUploaded);
+    sender.sendMessage(message, false);
+}
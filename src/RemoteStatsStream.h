@@ -0,0 +1,42 @@
+//
+//  RemoteStatsStream.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOsc.h"
+#include "RemoteWarpStats.h"
+
+//! sends the stats of every warp as OSC, one message per warp per interval, so an operator can see which warp and which
+//! stage makes a show stutter without attaching a profiler.
+//!
+//! /rpm/stats  s warp, i frames, then for every RemoteWarpStats::Stage in order i p50, i p99, i max (microseconds, over the
+//!             last RemoteWarpStats::sWindow samples), then i rebuilds, i updates, i uploads, h vertices, h bytes uploaded
+//!             during the frames since the previous message
+class RemoteStatsStream {
+public:
+
+    bool setup(const std::string& host, int port, float interval);
+    void close();
+    inline bool isSetup() const { return setupDone; }
+
+    //! count a frame, returns true once the interval has passed and the warps' stats should be sent
+    bool frame();
+    //! send the stats of one warp, takes its counters
+    void send(const std::string& warpName, RemoteWarpStats& stats);
+
+    static const std::string sStatsAddress;
+
+private:
+
+    ofxOscSender sender;
+    ofxOscMessage message;
+    bool setupDone{false};
+    uint64_t interval{1000};
+    uint64_t lastSent{0};
+    int32_t frames{0};
+    //! frames counted up to the interval being sent
+    int32_t sentFrames{0};
+};
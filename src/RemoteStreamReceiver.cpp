@@ -0,0 +1,153 @@
+//
+//  RemoteStreamReceiver.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteStreamReceiver.h"
+
+const std::string RemoteStreamReceiver::sPointsAddress = "/rpm/stream/points";
+const std::string RemoteStreamReceiver::sCornersAddress = "/rpm/stream/corners";
+
+RemoteStreamReceiver::RemoteStreamReceiver()
+: publishedSlots(std::make_shared<SlotMap>())
+{
+}
+
+RemoteStreamReceiver::~RemoteStreamReceiver()
+{
+    stop();
+}
+
+bool RemoteStreamReceiver::start(int port)
+{
+    stop();
+    try{
+        socket = std::make_unique<UdpListeningReceiveSocket>(IpEndpointName(IpEndpointName::ANY_ADDRESS, port), this);
+    }catch(const std::exception& e){
+        ofLogError("RemoteStreamReceiver::start") << "couldn't listen on port " << port << ": " << e.what();
+        return false;
+    }
+    thread = std::thread([this]{
+        socket->Run();
+    });
+    return true;
+}
+
+void RemoteStreamReceiver::stop()
+{
+    if(socket){
+        socket->AsynchronousBreak();
+        if(thread.joinable()){
+            thread.join();
+        }
+        socket.reset();
+    }
+}
+
+RemoteStreamReceiver::Slot& RemoteStreamReceiver::getSlot(const std::string& warpName)
+{
+    auto found = slots.find(warpName);
+    if(found != slots.end()){
+        return *found->second;
+    }
+    auto & slot = slots[warpName];
+    slot = std::make_shared<Slot>();
+    // Publish a copy, the receiving thread may still be reading the previous one.
+    std::atomic_store(&publishedSlots, std::shared_ptr<const SlotMap>(std::make_shared<SlotMap>(slots)));
+    publishedVersion.fetch_add(1, std::memory_order_release);
+    return *slot;
+}
+
+void RemoteStreamReceiver::Slot::publish()
+{
+    auto & latest = buffers.edit();
+    std::swap(working, latest);
+    buffers.publish();
+    
+    // The consumer only reads latest, so it can be read here as well until the next publish.
+    if(latest.gridVersion > working.version){
+        working.columns = latest.columns;
+        working.rows = latest.rows;
+        working.points = latest.points;
+        working.pointVersions = latest.pointVersions;
+    }else{
+        for(size_t i = 0; i < latest.pointVersions.size(); ++i){
+            if(latest.pointVersions[i] > working.version){
+                working.points[i] = latest.points[i];
+                working.pointVersions[i] = latest.pointVersions[i];
+            }
+        }
+    }
+    if(latest.cornersVersion > working.version){
+        std::copy(latest.corners, latest.corners + 4, working.corners);
+        working.cornersVersion = latest.cornersVersion;
+    }
+    working.gridVersion = latest.gridVersion;
+    working.version = latest.version;
+}
+
+RemoteStreamReceiver::Slot* RemoteStreamReceiver::findSlot(const std::string& warpName)
+{
+    auto version = publishedVersion.load(std::memory_order_acquire);
+    if(!receivedSlots || version != receivedVersion){
+        receivedSlots = std::atomic_load(&publishedSlots);
+        receivedVersion = version;
+    }
+    auto found = receivedSlots->find(warpName);
+    return found != receivedSlots->end() ? found->second.get() : nullptr;
+}
+
+void RemoteStreamReceiver::ProcessMessage(const osc::ReceivedMessage& message, const IpEndpointName& remoteEndpoint)
+{
+    try{
+        const char* address = message.AddressPattern();
+        auto arg = message.ArgumentsBegin();
+        if(sPointsAddress == address){
+            if(message.ArgumentCount() < 5) return;
+
+            auto slot = findSlot((arg++)->AsString());
+            if(!slot) return;
+            int columns = (arg++)->AsInt32();
+            int rows = (arg++)->AsInt32();
+            int first = (arg++)->AsInt32();
+            const void* data;
+            osc::osc_bundle_element_size_t size;
+            (arg++)->AsBlob(data, size);
+
+            size_t count = size_t(size) / (2 * sizeof(float));
+            if(columns < 2 || rows < 2 || first < 0 || count == 0 || size_t(size) % (2 * sizeof(float)) != 0 || size_t(first) + count > size_t(columns) * size_t(rows)){
+                return;
+            }
+
+            auto & state = slot->edit();
+            ++state.version;
+            if(state.columns != columns || state.rows != rows){
+                // A new grid size, forget the points streamed for the old one.
+                state.columns = columns;
+                state.rows = rows;
+                state.gridVersion = state.version;
+                state.points.assign(size_t(columns) * size_t(rows), glm::vec2(0.0f));
+                state.pointVersions.assign(state.points.size(), 0);
+            }
+            std::memcpy(&state.points[first].x, data, size);
+            std::fill(state.pointVersions.begin() + first, state.pointVersions.begin() + first + count, state.version);
+            slot->publish();
+        }else if(sCornersAddress == address){
+            if(message.ArgumentCount() < 9) return;
+
+            auto slot = findSlot((arg++)->AsString());
+            if(!slot) return;
+            glm::vec2 corners[4];
+            for(auto & corner : corners){
+                corner.x = (arg++)->AsFloat();
+                corner.y = (arg++)->AsFloat();
+            }
+            auto & state = slot->edit();
+            std::copy(corners, corners + 4, state.corners);
+            state.cornersVersion = ++state.version;
+            slot->publish();
+        }
+    }catch(const osc::Exception& e){
+        ofLogWarning("RemoteStreamReceiver") << "dropping malformed message " << message.AddressPattern() << ": " << e.what();
+    }
+}
@@ -0,0 +1,103 @@
+//
+//  RemoteStreamReceiver.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include "osc/OscPacketListener.h"
+#include "ip/UdpSocket.h"
+#include "RemoteTripleBuffer.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <thread>
+
+//! receives control points and corners streamed by a tracker at a high rate.
+//!
+//! /rpm/stream/points   s warp, i columns, i rows, i first, b points
+//! /rpm/stream/corners  s warp, f x, f y (x4, top left, top right, bottom right, bottom left)
+//!
+//! points are packed like on the grid channel, little endian float32 x, y pairs in normalized warp space, column major,
+//! starting at control point first. messages are parsed on the receiving thread and merged into a latest-value slot per warp,
+//! the render thread only ever looks at the newest state and never waits for the receiver.
+class RemoteStreamReceiver : public osc::OscPacketListener {
+public:
+
+    struct State {
+        //! incremented by every message merged into the state
+        uint64_t version{0};
+        //! version of the last message that set the corners, 0 if they were never streamed
+        uint64_t cornersVersion{0};
+        glm::vec2 corners[4];
+        int columns{0};
+        int rows{0};
+        //! version of the message that changed the grid size
+        uint64_t gridVersion{0};
+        std::vector<glm::vec2> points;
+        //! version of the last message that set each point, 0 for points never streamed
+        std::vector<uint64_t> pointVersions;
+    };
+
+    //! lock-free triple buffer holding the newest state of one warp
+    class Slot {
+    public:
+
+        //! receiving thread: state the next message is merged into
+        inline State& edit(){ return working; }
+        //! receiving thread: make the edited state the newest one.
+        //! the edited state is swapped into the buffer, the stale one swapped out only catches up on what changed since
+        void publish();
+        //! render thread: return the newest state if it changed since the last call, nullptr otherwise
+        inline const State* consume(){ return buffers.consume(); }
+
+        //! render thread: version of the state applied to the warp last
+        uint64_t appliedVersion{0};
+        //! render thread: set once a grid that doesn't fit the warp has been reported
+        bool mismatchReported{false};
+
+    private:
+
+        State working;
+        RemoteTripleBuffer<State> buffers;
+    };
+
+    RemoteStreamReceiver();
+    ~RemoteStreamReceiver();
+
+    //! listen on port on a background thread
+    bool start(int port);
+    void stop();
+    inline bool isRunning() const { return socket != nullptr; }
+
+    //! render thread: return the slot of a warp, messages for warps without a slot are dropped
+    Slot& getSlot(const std::string& warpName);
+
+    static const std::string sPointsAddress;
+    static const std::string sCornersAddress;
+
+protected:
+
+    virtual void ProcessMessage(const osc::ReceivedMessage& message, const IpEndpointName& remoteEndpoint) override;
+
+private:
+
+    typedef std::map<std::string, std::shared_ptr<Slot>> SlotMap;
+
+    //! receiving thread: find the slot of a warp in the last published map
+    Slot* findSlot(const std::string& warpName);
+
+    std::unique_ptr<UdpListeningReceiveSocket> socket;
+    std::thread thread;
+
+    //! owned by the render thread, copied and published whenever a warp is added
+    SlotMap slots;
+    std::shared_ptr<const SlotMap> publishedSlots;
+    std::atomic<uint32_t> publishedVersion{0};
+
+    //! the receiving thread's copy of the published map
+    std::shared_ptr<const SlotMap> receivedSlots;
+    uint32_t receivedVersion{0};
+};
@@ -0,0 +1,124 @@
+//
+//  RemoteThreadPool.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteThreadPool.h"
+
+RemoteThreadPool::RemoteThreadPool(size_t numThreads)
+: numThreads(numThreads)
+{
+    if(this->numThreads == 0){
+        auto cores = std::thread::hardware_concurrency();
+        this->numThreads = cores > 1 ? cores - 1 : 0;
+    }
+}
+
+RemoteThreadPool::~RemoteThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for(auto & thread : threads){
+        thread.join();
+    }
+}
+
+void RemoteThreadPool::start()
+{
+    threads.reserve(numThreads);
+    for(size_t i = 0; i < numThreads; ++i){
+        threads.emplace_back([this]{
+            work();
+        });
+    }
+}
+
+RemoteThreadPool& RemoteThreadPool::getShared()
+{
+    static RemoteThreadPool pool;
+    return pool;
+}
+
+void RemoteThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& task)
+{
+    if(count == 0) return;
+    if(numThreads == 0 || count == 1){
+        for(size_t i = 0; i < count; ++i){
+            task(i);
+        }
+        return;
+    }
+    
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(threads.empty()){
+            start();
+        }
+        this->task = &task;
+        this->count = count;
+        next.store(0, std::memory_order_relaxed);
+        ++generation;
+    }
+    wake.notify_all();
+
+    runTasks();
+
+    // Every index has been handed out, wait for the workers that took one to finish it.
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [this]{ return busy == 0; });
+    this->task = nullptr;
+}
+
+void RemoteThreadPool::enqueue(std::function<void()> job)
+{
+    if(numThreads == 0){
+        job();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if(threads.empty()){
+            start();
+        }
+        jobs.push_back(std::move(job));
+    }
+    wake.notify_one();
+}
+
+void RemoteThreadPool::work()
+{
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while(true){
+        wake.wait(lock, [this, seen]{ return stopping || (task && generation != seen) || !jobs.empty(); });
+        if(stopping) return;
+
+        if(task && generation != seen){
+            // Join the loop, parallelFor doesn't return before busy is back to 0.
+            seen = generation;
+            ++busy;
+            lock.unlock();
+            runTasks();
+            lock.lock();
+            if(--busy == 0){
+                finished.notify_one();
+            }
+        }else{
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            lock.unlock();
+            job();
+            lock.lock();
+        }
+    }
+}
+
+void RemoteThreadPool::runTasks()
+{
+    for(auto i = next.fetch_add(1, std::memory_order_relaxed); i < count; i = next.fetch_add(1, std::memory_order_relaxed)){
+        (*task)(i);
+    }
+}
@@ -0,0 +1,60 @@
+//
+//  RemoteThreadPool.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//! a fixed set of worker threads that run a loop body over a range of indices together with the calling thread, and
+//! background jobs nobody waits for. indices are handed out one at a time from a shared counter, so a thread that finished
+//! its warp takes the next one instead of waiting for a slower thread. workers pick up loops before jobs, a worker still
+//! busy with a job doesn't hold up a loop. the workers are started on the first call.
+class RemoteThreadPool {
+public:
+
+    //! numThreads workers besides the calling thread, 0 to use one less than the number of cores
+    explicit RemoteThreadPool(size_t numThreads = 0);
+    ~RemoteThreadPool();
+
+    //! run task(i) for every i in [0, count) and return once all of them finished. not reentrant
+    void parallelFor(size_t count, const std::function<void(size_t)>& task);
+    //! run job on a worker some time later, without workers it runs right away
+    void enqueue(std::function<void()> job);
+    
+    //! pool shared by the mapper and its warps
+    static RemoteThreadPool& getShared();
+
+    inline size_t getNumThreads() const { return numThreads; }
+
+private:
+
+    void start();
+    void work();
+    //! run indices until there are none left
+    void runTasks();
+
+    size_t numThreads;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    //! incremented for every parallelFor, workers wait for it to change
+    uint64_t generation{0};
+    bool stopping{false};
+    //! workers that joined the current loop and are still running tasks of it
+    size_t busy{0};
+    std::deque<std::function<void()>> jobs;
+
+    const std::function<void(size_t)>* task{nullptr};
+    size_t count{0};
+    std::atomic<size_t> next{0};
+};
@@ -0,0 +1,162 @@
+//
+//  RemoteTrace.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteTrace.h"
+#include "ofMain.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+
+namespace {
+
+    struct Event {
+        // Atomic so save can read while the owning thread records, a slot it finds overwritten is dropped.
+        std::atomic<const char*> name{nullptr};
+        std::atomic<const char*> detail{nullptr};
+        std::atomic<uint64_t> start{0};
+        std::atomic<uint64_t> end{0};
+    };
+
+    struct ThreadBuffer {
+        explicit ThreadBuffer(uint32_t id) : id(id), events(new Event[RemoteTrace::sCapacity]) {}
+        uint32_t id;
+        std::unique_ptr<Event[]> events;
+        //! spans started recording so far, the next one goes to written % sCapacity
+        std::atomic<uint64_t> written{0};
+        //! spans done recording so far
+        std::atomic<uint64_t> committed{0};
+        //! spans before this one were recorded before the last start
+        std::atomic<uint64_t> first{0};
+    };
+
+    std::mutex sBuffersMutex;
+    //! never freed, a thread that ends leaves its spans for the next save
+    std::vector<std::unique_ptr<ThreadBuffer>> sBuffers;
+    std::atomic<int64_t> sEpoch{0};
+
+    std::mutex sInternMutex;
+    std::set<std::string> sInterned;
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        static thread_local ThreadBuffer* buffer = nullptr;
+        if(!buffer){
+            std::lock_guard<std::mutex> lock(sBuffersMutex);
+            sBuffers.push_back(std::make_unique<ThreadBuffer>(sBuffers.size() + 1));
+            buffer = sBuffers.back().get();
+        }
+        return *buffer;
+    }
+
+    void writeString(std::ostream& out, const char* text)
+    {
+        out << '"';
+        for(auto c = text; *c; ++c){
+            if(*c == '"' || *c == '\\'){
+                out << '\\' << *c;
+            }else if(uint8_t(*c) < 0x20){
+                out << ' ';
+            }else{
+                out << *c;
+            }
+        }
+        out << '"';
+    }
+}
+
+std::atomic<bool> RemoteTrace::sEnabled{false};
+
+void RemoteTrace::start()
+{
+    {
+        std::lock_guard<std::mutex> lock(sBuffersMutex);
+        for(auto & buffer : sBuffers){
+            buffer->first.store(buffer->committed.load(std::memory_order_acquire), std::memory_order_release);
+        }
+    }
+    sEpoch.store(std::chrono::steady_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+    sEnabled.store(true, std::memory_order_release);
+}
+
+void RemoteTrace::stop()
+{
+    sEnabled.store(false, std::memory_order_release);
+}
+
+uint64_t RemoteTrace::now()
+{
+    auto elapsed = std::chrono::steady_clock::duration(std::chrono::steady_clock::now().time_since_epoch().count() - sEpoch.load(std::memory_order_relaxed));
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+}
+
+void RemoteTrace::record(const char* name, const char* detail, uint64_t start, uint64_t end)
+{
+    // Started before tracing was restarted.
+    if(end < start) return;
+    
+    auto & buffer = getThreadBuffer();
+    auto written = buffer.written.load(std::memory_order_relaxed);
+    auto & event = buffer.events[written % sCapacity];
+    // Count the slot before filling it in, save drops a slot it sees being overwritten while reading.
+    buffer.written.store(written + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.detail.store(detail, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.end.store(end, std::memory_order_relaxed);
+    buffer.committed.store(written + 1, std::memory_order_release);
+}
+
+bool RemoteTrace::save(const std::filesystem::path& file)
+{
+    std::ofstream out(file);
+    if(!out){
+        ofLogError("RemoteTrace::save") << "couldn't write " << file;
+        return false;
+    }
+
+    out << "{\"traceEvents\":[";
+    bool firstEvent = true;
+    std::lock_guard<std::mutex> lock(sBuffersMutex);
+    for(auto & buffer : sBuffers){
+        out << (firstEvent ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->id << ",\"args\":{\"name\":\"thread " << buffer->id << "\"}}";
+        firstEvent = false;
+
+        // Skip slots the owning thread started overwriting while they were read.
+        auto committed = buffer->committed.load(std::memory_order_acquire);
+        auto first = std::max(buffer->first.load(std::memory_order_acquire), committed > sCapacity ? committed - sCapacity : 0);
+        for(auto i = first; i < committed; ++i){
+            auto & event = buffer->events[i % sCapacity];
+            auto name = event.name.load(std::memory_order_relaxed);
+            auto detail = event.detail.load(std::memory_order_relaxed);
+            auto start = event.start.load(std::memory_order_relaxed);
+            auto end = event.end.load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(buffer->written.load(std::memory_order_relaxed) > i + sCapacity) continue;
+            if(!name) continue;
+
+            out << ",\n{\"name\":";
+            writeString(out, name);
+            out << ",\"cat\":\"rpm\",\"ph\":\"X\",\"ts\":" << start << ",\"dur\":" << (end - start) << ",\"pid\":1,\"tid\":" << buffer->id;
+            if(detail){
+                out << ",\"args\":{\"warp\":";
+                writeString(out, detail);
+                out << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return bool(out);
+}
+
+const char* RemoteTrace::intern(const std::string& text)
+{
+    std::lock_guard<std::mutex> lock(sInternMutex);
+    return sInterned.insert(text).first->c_str();
+}
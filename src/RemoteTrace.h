@@ -0,0 +1,57 @@
+//
+//  RemoteTrace.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+//! records timed spans of the mapper's frame phases for a timeline of a running show, saved as a Chrome trace
+//! (chrome://tracing, ui.perfetto.dev).
+//!
+//! every thread records into a ring of its own that only it writes, the newest sCapacity spans per thread are kept.
+//! while tracing is off a span is one relaxed atomic load. span names have to be string literals and details have to
+//! come from intern(), the trace only stores the pointers.
+class RemoteTrace {
+public:
+
+    //! times the enclosing scope, recorded if tracing was on when it started
+    class Span {
+    public:
+        explicit Span(const char* name, const char* detail = nullptr)
+        : name(isEnabled() ? name : nullptr), detail(detail), start(this->name ? now() : 0) {}
+        ~Span(){ if(name) record(name, detail, start, now()); }
+        Span(const Span&) = delete;
+        Span& operator=(const Span&) = delete;
+    private:
+        const char* name;
+        const char* detail;
+        uint64_t start;
+    };
+
+    //! start recording, spans recorded before are dropped
+    static void start();
+    static void stop();
+    static inline bool isEnabled(){ return sEnabled.load(std::memory_order_relaxed); }
+
+    //! write every thread's recorded spans to file as Chrome trace JSON, works while recording
+    static bool save(const std::filesystem::path& file);
+
+    //! a copy of text that lives as long as the process, for span details. interning the same text twice returns the same copy
+    static const char* intern(const std::string& text);
+
+    //! spans kept per thread
+    static const uint32_t sCapacity = 1 << 15;
+
+private:
+
+    //! microseconds since tracing started
+    static uint64_t now();
+    static void record(const char* name, const char* detail, uint64_t start, uint64_t end);
+
+    static std::atomic<bool> sEnabled;
+};
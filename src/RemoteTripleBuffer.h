@@ -0,0 +1,51 @@
+//
+//  RemoteTripleBuffer.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <atomic>
+
+//! lock-free triple buffer handing the newest value from one producer thread to one consumer thread.
+//! the producer always has a buffer to write to and the consumer always keeps the one it took last, neither waits for the other.
+template<typename T>
+class RemoteTripleBuffer {
+public:
+
+    //! producer: buffer the next publish makes visible, it still holds whatever was written to it two publishes ago
+    inline T& edit(){ return buffers[back]; }
+
+    //! producer: make the edited buffer the newest one, returns false if the one published before was never consumed
+    bool publish()
+    {
+        auto previous = middle.exchange(back | FRESH, std::memory_order_acq_rel);
+        back = previous & ~FRESH;
+        return !(previous & FRESH);
+    }
+
+    //! consumer: return the newest buffer if one was published since the last call, nullptr otherwise
+    const T* consume()
+    {
+        if(!(middle.load(std::memory_order_relaxed) & FRESH)){
+            return nullptr;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & ~FRESH;
+        return &buffers[front];
+    }
+
+    //! producer: one of the three buffers, for looking at their storage. the consumer must only read them
+    inline const T& getBuffer(int index) const { return buffers[index]; }
+
+private:
+
+    static const int FRESH = 4;
+
+    T buffers[3];
+    //! only touched by the producer
+    int back{0};
+    //! only touched by the consumer
+    int front{1};
+    //! index of the buffer in between, with FRESH set when it holds a value the consumer hasn't seen
+    std::atomic<int> middle{2};
+};
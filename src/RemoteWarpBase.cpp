@@ -6,10 +6,45 @@
 //
 
 #include "RemoteWarpBase.h"
+#include "RemoteMappingWatcher.h"
 #include "ofxRemoteUIServer.h"
 #include "ofMain.h"
+#include "RemoteTrace.h"
+#include "RemoteThreadPool.h"
+#include <fstream>
 
 std::string RemoteWarpBase::sSaveFilename = "controlpoints.json";
+std::string RemoteWarpBase::sJournalFilename = "controlpoints.journal";
+size_t RemoteWarpBase::sJournalCompactionThreshold = 4096;
+std::atomic<bool> RemoteWarpBase::sPushRequested{false};
+RemoteClientMirror RemoteWarpBase::sClientMirror;
+
+namespace {
+    
+    std::atomic<size_t> sJsonCacheBytes{0};
+    
+    //! records and text buffers reused between saves and loads so they don't allocate once the buffers have grown
+    struct JsonCache {
+        WarpRecord record;
+        WarpJsonWriter writer;
+        WarpJsonReader reader;
+        //! what this thread's cache added to sJsonCacheBytes
+        size_t counted{0};
+        
+        //! keep sJsonCacheBytes in step with what the buffers grew to
+        void account(){
+            size_t bytes = record.getCapacityBytes() + writer.getCapacityBytes() + reader.getCapacityBytes();
+            sJsonCacheBytes += bytes - counted;
+            counted = bytes;
+        }
+        
+        ~JsonCache(){
+            sJsonCacheBytes -= counted;
+        }
+    };
+    
+    thread_local JsonCache sJsonCache;
+}
 
 RemoteWarpBase::RemoteWarpBase(const std::string& name, const WarpSettings& settings) :
     type(settings._type),
@@ -42,10 +77,9 @@ RemoteWarpBase::RemoteWarpBase(const std::string& name, const WarpSettings& sett
     
     dirty = true;
     
-    ofAddListener(RUI_GET_OF_EVENT(), this, &RemoteWarpBase::handleRemoteUpdate);
-    
     remoteGroupName = "[warp] "+warpName;
     ctrlptPrefix = warpName+"-cp";
+    stats->setTraceName(RemoteTrace::intern(warpName));
     currentPreset = "no_preset";
     
     if(std::filesystem::exists(saveLocation)){
@@ -66,293 +100,863 @@ RemoteWarpBase::RemoteWarpBase(const std::string& name, const WarpSettings& sett
     }
     
     saveLocation = saveLocation/warpName;
+}
 
+void RemoteWarpBase::share()
+{
+    if(shared) return;
+    shared = true;
+    remoteSynced = false;
+    
+    ofAddListener(RUI_GET_OF_EVENT(), this, &RemoteWarpBase::handleRemoteUpdate);
+    
+    // Start the shadows off with what the warp loaded.
+    syncRemoteParams();
     RUI_NEW_COLOR();
     RUI_NEW_GROUP(remoteGroupName);
-    
-    RUI_SHARE_PARAM_WCN(warpName+"-save",saveGroup);
-    RUI_SHARE_PARAM_WCN(warpName+"-show",show);
-    RUI_SHARE_PARAM_WCN(warpName+"-src x",srcArea.x, -width, width);
-    RUI_SHARE_PARAM_WCN(warpName+"-src y",srcArea.y, -height, height);
-    RUI_SHARE_PARAM_WCN(warpName+"-src width",srcArea.width, 0,width);
-    RUI_SHARE_PARAM_WCN(warpName+"-src height",srcArea.height, 0, height);
-    RUI_SHARE_PARAM_WCN(warpName+"-draw x",drawArea.x, 0, ofGetWidth());
-    RUI_SHARE_PARAM_WCN(warpName+"-draw y",drawArea.y, 0, ofGetHeight());
-    RUI_SHARE_PARAM_WCN(warpName+"-draw width",drawArea.width, 0, windowSize.x);
-    RUI_SHARE_PARAM_WCN(warpName+"-draw height",drawArea.height, 0, windowSize.y);
-    RUI_SHARE_PARAM_WCN(warpName+"-brightness", brightness,0.0,1.0);
-    RUI_SHARE_PARAM_WCN(warpName+"-luminance red", luminance.r, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-luminance green", luminance.g, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-luminance blue", luminance.b, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-gamma red", gamma.r, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-gamma green", gamma.g, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-gamma blue", gamma.b, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-edge exponent", exponent, 1., 10.);
-    RUI_SHARE_PARAM_WCN(warpName+"-edge left", edges.x, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-edge top", edges.y, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-edge right", edges.z, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-edge bottom", edges.w, 0., 1.);
-    RUI_SHARE_PARAM_WCN(warpName+"-editMesh",remoteEditMode);
+    shareRemoteParams();
+    requestPushToClient();
+}
+
+void RemoteWarpBase::shareRemoteParams()
+{
+    RUI_SHARE_PARAM_WCN(warpName+"-save",saveGroup.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-show",remoteShow.bind());
+    shareRemoteParam(warpName+"-src x",srcArea.x, -width, width);
+    shareRemoteParam(warpName+"-src y",srcArea.y, -height, height);
+    shareRemoteParam(warpName+"-src width",srcArea.width, 0,width);
+    shareRemoteParam(warpName+"-src height",srcArea.height, 0, height);
+    shareRemoteParam(warpName+"-draw x",drawArea.x, 0, ofGetWidth());
+    shareRemoteParam(warpName+"-draw y",drawArea.y, 0, ofGetHeight());
+    shareRemoteParam(warpName+"-draw width",drawArea.width, 0, windowSize.x);
+    shareRemoteParam(warpName+"-draw height",drawArea.height, 0, windowSize.y);
+    shareRemoteParam(warpName+"-brightness", brightness,0.0,1.0, true);
+    shareRemoteParam(warpName+"-luminance red", luminance.r, 0., 1., true);
+    shareRemoteParam(warpName+"-luminance green", luminance.g, 0., 1., true);
+    shareRemoteParam(warpName+"-luminance blue", luminance.b, 0., 1., true);
+    shareRemoteParam(warpName+"-gamma red", gamma.r, 0., 1., true);
+    shareRemoteParam(warpName+"-gamma green", gamma.g, 0., 1., true);
+    shareRemoteParam(warpName+"-gamma blue", gamma.b, 0., 1., true);
+    shareRemoteParam(warpName+"-edge exponent", exponent, 1., 10., true);
+    shareRemoteParam(warpName+"-edge left", edges.x, 0., 1., true);
+    shareRemoteParam(warpName+"-edge top", edges.y, 0., 1., true);
+    shareRemoteParam(warpName+"-edge right", edges.z, 0., 1., true);
+    shareRemoteParam(warpName+"-edge bottom", edges.w, 0., 1., true);
+    RUI_SHARE_PARAM_WCN(warpName+"-editMesh",remoteEditMesh.bind());
     
     ofxRemoteUIServer::instance()->addParamToPresetLoadIgnoreList(warpName+"-editMesh");
-    
 }
 
 void RemoteWarpBase::loadPreset(const std::string& preset){
-    if(std::filesystem::exists(saveLocation/preset/RemoteWarpBase::sSaveFilename)){
+    RemoteTrace::Span span("load preset", getTraceName());
+    if(isPresetName(preset) && std::filesystem::exists(saveLocation/preset/RemoteWarpBase::sSaveFilename)){
         currentPreset = preset;
         loadControlPoints(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename);
         dirty = true;
     }
 }
 
+void RemoteWarpBase::shareRemoteParam(const std::string& name, float & value, float min, float max, bool blend)
+{
+    remoteParams.push_back(RemoteParam{name, std::make_unique<RemoteShadow<float>>(value), &value, blend});
+    RUI_SHARE_PARAM_WCN(name, remoteParams.back().shadow->bind(), min, max);
+}
+
 void RemoteWarpBase::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
-{    
+{
+    RemoteTrace::Span span("remote event", getTraceName());
+    RemoteWarpCommand command;
     switch (arg.action) {
+        case CLIENT_CONNECTED:
+            // A new client knows nothing, the next push has to send everything.
+            sClientMirror.reset();
+            requestPushToClient();
+            break;
         case CLIENT_UPDATED_PARAM:
             if(arg.group == remoteGroupName){
-                if(arg.paramName == (warpName+"-width") ||
-                   arg.paramName == (warpName+"-height") ||
-                   arg.paramName == (warpName+"-draw width") ||
-                   arg.paramName == (warpName+"-draw height")
-                   ){
-                    dirty = true;
+                if(arg.paramName == (warpName+"-show")){
+                    command.type = RemoteWarpCommand::COMMAND_SHOW;
+                    command.flag = arg.param.boolVal;
+                    pushCommand(command);
                 }else if(arg.paramName == (warpName+"-save")){
-                    saveControlPoints(saveLocation/currentPreset/sSaveFilename);
-                    saveGroup = false;
-                    RUI_PUSH_TO_CLIENT();
+                    command.type = RemoteWarpCommand::COMMAND_SAVE;
+                    pushCommand(command);
                 }else if(arg.paramName == (warpName+"-editMesh")){
-                    setEditing(remoteEditMode);
-                    if(remoteEditMode){
-                        addControlPoints();
-                    }else{
-                        removeControlPoints();
-                        saveControlPoints(saveLocation/currentPreset/sSaveFilename);
+                    command.type = RemoteWarpCommand::COMMAND_EDIT_MESH;
+                    command.flag = arg.param.boolVal;
+                    pushCommand(command);
+                }else{
+                    auto found = std::find_if(remoteParams.begin(), remoteParams.end(), [&arg](const RemoteParam& param){
+                        return param.name == arg.paramName;
+                    });
+                    if(found != remoteParams.end()){
+                        command.type = RemoteWarpCommand::COMMAND_SET_PARAM;
+                        command.index = found - remoteParams.begin();
+                        command.value.x = arg.param.floatVal;
+                        pushCommand(command);
                     }
                 }
             }
             break;
             
         case CLIENT_DID_SET_PRESET:
+        case SERVER_DID_PROGRAMATICALLY_LOAD_PRESET:
         {
-            currentPreset = arg.msg;
-            loadControlPoints(saveLocation/currentPreset/sSaveFilename);
+            // RemoteUI wrote the whole preset into the shadows without per param events.
+            pushRemoteState();
+            command.type = RemoteWarpCommand::COMMAND_LOAD_PRESET;
+            command.preset = arg.msg;
+            pushCommand(command);
         }break;
         case CLIENT_SAVED_PRESET:{
-            if(currentPreset != arg.msg){
-                currentPreset = arg.msg;
-            }
-            if(!std::filesystem::exists(saveLocation/currentPreset)){
-                std::filesystem::create_directory(saveLocation/currentPreset);
-            }
-            saveControlPoints(saveLocation/currentPreset/sSaveFilename);
+            command.type = RemoteWarpCommand::COMMAND_SAVE_PRESET;
+            command.preset = arg.msg;
+            pushCommand(command);
         }break;
         case CLIENT_DELETED_PRESET:
         {
-            std::filesystem::remove_all(saveLocation/arg.msg/sSaveFilename);
-            if(arg.msg == currentPreset){
-                currentPreset = "no_preset";
-            }
+            command.type = RemoteWarpCommand::COMMAND_DELETE_PRESET;
+            command.preset = arg.msg;
+            pushCommand(command);
         }break;
         case CLIENT_DID_SET_GROUP_PRESET:{
             if(arg.group == remoteGroupName){
-                currentPreset = arg.msg;
-                loadControlPoints(saveLocation/currentPreset/sSaveFilename);
+                pushRemoteState();
+                command.type = RemoteWarpCommand::COMMAND_LOAD_PRESET;
+                command.preset = arg.msg;
+                pushCommand(command);
             }
         }break;
         case CLIENT_SAVED_GROUP_PRESET:{
             if(arg.group == remoteGroupName){
-                if(currentPreset != arg.msg){
-                    currentPreset = arg.msg;
-                }
-                if(!std::filesystem::exists(saveLocation/currentPreset)){
-                    std::filesystem::create_directory(saveLocation/currentPreset);
-                }
-                saveControlPoints(saveLocation/currentPreset/sSaveFilename);
+                command.type = RemoteWarpCommand::COMMAND_SAVE_PRESET;
+                command.preset = arg.msg;
+                pushCommand(command);
             }
         }break;
         case CLIENT_DELETED_GROUP_PRESET:{
             if(arg.group == remoteGroupName){
-                std::filesystem::remove_all(saveLocation/arg.msg/sSaveFilename);
-                if(arg.msg == currentPreset){
-                    currentPreset = "no_preset";
-                }
+                command.type = RemoteWarpCommand::COMMAND_DELETE_PRESET;
+                command.preset = arg.msg;
+                pushCommand(command);
             }
         }break;
-        case SERVER_DID_PROGRAMATICALLY_LOAD_PRESET:{
-            currentPreset = arg.msg;
-            loadControlPoints(saveLocation/currentPreset/sSaveFilename);
-        }break;
         case CLIENT_SAVED_STATE:{
-            saveControlPoints(saveLocation/currentPreset/sSaveFilename);
-        }break;
-        case CLIENT_DID_RESET_TO_XML:{
-            loadControlPoints(saveLocation/"no_preset"/sSaveFilename);
+            command.type = RemoteWarpCommand::COMMAND_SAVE;
+            pushCommand(command);
         }break;
+        case CLIENT_DID_RESET_TO_XML:
         case CLIENT_DID_RESET_TO_DEFAULTS:{
-            loadControlPoints(saveLocation/"no_preset"/sSaveFilename);
+            pushRemoteState();
+            command.type = RemoteWarpCommand::COMMAND_RESET;
+            pushCommand(command);
         }break;
         default:
             break;
     }
 }
 
-void RemoteWarpBase::addControlPoints()
+void RemoteWarpBase::pushCommand(const RemoteWarpCommand & command)
 {
-    int i = 0;
-    RUI_NEW_GROUP(remoteGroupName);
-    for(auto& cp : controlPoints){
-        RUI_SHARE_PARAM_WCN(ctrlptPrefix+ofToString(i)+" x",cp.x,0.f, 1.f);
-        RUI_SHARE_PARAM_WCN(ctrlptPrefix+ofToString(i++)+" y",cp.y,0.f, 1.f);
+    if(!commands.push(command)){
+        ofLogWarning("RemoteWarp::pushCommand") << warpName << " command queue is full, dropping remote edit";
+    }
+}
+
+void RemoteWarpBase::pushRemoteState()
+{
+    RemoteWarpCommand command;
+    command.type = RemoteWarpCommand::COMMAND_SET_PARAM;
+    for(size_t i = 0; i < remoteParams.size(); ++i){
+        command.index = i;
+        command.value.x = remoteParams[i].shadow->load();
+        pushCommand(command);
+    }
+    command.type = RemoteWarpCommand::COMMAND_SHOW;
+    command.flag = remoteShow;
+    pushCommand(command);
+}
+
+void RemoteWarpBase::applyRemoteCommands()
+{
+    if(shared && !remoteSynced){
+        // Pick up values RemoteUI restored from its settings file after the params were shared.
+        pullRemoteParams();
+        remoteSynced = true;
+        dirty = true;
+    }
+    
+    while(commands.pop(poppedCommand)){
+        applyCommand(poppedCommand);
+    }
+    
+    if(remoteStale){
+        syncRemoteParams();
+        requestPushToClient();
+    }
+}
+
+void RemoteWarpBase::requestPushToClient()
+{
+    sPushRequested.store(true, std::memory_order_release);
+}
+
+void RemoteWarpBase::flushPushToClient()
+{
+    if(sPushRequested.exchange(false, std::memory_order_acq_rel)){
+        sClientMirror.push();
+    }
+}
+
+RemoteWarpMemory RemoteWarpBase::getMemory() const
+{
+    RemoteWarpMemory memory;
+    memory.controlPoints = controlPoints.capacity() * sizeof(glm::vec2) + remoteParams.capacity() * sizeof(RemoteParam);
+    for(auto & param : remoteParams){
+        memory.controlPoints += param.name.capacity() + sizeof(float);
+    }
+    
+    memory.selection = selectedIndices.capacity() * sizeof(Selection) + controlData.capacity() * sizeof(ControlData);
+    
+    memory.journal = journal.getCapacityBytes() + sizeof(commands) + heldPresetCommands.capacity() * sizeof(RemoteWarpCommand);
+    for(auto & command : heldPresetCommands){
+        memory.journal += command.preset.capacity();
+    }
+    if(compaction){
+        memory.journal += compaction->record.getCapacityBytes();
+    }
+    
+    // The overlay mesh plus its two instance attributes, allocated for every instance up front.
+    if(!controlMesh.getVertices().empty()){
+        memory.controls = controlMesh.getVertices().size() * (sizeof(glm::vec3) + sizeof(glm::vec2)) + 2 * MAX_NUM_DRAWN_CONTROLS * sizeof(ControlData);
     }
-    RUI_PUSH_TO_CLIENT();
+    return memory;
+}
+
+void RemoteWarpBase::sampleMemory()
+{
+    memoryReport.sample(getMemory());
+}
+
+void RemoteWarpBase::resetMemoryPeaks()
+{
+    memoryReport.resetPeaks();
+}
+
+size_t RemoteWarpBase::getJsonCacheBytes()
+{
+    return sJsonCacheBytes.load(std::memory_order_relaxed);
+}
+
+void RemoteWarpBase::applyCommand(const RemoteWarpCommand & command)
+{
+    switch (command.type) {
+        case RemoteWarpCommand::COMMAND_SET_PARAM:
+        {
+            if(command.index < 0 || size_t(command.index) >= remoteParams.size()) break;
+            auto & param = remoteParams[command.index];
+            *param.value = command.value.x;
+            if(param.blend){
+                journalBlend();
+            }
+            dirty = true;
+        }break;
+        case RemoteWarpCommand::COMMAND_SHOW:
+            show = command.flag;
+            break;
+        case RemoteWarpCommand::COMMAND_SAVE:
+            saveGroup = false;
+            requestPushToClient();
+            if(replicationLeader){
+                auto held = command;
+                held.type = RemoteWarpCommand::COMMAND_SAVE_PRESET;
+                held.preset = currentPreset;
+                heldPresetCommands.push_back(held);
+            }else{
+                saveControlPoints(saveLocation/currentPreset/sSaveFilename);
+            }
+            break;
+        case RemoteWarpCommand::COMMAND_EDIT_MESH:
+            remoteEditMode = command.flag;
+            setEditing(remoteEditMode);
+            if(remoteEditMode){
+                addControlPoints();
+            }else{
+                removeControlPoints();
+                flushJournal();
+            }
+            break;
+        case RemoteWarpCommand::COMMAND_LOAD_PRESET:
+        case RemoteWarpCommand::COMMAND_SAVE_PRESET:
+        case RemoteWarpCommand::COMMAND_DELETE_PRESET:
+            if(!isPresetName(command.preset)){
+                ofLogWarning("RemoteWarp::applyCommand") << warpName << " ignoring invalid preset name \"" << command.preset << "\"";
+            }else if(replicationLeader){
+                heldPresetCommands.push_back(command);
+            }else{
+                applyPresetCommand(command);
+            }
+            break;
+        case RemoteWarpCommand::COMMAND_RESET:
+            loadControlPoints(saveLocation/"no_preset"/sSaveFilename);
+            replicateState = replicationLeader;
+            break;
+        default:
+            break;
+    }
+}
+
+bool RemoteWarpBase::isPresetName(const std::string& preset) const
+{
+    if(preset.empty() || preset == "." || preset == ".." || preset.find_first_of("/\\") != std::string::npos){
+        return false;
+    }
+    std::filesystem::path path(preset);
+    if(path.has_root_path()){
+        return false;
+    }
+    // Catches whatever else the platform treats as leaving the directory.
+    return (saveLocation/path).lexically_normal().lexically_relative(saveLocation.lexically_normal()) == path;
+}
+
+void RemoteWarpBase::setReplicationLeader(bool leader)
+{
+    replicationLeader = leader;
+    journal.setMirroring(leader);
+    // Followers only get edits from here on, start them off with everything.
+    replicateState = leader;
+    if(!leader){
+        // Nobody is going to schedule them anymore.
+        for(auto & command : heldPresetCommands){
+            applyPresetCommand(command);
+        }
+        heldPresetCommands.clear();
+    }
+}
+
+bool RemoteWarpBase::takeReplicatedRecords(std::vector<char>& records)
+{
+    auto size = records.size();
+    journal.takeMirrored(records);
+    if(replicateState){
+        encodeReplicatedState(records);
+        replicateState = false;
+    }
+    return records.size() != size;
+}
+
+void RemoteWarpBase::encodeReplicatedState(std::vector<char>& records) const
+{
+    RemoteWarpJournal::encode(records, RemoteWarpJournal::RECORD_GRID, (uint32_t(numControlsX) << 16) | uint32_t(numControlsY & 0xffff), controlPoints.empty() ? nullptr : &controlPoints[0].x, controlPoints.size() * 2);
+    float blend[12] = {
+        brightness, exponent,
+        edges.x, edges.y, edges.z, edges.w,
+        gamma.r, gamma.g, gamma.b,
+        luminance.r, luminance.g, luminance.b
+    };
+    RemoteWarpJournal::encode(records, RemoteWarpJournal::RECORD_BLEND, 0, blend, 12);
+}
+
+void RemoteWarpBase::applyReplicatedRecords(const char* data, size_t size)
+{
+    auto & journal = getJournal();
+    RemoteWarpJournal::decode(data, size, [this, &journal](const RemoteWarpJournal::Record& record){
+        replayJournalRecord(record);
+        journal.append(record);
+    });
+    remoteStale = true;
+}
+
+bool RemoteWarpBase::takePresetCommand(RemoteWarpCommand& command)
+{
+    if(heldPresetCommands.empty()) return false;
+    command = heldPresetCommands.front();
+    heldPresetCommands.erase(heldPresetCommands.begin());
+    return true;
+}
+
+void RemoteWarpBase::applyPresetCommand(const RemoteWarpCommand& command)
+{
+    RemoteTrace::Span span("preset", getTraceName());
+    if(!isPresetName(command.preset)){
+        ofLogWarning("RemoteWarp::applyPresetCommand") << warpName << " ignoring invalid preset name \"" << command.preset << "\"";
+        return;
+    }
+    switch (command.type) {
+        case RemoteWarpCommand::COMMAND_LOAD_PRESET:
+            currentPreset = command.preset;
+            loadControlPoints(saveLocation/currentPreset/sSaveFilename);
+            // Followers load their own copy of the preset, make sure they end up with the leader's.
+            replicateState = replicationLeader;
+            break;
+        case RemoteWarpCommand::COMMAND_SAVE_PRESET:
+            currentPreset = command.preset;
+            if(!std::filesystem::exists(saveLocation/currentPreset)){
+                std::filesystem::create_directory(saveLocation/currentPreset);
+            }
+            saveControlPoints(saveLocation/currentPreset/sSaveFilename);
+            break;
+        case RemoteWarpCommand::COMMAND_DELETE_PRESET:
+            finishCompaction(true);
+            if(command.preset == currentPreset){
+                journal.close();
+                currentPreset = "no_preset";
+            }
+            std::filesystem::remove_all(saveLocation/command.preset/sSaveFilename);
+            std::filesystem::remove_all(saveLocation/command.preset/sJournalFilename);
+            break;
+        default:
+            break;
+    }
+}
+
+void RemoteWarpBase::pullRemoteParams()
+{
+    for(auto & param : remoteParams){
+        *param.value = param.shadow->load();
+    }
+    show = remoteShow;
+}
+
+void RemoteWarpBase::syncRemoteParams()
+{
+    for(auto & param : remoteParams){
+        param.shadow->store(*param.value);
+    }
+    remoteShow = show;
+    remoteEditMesh = remoteEditMode;
+    if(remoteEditMode){
+        gridPublishRequested = true;
+    }
+    remoteStale = false;
+}
+
+void RemoteWarpBase::addControlPoints()
+{
+    // The grid itself goes over the grid channel, RemoteUI only carries scalar settings.
+    gridPublishRequested = true;
+    requestPushToClient();
 }
 
 void RemoteWarpBase::removeControlPoints()
 {
-    for(int i =0;i<controlPoints.size();i++){
-        auto instance = ofxRemoteUIServer::instance();
-        instance->removeParamFromDB(ctrlptPrefix + ofToString(i) + " x", true);
-        instance->removeParamFromDB(ctrlptPrefix + ofToString(i) + " y", true);
+    gridPublishRequested = false;
+    requestPushToClient();
+}
+
+bool RemoteWarpBase::takeGridPublishRequest()
+{
+    bool requested = gridPublishRequested;
+    gridPublishRequested = false;
+    return requested;
+}
+
+bool RemoteWarpBase::setRemoteGrid(int columns, int rows, const std::vector<glm::vec2>& points)
+{
+    return copyControlGrid(columns, rows, points, "RemoteWarp::setRemoteGrid");
+}
+
+bool RemoteWarpBase::setControlGrid(int columns, int rows, const std::vector<glm::vec2>& points)
+{
+    if(!copyControlGrid(columns, rows, points, "RemoteWarp::setControlGrid")){
+        return false;
     }
-    RUI_PUSH_TO_CLIENT();
+    // Grids from the grid channel don't resync RemoteUI, that would send them straight back.
+    remoteStale = true;
+    return true;
 }
 
-void RemoteWarpBase::serialize(nlohmann::json & json)
+bool RemoteWarpBase::copyControlGrid(int columns, int rows, const std::vector<glm::vec2>& points, const std::string& module)
 {
-    json["name"] = warpName;
-    json["preset"] = currentPreset;
-    json["type"] = type;
-    json["brightness"] = brightness;
-    // Warp parameters.
+    if(columns != numControlsX || rows != numControlsY || points.size() != controlPoints.size()){
+        ofLogWarning(module) << warpName << " only takes " << numControlsX << "x" << numControlsY << " grids, got " << columns << "x" << rows;
+        return false;
+    }
+    std::copy(points.begin(), points.end(), controlPoints.begin());
+    getJournal().appendGrid(numControlsX, numControlsY, controlPoints);
+    // The grid size didn't change, so only the vertex positions need updating.
+    controlPointMoved(0);
+    controlPointMoved(controlPoints.size() - 1);
+    return true;
+}
+
+bool RemoteWarpBase::importControlGrid(const std::filesystem::path& file)
+{
+    RemoteTrace::Span span("import control grid", getTraceName());
+    auto infile = ofFile(file, ofFile::ReadOnly);
+    if (!infile.exists())
     {
-        auto & jsonWarp = json["warp"];
-        
-        jsonWarp["columns"] = numControlsX;
-        jsonWarp["rows"] = numControlsY;
-        
-        std::vector<std::string> points;
-        for (auto & controlPoint : controlPoints)
-        {
-            std::ostringstream oss;
-            oss << controlPoint;
-            points.push_back(oss.str());
+        ofLogWarning("RemoteWarp::importControlGrid") << "File not found at path " << file;
+        return false;
+    }
+    auto buffer = infile.readToBuffer();
+    
+    auto & record = sJsonCache.record;
+    if(file.extension() == ".json"){
+        auto & reader = sJsonCache.reader;
+        bool parsed = reader.read(buffer.getData(), buffer.size(), record);
+        sJsonCache.account();
+        if(!parsed){
+            ofLogError("RemoteWarp::importControlGrid") << "couldn't parse " << file << ": " << reader.getError();
+            return false;
+        }
+    }else{
+        std::string error;
+        if(!RemoteControlGrid::parse(buffer.getData(), buffer.size(), record.columns, record.rows, record.controlPoints, error)){
+            ofLogError("RemoteWarp::importControlGrid") << "couldn't parse " << file << ": " << error;
+            return false;
         }
-        jsonWarp["control points"] = points;
     }
+    return setControlGrid(record.columns, record.rows, record.controlPoints);
+}
+
+bool RemoteWarpBase::setRemoteControlPoint(size_t index, const glm::vec2& pos)
+{
+    if(index >= controlPoints.size()) return false;
+    controlPoints[index] = pos;
+    journalControlPoint(index);
+    controlPointMoved(index);
+    return true;
+}
+
+bool RemoteWarpBase::setStreamedControlPoint(size_t index, const glm::vec2& pos)
+{
+    if(index >= controlPoints.size()) return false;
+    if(controlPoints[index] == pos) return true;
+    controlPoints[index] = pos;
+    controlPointMoved(index);
+    if(remoteEditMode){
+        gridPublishRequested = true;
+    }
+    return true;
+}
+
+bool RemoteWarpBase::setStreamedCorner(size_t index, const glm::vec2& pos)
+{
+    return false;
+}
+
+void RemoteWarpBase::controlPointMoved(size_t index)
+{
+    dirty = true;
+}
+
+void RemoteWarpBase::serialize(WarpRecord & record) const
+{
+    record.name = warpName;
+    record.preset = currentPreset;
+    record.type = type;
+    record.brightness = brightness;
+    
+    // Warp parameters.
+    record.columns = numControlsX;
+    record.rows = numControlsY;
+    record.controlPoints.assign(controlPoints.begin(), controlPoints.end());
     
     // Blend parameters.
-    {
-        auto & jsonBlend = json["blend"];
-        
-        jsonBlend["exponent"] = exponent;
-        
-        std::ostringstream oss;
-        oss << edges;
-        jsonBlend["edges"] = oss.str();
-        
-        oss.str("");
-        oss << gamma;
-        jsonBlend["gamma"] = oss.str();
-        
-        oss.str("");
-        oss << luminance;
-        jsonBlend["luminance"] = oss.str();
-    }
+    record.exponent = exponent;
+    record.edges = edges;
+    record.gamma = gamma;
+    record.luminance = luminance;
 }
 
-void RemoteWarpBase::deserialize(const nlohmann::json & json)
+void RemoteWarpBase::deserialize(const WarpRecord & record)
 {
-    auto name = json["name"].get<std::string>();
-    auto preset = json["preset"].get<std::string>();
-   
-    if(name == warpName && preset == currentPreset){
+    if(record.name == warpName && record.preset == currentPreset){
         
-        int typeAsInt = json["type"];
-        type = (WarpSettings::Type)typeAsInt;
-        brightness = json["brightness"];
+        type = (WarpSettings::Type)record.type;
+        brightness = record.brightness;
         
         // Warp parameters.
-        {
-            const auto & jsonWarp = json["warp"];
-            
-            numControlsX = jsonWarp["columns"];
-            numControlsY = jsonWarp["rows"];
-            
-            controlPoints.clear();
-            for (const auto & jsonPoint : jsonWarp["control points"])
-            {
-                glm::vec2 controlPoint;
-                std::istringstream iss;
-                iss.str(jsonPoint);
-                iss >> controlPoint;
-                controlPoints.push_back(controlPoint);
-            }
-        }
+        numControlsX = record.columns;
+        numControlsY = record.rows;
+        controlPoints.assign(record.controlPoints.begin(), record.controlPoints.end());
         
         // Blend parameters.
-        {
-            const auto & jsonBlend = json["blend"];
-            
-            exponent = jsonBlend["exponent"];
-            
-            {
-                std::istringstream iss;
-                iss.str(jsonBlend["edges"]);
-                iss >> edges;
-            }
-            {
-                std::istringstream iss;
-                iss.str(jsonBlend["gamma"]);
-                iss >> gamma;
-            }
-            {
-                std::istringstream iss;
-                iss.str(jsonBlend["luminance"]);
-                iss >> luminance;
-            }
-        }
+        exponent = record.exponent;
+        edges = record.edges;
+        gamma = record.gamma;
+        luminance = record.luminance;
         
         dirty = true;
+        remoteStale = true;
     }else{
-        ofLogError() << "Name doesn't match, loaded: " << name << " expected: " << warpName << "or preset doesn't match, loaded: " << currentPreset << " expected: " << preset;
+        ofLogError() << "Name doesn't match, loaded: " << record.name << " expected: " << warpName << "or preset doesn't match, loaded: " << record.preset << " expected: " << currentPreset;
     }
 }
 
 RemoteWarpBase::~RemoteWarpBase()
 {
+    ofRemoveListener(RUI_GET_OF_EVENT(), this, &RemoteWarpBase::handleRemoteUpdate);
+    finishCompaction(true);
+    if(remoteEditMode){
+        removeControlPoints();
+        remoteEditMode = false;
+        remoteEditMesh = false;
+        requestPushToClient();
+    }
+}
+
+void RemoteWarpBase::unshare()
+{
+    if(!shared) return;
+    shared = false;
+    
+    ofRemoveListener(RUI_GET_OF_EVENT(), this, &RemoteWarpBase::handleRemoteUpdate);
     if(remoteEditMode){
         removeControlPoints();
         remoteEditMode = false;
-        RUI_PUSH_TO_CLIENT();
+        remoteEditMesh = false;
     }
+    
+    // Everything else the warp and its subclasses shared is in the warp's group.
+    auto instance = ofxRemoteUIServer::instance();
+    for(auto & name : instance->getAllParamNamesList()){
+        if(instance->getParamForName(name).group == remoteGroupName){
+            instance->removeParamFromDB(name, true);
+        }
+    }
+    remoteParams.clear();
+    requestPushToClient();
 }
 
 void RemoteWarpBase::saveControlPoints(const std::filesystem::path& file)
 {
-    nlohmann::json json;
-    serialize(json);
-    auto out = ofFile(file, ofFile::WriteOnly);
-    out << json.dump(4);
+    RemoteTrace::Span span("save control points", getTraceName());
+    finishCompaction(true);
+    auto & record = sJsonCache.record;
+    auto & writer = sJsonCache.writer;
+    serialize(record);
+    writer.write(record);
+    sJsonCache.account();
+    const auto & text = writer.str();
+    {
+        auto out = ofFile(file, ofFile::WriteOnly);
+        out.write(text.data(), text.size());
+    }
+    snapshotHash = RemoteMappingWatcher::hashContents(text);
+    
+    // The snapshot now holds every journaled edit.
+    journal.open(file.parent_path()/sJournalFilename, true);
 }
 
 void RemoteWarpBase::loadControlPoints(const std::filesystem::path& file)
 {
+    RemoteTrace::Span span("load control points", getTraceName());
+    finishCompaction(true);
     auto infile = ofFile(file, ofFile::ReadOnly);
     if (!infile.exists())
     {
         ofLogWarning("RemoteWarp::loadControlPoints") << "File not found at path " << file;
+        journal.close();
+        return;
+    }
+    
+    auto buffer = infile.readToBuffer();
+    snapshotHash = RemoteMappingWatcher::hashContents(buffer.getText());
+    
+    auto & record = sJsonCache.record;
+    auto & reader = sJsonCache.reader;
+    bool parsed = reader.read(buffer.getData(), buffer.size(), record);
+    sJsonCache.account();
+    if(!parsed){
+        ofLogError("RemoteWarp::loadControlPoints") << "couldn't parse " << file << ": " << reader.getError();
+        return;
+    }
+    
+    deserialize(record);
+    
+    // Replay edits made after the snapshot was written.
+    auto journalFile = file.parent_path()/sJournalFilename;
+    RemoteWarpJournal::replay(journalFile, [this](const RemoteWarpJournal::Record& record){
+        replayJournalRecord(record);
+    });
+    journal.open(journalFile);
+}
+
+bool RemoteWarpBase::reloadControlPoints(const std::string& preset, const WarpRecord& record, size_t hash)
+{
+    // Only the live preset matters, others are read when they get selected.
+    if(preset != currentPreset || hash == snapshotHash){
         return false;
     }
+    // Our own compaction landing, not an external edit.
+    if(compaction && hash == compaction->hash.load()){
+        return false;
+    }
+    finishCompaction(true);
+    
+    deserialize(record);
+    snapshotHash = hash;
     
-    nlohmann::json json;
-    infile >> json;
+    // The new snapshot supersedes whatever was journaled locally.
+    journal.open(saveLocation/currentPreset/sJournalFilename, true);
+    dirty = true;
+    replicateState = replicationLeader;
     
-    deserialize(json);
+    if(remoteEditMode){
+        syncRemoteParams();
+        requestPushToClient();
+    }
+    return true;
+}
+
+void RemoteWarpBase::replayJournalRecord(const RemoteWarpJournal::Record& record)
+{
+    const auto & values = record.values;
+    switch (record.type) {
+        case RemoteWarpJournal::RECORD_CONTROL_POINT:
+            if(record.index < controlPoints.size() && values.size() >= 2){
+                controlPoints[record.index] = glm::vec2(values[0], values[1]);
+            }
+            break;
+        case RemoteWarpJournal::RECORD_BLEND:
+            if(values.size() >= 12){
+                brightness = values[0];
+                exponent = values[1];
+                edges = glm::vec4(values[2], values[3], values[4], values[5]);
+                gamma = glm::vec3(values[6], values[7], values[8]);
+                luminance = glm::vec3(values[9], values[10], values[11]);
+            }
+            break;
+        case RemoteWarpJournal::RECORD_GRID:
+        {
+            int columns = record.index >> 16;
+            int rows = record.index & 0xffff;
+            if(values.size() == size_t(columns * rows * 2)){
+                numControlsX = columns;
+                numControlsY = rows;
+                controlPoints.resize(columns * rows);
+                for(size_t i = 0; i < controlPoints.size(); ++i){
+                    controlPoints[i] = glm::vec2(values[i * 2], values[i * 2 + 1]);
+                }
+            }
+        }break;
+        default:
+            break;
+    }
+    dirty = true;
+}
+
+RemoteWarpJournal& RemoteWarpBase::getJournal()
+{
+    if(!journal.isOpen()){
+        auto dir = saveLocation/currentPreset;
+        if(!std::filesystem::exists(dir/sSaveFilename)){
+            // Without a snapshot there is nothing to replay onto, write one first.
+            if(!std::filesystem::exists(dir)){
+                std::filesystem::create_directories(dir);
+            }
+            saveControlPoints(dir/sSaveFilename);
+        }else{
+            journal.open(dir/sJournalFilename);
+        }
+    }
+    return journal;
+}
+
+void RemoteWarpBase::journalControlPoint(size_t index)
+{
+    if(index >= controlPoints.size()) return;
+    getJournal().appendControlPoint(index, controlPoints[index]);
+}
+
+void RemoteWarpBase::journalControlGrid()
+{
+    getJournal().appendGrid(numControlsX, numControlsY, controlPoints);
+    remoteStale = true;
+}
+
+void RemoteWarpBase::journalBlend()
+{
+    getJournal().appendBlend(brightness, exponent, edges, gamma, luminance);
+}
+
+void RemoteWarpBase::blendChanged()
+{
+    journalBlend();
+    remoteStale = true;
+}
+
+void RemoteWarpBase::flushJournal()
+{
+    if(!journal.isOpen()) return;
+    RemoteTrace::Span span("flush journal", getTraceName());
+    finishCompaction(false);
+    journal.flush();
+    if(!compaction && journal.getNumRecords() >= sJournalCompactionThreshold){
+        startCompaction();
+    }
+}
+
+void RemoteWarpBase::startCompaction()
+{
+    // Only the copy of the warp is taken here, encoding and writing happen on the pool.
+    compaction = std::make_shared<Compaction>();
+    serialize(compaction->record);
+    compaction->file = saveLocation/currentPreset/sSaveFilename;
+    compaction->journalFile = journal.getPath();
+    compaction->journalSize = journal.getSize();
+    compactionDone = compaction->done.get_future();
+    
+    auto job = compaction;
+    RemoteThreadPool::getShared().enqueue([job]{
+        RemoteTrace::Span span("compact journal");
+        auto & writer = sJsonCache.writer;
+        writer.write(job->record);
+        sJsonCache.account();
+        const auto & text = writer.str();
+        job->hash = RemoteMappingWatcher::hashContents(text);
+        
+        // Written next to the snapshot and renamed over it, a crash leaves either snapshot intact.
+        auto temporary = job->file;
+        temporary += ".tmp";
+        {
+            std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+            out.write(text.data(), text.size());
+            job->written = bool(out);
+        }
+        if(job->written){
+            std::error_code error;
+            std::filesystem::rename(temporary, job->file, error);
+            job->written = !error;
+        }
+        job->done.set_value();
+    });
+}
+
+void RemoteWarpBase::finishCompaction(bool wait)
+{
+    if(!compaction) return;
+    if(!wait && compactionDone.wait_for(std::chrono::seconds(0)) != std::future_status::ready){
+        return;
+    }
+    compactionDone.get();
+    
+    if(!compaction->written){
+        ofLogError("RemoteWarp::finishCompaction") << "couldn't write " << compaction->file << ", keeping the journal";
+    }else{
+        if(compaction->file == saveLocation/currentPreset/sSaveFilename){
+            snapshotHash = compaction->hash;
+        }
+        if(journal.isOpen() && journal.getPath() == compaction->journalFile){
+            journal.dropBefore(compaction->journalSize);
+        }
+    }
+    compaction.reset();
+}
+
+void RemoteWarpBase::update()
+{
 }
 
 void RemoteWarpBase::drawWarp(const ofTexture& tex)
 {
+    applyRemoteCommands();
+    if(!mapped){
+        flushPushToClient();
+    }
+    flushJournal();
     if(show){
         ofPushMatrix();
         ofTranslate(drawArea.x, drawArea.y);
@@ -365,7 +969,7 @@ void RemoteWarpBase::drawWarp(const ofTexture& tex)
 
 void RemoteWarpBase::queueControlPoint(const glm::vec2 & pos, const ofFloatColor & color, float scale)
 {
-    if (controlData.size() < MAX_NUM_CONTROL_POINTS)
+    if (controlData.size() < MAX_NUM_DRAWN_CONTROLS)
     {
         controlData.emplace_back(ControlData(pos, color, scale));
     }
@@ -376,10 +980,12 @@ void RemoteWarpBase::drawControlPointNames()
     ofPushStyle();
     ofSetColor(255, 0, 128);
     ofFill();
-    int i = 0;
-    for(auto& cp : controlPoints){
-        auto pos = cp * glm::vec2(drawArea.width,drawArea.height);
-        ofDrawBitmapString("cp"+ofToString(i++), pos.x+2, pos.y+2);
+    // Dense grids would be a wall of text, only their selected points are named.
+    auto dense = isDenseGrid();
+    for(size_t i = 0; i < controlPoints.size(); ++i){
+        if(dense && !isControlPointSelected(i)) continue;
+        auto pos = controlPoints[i] * glm::vec2(drawArea.width,drawArea.height);
+        ofDrawBitmapString("cp"+ofToString(i), pos.x+2, pos.y+2);
     }
     ofPopStyle();
 }
@@ -461,7 +1067,8 @@ ofRectangle RemoteWarpBase::getBounds() const
 //--------------------------------------------------------------
 void RemoteWarpBase::setBrightness(float brightness)
 {
-    brightness = brightness;
+    this->brightness = brightness;
+    blendChanged();
 }
 
 //--------------------------------------------------------------
@@ -474,18 +1081,21 @@ float RemoteWarpBase::getBrightness() const
 void RemoteWarpBase::setLuminance(float lum)
 {
     luminance = glm::vec3(lum);
+    blendChanged();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBase::setLuminance(float red, float green, float blue)
 {
     luminance = glm::vec3(red, green, blue);
+    blendChanged();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBase::setLuminance(const glm::vec3 & rgb)
 {
     luminance = rgb;
+    blendChanged();
 }
 
 //--------------------------------------------------------------
@@ -498,18 +1108,21 @@ const glm::vec3 & RemoteWarpBase::getLuminance() const
 void RemoteWarpBase::setGamma(float g)
 {
     gamma = glm::vec3(g);
+    blendChanged();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBase::setGamma(float red, float green, float blue)
 {
     gamma = glm::vec3(red, green, blue);
+    blendChanged();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBase::setGamma(const glm::vec3 & rgb)
 {
     gamma = rgb;
+    blendChanged();
 }
 
 //--------------------------------------------------------------
@@ -521,7 +1134,8 @@ const glm::vec3 & RemoteWarpBase::getGamma() const
 //--------------------------------------------------------------
 void RemoteWarpBase::setExponent(float exponent)
 {
-    exponent = exponent;
+    this->exponent = exponent;
+    blendChanged();
 }
 
 //--------------------------------------------------------------
@@ -543,6 +1157,7 @@ void RemoteWarpBase::setEdges(const glm::vec4 & e)
     edges.y = ofClamp(e.y * 0.5f, 0.0f, 1.0f);
     edges.z = ofClamp(e.z * 0.5f, 0.0f, 1.0f);
     edges.w = ofClamp(e.w * 0.5f, 0.0f, 1.0f);
+    blendChanged();
 }
 
 //--------------------------------------------------------------
@@ -566,71 +1181,23 @@ void RemoteWarpBase::draw(const ofTexture & texture, const ofRectangle & srcBoun
 //--------------------------------------------------------------
 void RemoteWarpBase::draw(const ofTexture & texture, const ofRectangle & srcBounds, const ofRectangle & dstBounds)
 {
-    drawTexture(texture, srcBounds, dstBounds);
-    drawControls();
+    {
+        RemoteWarpStats::Timer timer(*stats, RemoteWarpStats::STAGE_DRAW_TEXTURE);
+        drawTexture(texture, srcBounds, dstBounds);
+    }
+    {
+        RemoteWarpStats::Timer timer(*stats, RemoteWarpStats::STAGE_DRAW_CONTROLS);
+        drawControls();
+    }
 }
 
 //--------------------------------------------------------------
 bool RemoteWarpBase::clip(ofRectangle & srcBounds, ofRectangle & dstBounds) const
 {
-    bool clipped = false;
-    
     glm::vec4 srcVec = glm::vec4(srcBounds.getMinX(), srcBounds.getMinY(), srcBounds.getMaxX(), srcBounds.getMaxY());
     glm::vec4 dstVec = glm::vec4(dstBounds.getMinX(), dstBounds.getMinY(), dstBounds.getMaxX(), dstBounds.getMaxY());
     
-    float x1 = dstVec.x / width;
-    float x2 = dstVec.z / width;
-    float y1 = dstVec.y / height;
-    float y2 = dstVec.w / height;
-    
-    if (x1 < 0.0f)
-    {
-        dstVec.x = 0.0f;
-        srcVec.x -= (x1 * srcBounds.getWidth());
-        clipped = true;
-    }
-    else if (x1 > 1.0f)
-    {
-        dstVec.x = width;
-        srcVec.x -= ((1.0f / x1) * srcBounds.getWidth());
-        clipped = true;
-    }
-    
-    if (x2 < 0.0f)
-    {
-        dstVec.z = 0.0f;
-        srcVec.z -= (x2 * srcBounds.getWidth());
-        clipped = true;
-    }
-    else if (x2 > 1.0f) {
-        dstVec.z = width;
-        srcVec.z -= ((1.0f / x2) * srcBounds.getWidth());
-        clipped = true;
-    }
-    
-    if (y1 < 0.0f)
-    {
-        dstVec.y = 0.0f;
-        srcVec.y -= (y1 * srcBounds.getHeight());
-        clipped = true;
-    }
-    else if (y1 > 1.0f)
-    {
-        dstVec.y = height;
-        srcVec.y -= ((1.0f / y1) * srcBounds.getHeight());
-        clipped = true;
-    }
-    
-    if (y2 < 0.0f) {
-        dstVec.w = 0.0f;
-        srcVec.w -= (y2 * srcBounds.getHeight());
-        clipped = true;
-    }
-    else if (y2 > 1.0f) {
-        dstVec.w = height;
-        srcVec.w -= ((1.0f / y2) * srcBounds.getHeight());
-        clipped = true;
-    }
+    bool clipped = RemoteGeometry::clip(srcVec, dstVec, glm::vec2(width, height));
     
     srcBounds.set(srcVec.x, srcVec.y, srcVec.z - srcVec.x, srcVec.w - srcVec.y);
     dstBounds.set(dstVec.x, dstVec.y, dstVec.z - dstVec.x, dstVec.w - dstVec.y);
@@ -652,7 +1219,9 @@ void RemoteWarpBase::setControlPoint(size_t index, const glm::vec2 & pos)
     if (index >= controlPoints.size()) return;
     
     controlPoints[index] = pos;
-    dirty = true;
+    journalControlPoint(index);
+    controlPointMoved(index);
+    remoteStale = true;
 }
 
 //--------------------------------------------------------------
@@ -661,7 +1230,9 @@ void RemoteWarpBase::moveControlPoint(size_t index, const glm::vec2 & shift)
     if (index >= controlPoints.size()) return;
     
     controlPoints[index] += shift;
-    dirty = true;
+    journalControlPoint(index);
+    controlPointMoved(index);
+    remoteStale = true;
 }
 
 //--------------------------------------------------------------
@@ -684,15 +1255,16 @@ std::vector<size_t> RemoteWarpBase::getSelectedControlPoints() const
 void RemoteWarpBase::selectControlPoint(size_t index)
 {
     if (index >= controlPoints.size())return;
-    auto found = std::find_if(selectedIndices.begin(), selectedIndices.end(), [index](const Selection& sel){
-        return sel.index == index;
+    // Areas are selected in index order, so this usually appends.
+    auto found = std::lower_bound(selectedIndices.begin(), selectedIndices.end(), index, [](const Selection& sel, size_t index){
+        return sel.index < index;
     });
-    if(found != selectedIndices.end()){
+    if(found != selectedIndices.end() && found->index == index){
         return;
     }else{
         Selection s;
         s.index = index;
-        selectedIndices.push_back(s);
+        selectedIndices.insert(found, s);
     }
 }
 
@@ -700,10 +1272,10 @@ void RemoteWarpBase::selectControlPoint(size_t index)
 void RemoteWarpBase::deselectControlPoint(size_t index)
 {
     if (index >= controlPoints.size())return;
-    auto found = std::find_if(selectedIndices.begin(), selectedIndices.end(), [index](const Selection& sel){
-        return sel.index == index;
+    auto found = std::lower_bound(selectedIndices.begin(), selectedIndices.end(), index, [](const Selection& sel, size_t index){
+        return sel.index < index;
     });
-    if(found != selectedIndices.end())
+    if(found != selectedIndices.end() && found->index == index)
         selectedIndices.erase(found);
 }
 
@@ -712,38 +1284,63 @@ void RemoteWarpBase::deselectAllControlPoints()
     selectedIndices.clear();
 }
 
+//--------------------------------------------------------------
+bool RemoteWarpBase::isControlPointSelected(size_t index) const
+{
+    auto found = std::lower_bound(selectedIndices.begin(), selectedIndices.end(), index, [](const Selection& sel, size_t index){
+        return sel.index < index;
+    });
+    return found != selectedIndices.end() && found->index == index;
+}
+
+//--------------------------------------------------------------
+bool RemoteWarpBase::isControlPointShown(size_t index, const glm::vec2 & pos, const glm::vec2 & cursor) const
+{
+    if (!isDenseGrid()) return true;
+    auto offset = pos - cursor;
+    return glm::dot(offset, offset) <= controlOverlayRadius * controlOverlayRadius || isControlPointSelected(index);
+}
+
 std::vector<size_t> RemoteWarpBase::getControlPointsInArea(const ofRectangle& area)
 {
+    RemoteFrameArena::Scope scope;
+    auto points = getControlPointsInDrawArea();
     std::vector<size_t> indices;
-    for (auto i = 0; i < controlPoints.size(); ++i)
-    {
-        auto cpPos = getControlPoint(i) * glm::vec2(drawArea.width,drawArea.height) + drawArea.getTopLeft();
-        if(area.inside(cpPos)){
-            indices.push_back(i);
-        }
-    }
+    RemoteGeometry::findPointsInArea(points.data(), points.size(), glm::vec2(area.getMinX(), area.getMinY()), glm::vec2(area.getMaxX(), area.getMaxY()), indices);
     return indices;
 }
 
+//--------------------------------------------------------------
+bool RemoteWarpBase::selectControlPointsInArea(const ofRectangle& area)
+{
+    RemoteFrameArena::Scope scope;
+    auto points = getControlPointsInDrawArea();
+    RemoteArenaVector<size_t> indices;
+    RemoteGeometry::findPointsInArea(points.data(), points.size(), glm::vec2(area.getMinX(), area.getMinY()), glm::vec2(area.getMaxX(), area.getMaxY()), indices);
+    for(auto index : indices){
+        selectControlPoint(index);
+    }
+    return !indices.empty();
+}
+
 //--------------------------------------------------------------
 size_t RemoteWarpBase::findClosestControlPoint(const glm::vec2 & pos, float * distance)
 {
-    size_t index;
-    auto minDistance = std::numeric_limits<float>::max();
-    
-    for (auto i = 0; i < controlPoints.size(); ++i)
+    RemoteFrameArena::Scope scope;
+    auto points = getControlPointsInDrawArea();
+    return RemoteGeometry::findClosestPoint(points.data(), points.size(), pos, distance);
+}
+
+//--------------------------------------------------------------
+RemoteArenaVector<glm::vec2> RemoteWarpBase::getControlPointsInDrawArea()
+{
+    RemoteArenaVector<glm::vec2> points(controlPoints.size());
+    auto scale = glm::vec2(drawArea.width, drawArea.height);
+    for (size_t i = 0; i < points.size(); ++i)
     {
-        auto cpPos = getControlPoint(i) * glm::vec2(drawArea.width,drawArea.height) + drawArea.getTopLeft();
-        auto candidate = glm::distance(pos, cpPos);
-        if (candidate < minDistance)
-        {
-            minDistance = candidate;
-            index = i;
-        }
+        points[i] = getControlPoint(i) * scale + drawArea.getTopLeft();
     }
-    
-    *distance = minDistance;
-    return index;
+    return points;
 }
 
 //--------------------------------------------------------------
@@ -803,7 +1400,7 @@ void RemoteWarpBase::setupControlPoints()
         
         // Set up per-instance data to the vbo.
         std::vector<ControlData> instanceData;
-        instanceData.resize(MAX_NUM_CONTROL_POINTS);
+        instanceData.resize(MAX_NUM_DRAWN_CONTROLS);
         
         controlMesh.getVbo().setAttributeData(INSTANCE_POS_SCALE_ATTRIBUTE, (float *)&instanceData[0].pos, 4, instanceData.size(), GL_STREAM_DRAW, sizeof(ControlData));
         controlMesh.getVbo().setAttributeDivisor(INSTANCE_POS_SCALE_ATTRIBUTE, 1);
@@ -909,8 +1506,6 @@ bool RemoteWarpBase::handleCursorDrag(const glm::vec2 & pos)
         setControlPoint(selection.index, screenPoint / ofGetWindowSize());
     }
     
-    dirty = true;
-    
     return true;
 }
 
@@ -8,7 +8,17 @@
 #pragma once
 
 #include "ofxRemoteUIServer.h"
-#include <list>
+#include "RemoteWarpJournal.h"
+#include "RemoteWarpJson.h"
+#include "RemoteCommandQueue.h"
+#include "RemoteClientMirror.h"
+#include "RemoteFrameArena.h"
+#include "RemoteWarpStats.h"
+#include "RemoteGeometry.h"
+#include "RemoteWarpMemory.h"
+#include "RemoteShadow.h"
+#include <atomic>
+#include <future>
 
 #define OF_GLSL(vers, code) "#version "#vers"\n "#code
 
@@ -64,25 +74,93 @@ struct WarpSettings {
     int _height;
 };
 
+//! an edit received from RemoteUI, applied by the render thread at the start of the next frame
+struct RemoteWarpCommand {
+    
+    typedef enum
+    {
+        COMMAND_NONE,
+        //! index: entry in the warp's shared float params, value.x: new value
+        COMMAND_SET_PARAM,
+        //! flag: show the warp
+        COMMAND_SHOW,
+        //! index: perspective corner, component: axis that changed
+        COMMAND_CORNER,
+        //! flag: edit mesh enabled
+        COMMAND_EDIT_MESH,
+        COMMAND_SAVE,
+        //! preset: preset to load
+        COMMAND_LOAD_PRESET,
+        //! preset: preset to save to
+        COMMAND_SAVE_PRESET,
+        //! preset: preset to delete
+        COMMAND_DELETE_PRESET,
+        //! reload the no_preset snapshot
+        COMMAND_RESET,
+        //! index: number of columns
+        COMMAND_NUM_CONTROLS_X,
+        //! index: number of rows
+        COMMAND_NUM_CONTROLS_Y,
+        //! index: mesh resolution
+        COMMAND_RESOLUTION,
+        COMMAND_INCREASE_RESOLUTION,
+        COMMAND_DECREASE_RESOLUTION,
+        //! flag: linear interpolation
+        COMMAND_LINEAR,
+        //! flag: adaptive resolution
+        COMMAND_ADAPTIVE,
+        COMMAND_FLIP_HORIZONTAL,
+        COMMAND_FLIP_VERTICAL,
+        COMMAND_ROTATE_CLOCKWISE,
+        COMMAND_ROTATE_COUNTERCLOCKWISE
+    } Type;
+    
+    Type type{COMMAND_NONE};
+    int index{0};
+    int component{0};
+    glm::vec2 value;
+    bool flag{false};
+    std::string preset;
+};
+
 class RemoteWarpBase {
 public:
     
     RemoteWarpBase(const std::string& name, const WarpSettings& settings);
     virtual ~RemoteWarpBase();
     
+    //! listen to the remote UI and share the warp's params with it, called when the warp is added to its mapper.
+    //! warps that are never shared, in tools and tests, don't need a RemoteUI server
+    void share();
+    //! stop listening to the remote UI and remove every param the warp shared, called when the warp is removed from its mapper.
+    //! the warp still draws, it just can't be edited remotely anymore
+    void unshare();
+    //! set while the warp belongs to a mapper, which then sends the pushes to the client once per frame instead of drawWarp
+    inline void setMapped(bool mapped){ this->mapped = mapped; }
+    inline bool isMapped() const { return mapped; }
+    
     inline const std::string& getName()const{return warpName;}
     inline const ofRectangle& getSrcArea()const{return srcArea;}
     inline const ofRectangle& getDrawArea()const{return drawArea;}
     inline glm::ivec2 getSrcSize()const{ return glm::ivec2(width,height); }
+    inline const std::string& getCurrentPreset()const{return currentPreset;}
+    //! name of the per preset snapshot file
+    static const std::string& getSaveFilename(){ return sSaveFilename; }
+    
+    inline void setSrcArea(const ofRectangle& area){ srcArea = area; dirty = true; remoteStale = true; }
+    inline void setDrawArea(const ofRectangle& area){ drawArea = area; dirty = true; remoteStale = true; }
 
-    //draw texture to warpped mapping
+    //draw texture to warpped mapping. without a mapper it also sends requested pushes to the client
     virtual void drawWarp(const ofTexture& tex);
+    //do the CPU side geometry work for the next draw without touching GL, warps that weren't updated do it while drawing.
+    //different warps can be updated on different threads at the same time
+    virtual void update();
     
     //! returns the type of the warp
     WarpSettings::Type getType() const;
     
-    virtual void serialize(nlohmann::json & json);
-    virtual void deserialize(const nlohmann::json & json);
+    virtual void serialize(WarpRecord & record) const;
+    virtual void deserialize(const WarpRecord & record);
     
     virtual void setEditing(bool editing);
     void toggleEditing();
@@ -153,6 +231,8 @@ public:
     virtual void moveControlPoint(size_t index, const glm::vec2 & shift);
     //! get the number of control points
     virtual size_t getNumControlPoints() const;
+    //! return every control point in normalized warp space, column major
+    inline const std::vector<glm::vec2>& getControlPoints() const { return controlPoints; }
     //! get the index of the currently selected control point
     virtual std::vector<size_t> getSelectedControlPoints() const;
     //! select one of the control points
@@ -161,17 +241,31 @@ public:
     virtual void deselectControlPoint(size_t index);
     //! deselect the selected control point
     virtual void deselectAllControlPoints();
+    //! return whether the specified control point is selected
+    bool isControlPointSelected(size_t index) const;
     //! return the index of the closest control point, as well as the distance in pixels
     virtual size_t findClosestControlPoint(const glm::vec2 & pos, float * distance);
     
     //!return a list of controlpoints inside a specific area
     virtual std::vector<size_t> getControlPointsInArea(const ofRectangle& area);
+    //! select every control point inside a specific area, returns false if there were none. only allocates from the frame arena
+    bool selectControlPointsInArea(const ofRectangle& area);
     
     //! return the number of control points columns
     size_t getNumControlsX() const;
     //! return the number of control points rows
     size_t getNumControlsY() const;
     
+    //! replace the whole control grid, column major. warps that can't change their grid size only take grids of their size
+    virtual bool setControlGrid(int columns, int rows, const std::vector<glm::vec2>& points);
+    //! replace the control grid with one read from a text file holding a row of "x y" points per line (see RemoteControlGrid::parse)
+    //! or from the controlpoints.json of a warp
+    bool importControlGrid(const std::filesystem::path& file);
+    
+    //! distance from the cursor in pixels within which dense grids show their control points while editing
+    inline void setControlOverlayRadius(float radius){ controlOverlayRadius = radius; }
+    inline float getControlOverlayRadius() const { return controlOverlayRadius; }
+    
     virtual void rotateClockwise() = 0;
     virtual void rotateCounterclockwise() = 0;
     
@@ -184,6 +278,59 @@ public:
     virtual bool handleWindowResize(int width, int height);
     
     virtual void loadPreset(const std::string& preset);
+    
+    //! apply a snapshot of preset that was changed on disk by another process, returns false if it was skipped
+    bool reloadControlPoints(const std::string& preset, const WarpRecord& record, size_t hash);
+    
+    //! apply the edits queued by RemoteUI since the last frame, called by the render thread before drawing
+    void applyRemoteCommands();
+    
+    //! returns true once after the control grid changed while editing remotely and should be sent over the grid channel
+    bool takeGridPublishRequest();
+    //! replace the whole control grid with one received over the grid channel, the grid size has to match
+    bool setRemoteGrid(int columns, int rows, const std::vector<glm::vec2>& points);
+    //! set a single control point received over the grid channel, in normalized warp space
+    bool setRemoteControlPoint(size_t index, const glm::vec2& pos);
+    
+    //! set a control point streamed by a tracker, in normalized warp space. streamed edits skip the journal, save the warp to keep them
+    bool setStreamedControlPoint(size_t index, const glm::vec2& pos);
+    //! set a perspective corner streamed by a tracker (0 is top left, then clockwise), returns false if the warp has no corners
+    virtual bool setStreamedCorner(size_t index, const glm::vec2& pos);
+    
+    //! on the replication leader every journaled edit is kept for the followers, and preset loads, saves and deletes are held back until the leader schedules them
+    void setReplicationLeader(bool leader);
+    inline bool isReplicationLeader() const { return replicationLeader; }
+    //! append the edits made since the last call as journal records, returns false if there were none
+    bool takeReplicatedRecords(std::vector<char>& records);
+    //! send the complete state with the next replicated records, for followers that lost track
+    inline void requestReplicatedState(){ replicateState = replicationLeader; }
+    //! apply journal records replicated by the leader, they are journaled locally as well
+    void applyReplicatedRecords(const char* data, size_t size);
+    //! take the oldest preset load, save or delete held back for the leader to schedule, returns false if there is none
+    bool takePresetCommand(RemoteWarpCommand& command);
+    //! load, save or delete a preset right away, used to run preset commands on the frame the leader scheduled them for
+    void applyPresetCommand(const RemoteWarpCommand& command);
+    //! returns false for preset names that aren't a single directory inside the warp's save location, they come in over the network
+    bool isPresetName(const std::string& preset) const;
+    
+    //! ask for the shared params to be sent to the client, requests are coalesced until the next flush
+    static void requestPushToClient();
+    //! send the shared params that changed since the last push to the client if a push was requested since the last flush, called once per frame
+    static void flushPushToClient();
+    
+    //! timings of the warp's stages and what it rebuilt and uploaded
+    inline RemoteWarpStats& getStats(){ return *stats; }
+    //! the warp's name as interned for RemoteTrace spans
+    inline const char* getTraceName() const { return stats->getTraceName(); }
+    
+    //! bytes the warp holds right now. texture coordinates and indices shared with other warps are counted in full
+    virtual RemoteWarpMemory getMemory() const;
+    //! take the warp's memory as current and raise its high-water marks, the mapper does this once per frame
+    void sampleMemory();
+    inline const RemoteMemoryReport& getMemoryReport() const { return memoryReport; }
+    void resetMemoryPeaks();
+    //! bytes of the records and text buffers saveControlPoints and loadControlPoints keep around on every thread
+    static size_t getJsonCacheBytes();
         
 protected:
     
@@ -196,6 +343,8 @@ protected:
     
     //! adjust both the source and destination rectangles so that they are clipped against the warp's content
     bool clip(ofRectangle & srcBounds, ofRectangle & dstBounds) const;
+    //! every control point as getControlPoint returns it, in draw area pixels, allocated from the calling thread's frame arena
+    RemoteArenaVector<glm::vec2> getControlPointsInDrawArea();
     
     //! draw a specific area of a warped texture to a specific region
     virtual void drawTexture(const ofTexture & texture, const ofRectangle & srcBounds, const ofRectangle & dstBounds) = 0;
@@ -206,6 +355,10 @@ protected:
     void queueControlPoint(const glm::vec2 & pos, bool selected = false, bool attached = false);
     //! draw a control point in the specified color
     void queueControlPoint(const glm::vec2 & pos, const ofFloatColor & color, float scale = 1.0f);
+    //! grids with more control points than the overlay draws only show the selected ones and those near the cursor
+    inline bool isDenseGrid() const { return controlPoints.size() > MAX_NUM_DRAWN_CONTROLS; }
+    //! return whether the overlay shows the specified control point at pos, in window pixels like cursor
+    bool isControlPointShown(size_t index, const glm::vec2 & pos, const glm::vec2 & cursor) const;
     
     //! setup the control points instanced vbo
     void setupControlPoints();
@@ -215,18 +368,63 @@ protected:
 protected:
     
     static std::string sSaveFilename;
+    static std::string sJournalFilename;
+    static std::atomic<bool> sPushRequested;
+    static RemoteClientMirror sClientMirror;
+    //! number of journaled edits after which the journal is folded back into the snapshot
+    static size_t sJournalCompactionThreshold;
     
+    //! runs on the thread delivering RemoteUI events, translates them into commands
     virtual void handleRemoteUpdate(RemoteUIServerCallBackArg & arg);
-    
-    bool saveGroup{false};
+    //! runs on the render thread
+    virtual void applyCommand(const RemoteWarpCommand & command);
+    void pushCommand(const RemoteWarpCommand & command);
+    //! share the warp's params with RemoteUI, subclasses share theirs after calling this
+    virtual void shareRemoteParams();
+    //! queue the value of every shared param, used after RemoteUI wrote a whole preset into them
+    virtual void pushRemoteState();
+    //! copy the params shared with RemoteUI into the warp, only used before the first frame
+    virtual void pullRemoteParams();
+    //! copy the warp's values into the params shared with RemoteUI
+    virtual void syncRemoteParams();
+    
+    //! share a float with RemoteUI through a shadow copy, edits reach value through the command queue
+    void shareRemoteParam(const std::string& name, float & value, float min, float max, bool blend = false);
+    
+    RemoteShadow<bool> saveGroup{false};
     bool remoteEditMode{false};
     
     virtual void addControlPoints();
     virtual void removeControlPoints();
     
+    //! called after a single control point moved, warps with a mesh only rebuild the part of it the point influences
+    virtual void controlPointMoved(size_t index);
+    
     void saveControlPoints(const std::filesystem::path& file);
     void loadControlPoints(const std::filesystem::path& file);
     
+    //! append the complete replicated state (grid, blend and corners) as journal records
+    virtual void encodeReplicatedState(std::vector<char>& records) const;
+    
+    //! apply a single journaled edit on top of the loaded snapshot
+    virtual void replayJournalRecord(const RemoteWarpJournal::Record& record);
+    //! return the journal of the current preset, opening it if needed
+    RemoteWarpJournal& getJournal();
+    void journalControlPoint(size_t index);
+    void journalControlGrid();
+    void journalBlend();
+    //! copy a grid of the warp's size over the control points and journal it, module names the caller in the warning
+    bool copyControlGrid(int columns, int rows, const std::vector<glm::vec2>& points, const std::string& module);
+    //! journal the blend settings changed through the public setters and bring the remote params up to date
+    void blendChanged();
+    //! write pending journal records, compacting them into the snapshot once the journal grows too long
+    void flushJournal();
+    //! write a snapshot of the warp on the thread pool, the journal records it holds are dropped by finishCompaction
+    void startCompaction();
+    //! once the snapshot started by startCompaction is in place drop the journal records it holds, when wait is set
+    //! block until it is, so an older snapshot never replaces one written after it
+    void finishCompaction(bool wait);
+    
     void drawControlPointNames();
 
     std::string ctrlptPrefix;
@@ -261,14 +459,20 @@ protected:
         glm::vec2 offset;
     };
     
-    std::list<Selection> selectedIndices;
+    //! sorted by index
+    std::vector<Selection> selectedIndices;
   
     glm::vec3 luminance;
     glm::vec3 gamma;
     float exponent;
     glm::vec4 edges;
     
-    static const int MAX_NUM_CONTROL_POINTS = 1024;
+    //! largest grid. whole grids are sent as single datagrams over the grid channel and replication, 4096 points take 32 kB
+    static const int MAX_NUM_CONTROL_POINTS = 4096;
+    static const int MAX_NUM_CONTROLS = 128;
+    //! control point instances the overlay draws at most
+    static const int MAX_NUM_DRAWN_CONTROLS = 1024;
+    float controlOverlayRadius{100.0f};
         
     typedef enum
     {
@@ -297,4 +501,63 @@ protected:
     ofVboMesh controlMesh;
     ofShader controlShader;
     
+    RemoteWarpJournal journal;
+    //! hash of the snapshot contents last written or read by this warp
+    size_t snapshotHash{0};
+    
+    //! a snapshot being written on the thread pool, shared with the job writing it
+    struct Compaction {
+        WarpRecord record;
+        std::filesystem::path file;
+        std::filesystem::path journalFile;
+        //! journal size when the snapshot was taken, the records before it are in the snapshot
+        size_t journalSize{0};
+        //! hash of the snapshot contents, set before the snapshot replaces the old one
+        std::atomic<size_t> hash{0};
+        bool written{false};
+        std::promise<void> done;
+    };
+    std::shared_ptr<Compaction> compaction;
+    std::future<void> compactionDone;
+    
+    struct RemoteParam {
+        std::string name;
+        //! value written by RemoteUI
+        std::unique_ptr<RemoteShadow<float>> shadow;
+        //! value used by the warp
+        float* value;
+        bool blend;
+    };
+    std::vector<RemoteParam> remoteParams;
+    
+    //remoteUI shadows, only written by RemoteUI and syncRemoteParams
+    RemoteShadow<bool> remoteShow{true};
+    RemoteShadow<bool> remoteEditMesh{false};
+    //! set when the grid should be sent over the grid channel
+    bool gridPublishRequested{false};
+    //! see share
+    bool shared{false};
+    //! false until the shadows restored by RemoteUI have been copied into the warp
+    bool remoteSynced{false};
+    //! set when the warp changed outside of a remote edit and the shadows need to catch up
+    bool remoteStale{false};
+    
+    //! see setMapped
+    bool mapped{false};
+    
+    //! replication leader state, see setReplicationLeader
+    bool replicationLeader{false};
+    //! set when the warp changed without journaling and the followers need the whole state
+    bool replicateState{false};
+    std::vector<RemoteWarpCommand> heldPresetCommands;
+    
+    RemoteCommandQueue<RemoteWarpCommand, 256> commands;
+    //! reused by applyRemoteCommands so popping doesn't allocate
+    RemoteWarpCommand poppedCommand;
+    
+    //! shared with the jobs building the warp's mesh, they may finish after the warp is gone
+    std::shared_ptr<RemoteWarpStats> stats{std::make_shared<RemoteWarpStats>()};
+    
+    RemoteMemoryReport memoryReport;
+    
 };
@@ -18,14 +18,21 @@ static const std::string blVert = OF_GLSL(150,
       in vec4 color;
       
       // App uniforms and attributes
+      uniform vec4 uCorners;
+      uniform vec4 uPositionTransform;
+      
       out vec2 vTexCoord;
+      out vec2 vMapCoord;
       out vec4 vColor;
       
       void main(void){
-            vTexCoord = texcoord;
+            // The shared mesh spans 0 to 1, the corners pick the part of the texture.
+            vTexCoord = mix(uCorners.xy, uCorners.zw, texcoord);
+            vMapCoord = texcoord;
             vColor = globalColor;
             
-            gl_Position = modelViewProjectionMatrix * position;
+            // Packed positions are fractions of the mesh's bounds, float ones pass through.
+            gl_Position = modelViewProjectionMatrix * vec4(uPositionTransform.xy + position.xy * uPositionTransform.zw, 0.0, 1.0);
         }
     );
 static const std::string blFrag = OF_GLSL(150,
@@ -34,20 +41,15 @@ static const std::string blFrag = OF_GLSL(150,
       uniform vec3 uLuminance;
       uniform vec3 uGamma;
       uniform vec4 uEdges;
-      uniform vec4 uCorners;
       uniform float uExponent;
       uniform bool uEditing;
       
     in vec2 vTexCoord;
+    in vec2 vMapCoord;
     in vec4 vColor;
       
     out vec4 fragColor;
       
-    float map(in float value, in float inMin, in float inMax, in float outMin, in float outMax)
-    {
-            return outMin + (outMax - outMin) * (value - inMin) / (inMax - inMin);
-    }
-                                          
     float grid(in vec2 uv, in vec2 size)
     {
         vec2 coord = uv / size;
@@ -60,7 +62,7 @@ static const std::string blFrag = OF_GLSL(150,
     {
         vec4 texColor = texture(uTexture, vTexCoord);
         
-        vec2 mapCoord = vec2(map(vTexCoord.x, uCorners.x, uCorners.z, 0.0, 1.0), map(vTexCoord.y, uCorners.y, uCorners.w, 0.0, 1.0));
+        vec2 mapCoord = vMapCoord;
         
         float a = 1.0;
         if (uEdges.x > 0.0) a *= clamp(mapCoord.x / uEdges.x, 0.0, 1.0);
@@ -86,34 +88,17 @@ static const std::string blFrag = OF_GLSL(150,
     }
     );
 
+bool RemoteWarpBilinear::sCompactVertices = false;
+
 RemoteWarpBilinear::RemoteWarpBilinear(const std::string& name, const WarpSettings& settings) :
     RemoteWarpBase(name, settings.type(WarpSettings::TYPE_BILINEAR)),
     linear(false),
     adaptive(true),
     corners(0.0f, 0.0f, 1.0f, 1.0f),
-    resolutionX(0),
-    resolutionY(0),
     resolution(16),  // higher value is coarser mesh
     remoteNumControlsX(2),
     remoteNumControlsY(2)
 {
-    if(!this->shader.isLoaded()){
-        this->shader.setupShaderFromSource(GL_VERTEX_SHADER, blVert);
-        this->shader.setupShaderFromSource(GL_FRAGMENT_SHADER, blFrag);
-        this->shader.bindDefaults();
-        this->shader.linkProgram();
-    }
-    
-    RUI_SHARE_PARAM_WCN(warpName+"-adaptive",adaptive);
-    RUI_SHARE_PARAM_WCN(warpName+"-linear",linear);
-    RUI_SHARE_PARAM_WCN(warpName+"-numControlsX",remoteNumControlsX,2,10);
-    RUI_SHARE_PARAM_WCN(warpName+"-numControlsY",remoteNumControlsY,2,10);
-    RUI_SHARE_PARAM_WCN(warpName+"-incResolution",remoteIncRes);
-    RUI_SHARE_PARAM_WCN(warpName+"-decResolution",remoteDecRes);
-    RUI_SHARE_PARAM_WCN(warpName+"-resolution",resolution,16,128);
-    RUI_SHARE_PARAM_WCN(warpName+"-flipVertical",remoteFlipV);
-    RUI_SHARE_PARAM_WCN(warpName+"-flipHorizontal",remoteFlipH);
-    
     if(std::filesystem::exists(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename)){
         loadControlPoints(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename);
         dirty = true;
@@ -124,6 +109,26 @@ RemoteWarpBilinear::RemoteWarpBilinear(const std::string& name, const WarpSettin
 
 RemoteWarpBilinear::~RemoteWarpBilinear()
 {
+    if (this->compactVertexArray)
+    {
+        glDeleteVertexArrays(1, &this->compactVertexArray);
+    }
+}
+
+void RemoteWarpBilinear::shareRemoteParams()
+{
+    RemoteWarpBase::shareRemoteParams();
+    
+    RUI_SHARE_PARAM_WCN(warpName+"-adaptive",remoteAdaptive.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-linear",remoteLinear.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-numControlsX",remoteNumControlsX.bind(),2,MAX_NUM_CONTROLS);
+    RUI_SHARE_PARAM_WCN(warpName+"-numControlsY",remoteNumControlsY.bind(),2,MAX_NUM_CONTROLS);
+    RUI_SHARE_PARAM_WCN(warpName+"-incResolution",remoteIncRes.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-decResolution",remoteDecRes.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-resolution",remoteResolution.bind(),16,128);
+    shareRemoteParam(warpName+"-tolerance", this->tolerance, 0.0f, 8.0f);
+    RUI_SHARE_PARAM_WCN(warpName+"-flipVertical",remoteFlipV.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-flipHorizontal",remoteFlipH.bind());
 }
 
 void RemoteWarpBilinear::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
@@ -131,30 +136,46 @@ void RemoteWarpBilinear::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
     switch (arg.action) {
         case CLIENT_UPDATED_PARAM:
             if(arg.group == remoteGroupName){
-                if(arg.paramName == (warpName+"-adaptive") || arg.paramName == (warpName+"-linear") ||  arg.paramName == (warpName+"-resolution")){
-                    dirty = true;
+                RemoteWarpCommand command;
+                bool resetButton = false;
+                if(arg.paramName == (warpName+"-adaptive")){
+                    command.type = RemoteWarpCommand::COMMAND_ADAPTIVE;
+                    command.flag = arg.param.boolVal;
+                }else if(arg.paramName == (warpName+"-linear")){
+                    command.type = RemoteWarpCommand::COMMAND_LINEAR;
+                    command.flag = arg.param.boolVal;
+                }else if(arg.paramName == (warpName+"-resolution")){
+                    command.type = RemoteWarpCommand::COMMAND_RESOLUTION;
+                    command.index = arg.param.intVal;
                 }else if(arg.paramName == (warpName+"-numControlsX")){
-                    setNumControlsX(remoteNumControlsX);
+                    command.type = RemoteWarpCommand::COMMAND_NUM_CONTROLS_X;
+                    command.index = arg.param.intVal;
                 }else if(arg.paramName == (warpName+"-numControlsY")){
-                    setNumControlsY(remoteNumControlsY);
+                    command.type = RemoteWarpCommand::COMMAND_NUM_CONTROLS_Y;
+                    command.index = arg.param.intVal;
                 }else if(arg.paramName == (warpName+"-incResolution")){
-                    increaseResolution();
+                    command.type = RemoteWarpCommand::COMMAND_INCREASE_RESOLUTION;
                     remoteIncRes = false;
-                    RUI_PUSH_TO_CLIENT();
+                    resetButton = true;
                 }else if(arg.paramName == (warpName+"-decResolution")){
-                    decreaseResolution();
+                    command.type = RemoteWarpCommand::COMMAND_DECREASE_RESOLUTION;
                     remoteDecRes = false;
-                    RUI_PUSH_TO_CLIENT();
+                    resetButton = true;
                 }else if(arg.paramName == (warpName+"-flipHorizontal")){
-                    flipHorizontal();
+                    command.type = RemoteWarpCommand::COMMAND_FLIP_HORIZONTAL;
                     remoteFlipH = false;
-                    RUI_PUSH_TO_CLIENT();
+                    resetButton = true;
                 }else if(arg.paramName == (warpName+"-flipVertical")){
-                    flipVertical();
+                    command.type = RemoteWarpCommand::COMMAND_FLIP_VERTICAL;
                     remoteFlipV = false;
-                    RUI_PUSH_TO_CLIENT();
-                }else if( arg.paramName.substr(0,ctrlptPrefix.size()) == ctrlptPrefix ){
-                    dirty = true;
+                    resetButton = true;
+                }
+                if(command.type != RemoteWarpCommand::COMMAND_NONE){
+                    pushCommand(command);
+                    if(resetButton){
+                        requestPushToClient();
+                    }
+                    return;
                 }
             }
             break;
@@ -165,23 +186,108 @@ void RemoteWarpBilinear::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
 }
 
 //--------------------------------------------------------------
-void RemoteWarpBilinear::serialize(nlohmann::json & json)
+void RemoteWarpBilinear::applyCommand(const RemoteWarpCommand & command)
+{
+    switch (command.type) {
+        case RemoteWarpCommand::COMMAND_ADAPTIVE:
+            setAdaptive(command.flag);
+            break;
+        case RemoteWarpCommand::COMMAND_LINEAR:
+            setLinear(command.flag);
+            break;
+        case RemoteWarpCommand::COMMAND_RESOLUTION:
+            this->resolution = command.index;
+            this->dirty = true;
+            break;
+        case RemoteWarpCommand::COMMAND_NUM_CONTROLS_X:
+            setNumControlsX(command.index);
+            break;
+        case RemoteWarpCommand::COMMAND_NUM_CONTROLS_Y:
+            setNumControlsY(command.index);
+            break;
+        case RemoteWarpCommand::COMMAND_INCREASE_RESOLUTION:
+            increaseResolution();
+            this->remoteStale = true;
+            break;
+        case RemoteWarpCommand::COMMAND_DECREASE_RESOLUTION:
+            decreaseResolution();
+            this->remoteStale = true;
+            break;
+        case RemoteWarpCommand::COMMAND_FLIP_HORIZONTAL:
+            flipHorizontal();
+            break;
+        case RemoteWarpCommand::COMMAND_FLIP_VERTICAL:
+            flipVertical();
+            break;
+        default:
+            RemoteWarpBase::applyCommand(command);
+            break;
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::pushRemoteState()
+{
+    RemoteWarpBase::pushRemoteState();
+    
+    RemoteWarpCommand command;
+    command.type = RemoteWarpCommand::COMMAND_ADAPTIVE;
+    command.flag = remoteAdaptive;
+    pushCommand(command);
+    command.type = RemoteWarpCommand::COMMAND_LINEAR;
+    command.flag = remoteLinear;
+    pushCommand(command);
+    command.type = RemoteWarpCommand::COMMAND_RESOLUTION;
+    command.index = remoteResolution;
+    pushCommand(command);
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::pullRemoteParams()
+{
+    RemoteWarpBase::pullRemoteParams();
+    
+    this->adaptive = remoteAdaptive;
+    this->linear = remoteLinear;
+    this->resolution = remoteResolution;
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::syncRemoteParams()
 {
-    RemoteWarpBase::serialize(json);
+    RemoteWarpBase::syncRemoteParams();
     
-    json["resolution"] = this->resolution;
-    json["linear"] = this->linear;
-    json["adaptive"] = this->adaptive;
+    remoteAdaptive = this->adaptive;
+    remoteLinear = this->linear;
+    remoteResolution = this->resolution;
+    remoteNumControlsX = this->numControlsX;
+    remoteNumControlsY = this->numControlsY;
 }
 
 //--------------------------------------------------------------
-void RemoteWarpBilinear::deserialize(const nlohmann::json & json)
+void RemoteWarpBilinear::serialize(WarpRecord & record) const
 {
-    RemoteWarpBase::deserialize(json);
+    RemoteWarpBase::serialize(record);
     
-    this->resolution = json["resolution"];
-    this->linear = json["linear"];
-    this->adaptive = json["adaptive"];
+    record.hasBilinear = true;
+    record.resolution = this->resolution;
+    record.linear = this->linear;
+    record.adaptive = this->adaptive;
+    record.tolerance = this->tolerance;
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::deserialize(const WarpRecord & record)
+{
+    RemoteWarpBase::deserialize(record);
+    
+    if(record.hasBilinear){
+        this->resolution = record.resolution;
+        this->linear = record.linear;
+        this->adaptive = record.adaptive;
+        this->tolerance = record.tolerance;
+        this->remoteStale = true;
+    }
 }
 
 //--------------------------------------------------------------
@@ -189,6 +295,7 @@ void RemoteWarpBilinear::setLinear(bool linear)
 {
     this->linear = linear;
     this->dirty = true;
+    this->remoteStale = true;
 }
 
 //--------------------------------------------------------------
@@ -202,6 +309,7 @@ void RemoteWarpBilinear::setAdaptive(bool adaptive)
 {
     this->adaptive = adaptive;
     this->dirty = true;
+    this->remoteStale = true;
 }
 
 //--------------------------------------------------------------
@@ -236,18 +344,36 @@ int RemoteWarpBilinear::getResolution() const
     return this->resolution;
 }
 
+//--------------------------------------------------------------
+void RemoteWarpBilinear::setTolerance(float pixels)
+{
+    this->tolerance = MAX(0.0f, pixels);
+    this->dirty = true;
+    this->remoteStale = true;
+}
+
+//--------------------------------------------------------------
+float RemoteWarpBilinear::getTolerance() const
+{
+    return this->tolerance;
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::setCompactVertices(bool compact)
+{
+    sCompactVertices = compact;
+}
+
+//--------------------------------------------------------------
+bool RemoteWarpBilinear::getCompactVertices()
+{
+    return sCompactVertices;
+}
+
 //--------------------------------------------------------------
 void RemoteWarpBilinear::reset(const glm::vec2 & scale, const glm::vec2 & offset)
 {
-    this->controlPoints.clear();
-    for (auto x = 0; x < this->numControlsX; ++x)
-    {
-        for (auto y = 0; y < this->numControlsY; ++y)
-        {
-            this->controlPoints.push_back(glm::vec2(x / float(this->numControlsX - 1), y / float(this->numControlsY - 1)) * scale + offset);
-        }
-    }
-    
+    RemoteControlGrid::reset(this->controlPoints, this->numControlsX, this->numControlsY, scale, offset);
     this->dirty = true;
 }
 
@@ -260,28 +386,8 @@ void RemoteWarpBilinear::drawTexture(const ofTexture & texture, const ofRectangl
     this->clip(srcClip, dstClip);
     
     // Set corner texture coordinates.
-    if (texture.getTextureData().textureTarget == GL_TEXTURE_RECTANGLE_ARB)
-    {
-        if (texture.getTextureData().bFlipTexture)
-        {
-            this->setCorners(srcClip.getMinX(), srcClip.getMaxY(), srcClip.getMaxX(), srcClip.getMinY());
-        }
-        else
-        {
-            this->setCorners(srcClip.getMinX(), srcClip.getMinY(), srcClip.getMaxX(), srcClip.getMaxY());
-        }
-    }
-    else
-    {
-        if (texture.getTextureData().bFlipTexture)
-        {
-            this->setCorners(srcClip.getMinX() / texture.getWidth(), srcClip.getMaxY() / texture.getHeight(), srcClip.getMaxX() / texture.getWidth(), srcClip.getMinY() / texture.getHeight());
-        }
-        else
-        {
-            this->setCorners(srcClip.getMinX() / texture.getWidth(), srcClip.getMinY() / texture.getHeight(), srcClip.getMaxX() / texture.getWidth(), srcClip.getMaxY() / texture.getHeight());
-        }
-    }
+    auto corners = RemoteGeometry::getTextureCorners(glm::vec4(srcClip.getMinX(), srcClip.getMinY(), srcClip.getMaxX(), srcClip.getMaxY()), glm::vec2(texture.getWidth(), texture.getHeight()), texture.getTextureData().textureTarget != GL_TEXTURE_RECTANGLE_ARB, texture.getTextureData().bFlipTexture);
+    this->setCorners(corners.x, corners.y, corners.z, corners.w);
     
     this->setupVbo();
     
@@ -310,8 +416,40 @@ void RemoteWarpBilinear::drawTexture(const ofTexture & texture, const ofRectangl
             this->shader.setUniform4f("uCorners", this->corners);
             this->shader.setUniform1f("uExponent", this->exponent);
             this->shader.setUniform1i("uEditing", this->editing);
+            this->shader.setUniform4f("uPositionTransform", this->drawCompact ? this->compactBounds : glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
             
-            this->vbo.drawElements(GL_TRIANGLES, this->vbo.getNumIndices());
+            if (this->topology)
+            {
+                // Pick up a primitive set since the topology was made, it only depends on the resolution.
+                if (this->topology->getIndexPrimitive() != RemoteMeshTopology::getPrimitive())
+                {
+                    this->topology = RemoteMeshTopology::get(this->topology->getResolutionX(), this->topology->getResolutionY());
+                    if (!this->drawCompact)
+                    {
+                        this->vbo.setTexCoordBuffer(this->topology->getTexCoordBuffer(), sizeof(glm::vec2));
+                    }
+                    this->numIndices = this->topology->getNumIndices();
+                }
+                if (this->drawCompact)
+                {
+                    this->topology->draw(this->compactVertexArray);
+                }
+                else
+                {
+                    this->topology->draw(this->vbo);
+                }
+            }
+            else if (this->numIndices > 0)
+            {
+                if (this->drawCompact)
+                {
+                    RemoteMeshTopology::drawElements(this->compactVertexArray, this->indexBuffer, GL_TRIANGLES, this->numIndices, this->indexType);
+                }
+                else
+                {
+                    RemoteMeshTopology::drawElements(this->vbo, this->indexBuffer, GL_TRIANGLES, this->numIndices, this->indexType);
+                }
+            }
         }
         this->shader.end();
         
@@ -328,13 +466,17 @@ void RemoteWarpBilinear::drawControls()
 {
     if (this->editing)
     {
-        // Draw control points.
-        for (auto i = 0; i < this->controlPoints.size(); ++i)
+        // Draw control points, dense grids only around the cursor. The cursor is in window pixels, so it's tested against
+        // the points mapped into the draw area the same way picking them does.
+        auto cursor = glm::vec2(ofGetMouseX(), ofGetMouseY());
+        auto scale = glm::vec2(this->drawArea.width, this->drawArea.height);
+        for (size_t i = 0; i < this->controlPoints.size(); ++i)
         {
-            auto found = std::find_if(selectedIndices.begin(), selectedIndices.end(),[i](const Selection& s){
-                return s.index == i;
-            });
-            this->queueControlPoint(this->getControlPoint(i) * this->windowSize, found != selectedIndices.end());
+            auto pos = this->getControlPoint(i);
+            if (this->isControlPointShown(i, pos * scale + this->drawArea.getTopLeft(), cursor))
+            {
+                this->queueControlPoint(pos * this->windowSize, this->isControlPointSelected(i));
+            }
         }
         
         this->drawControlPoints();
@@ -345,312 +487,305 @@ void RemoteWarpBilinear::drawControls()
 //--------------------------------------------------------------
 void RemoteWarpBilinear::setupVbo()
 {
-    if (this->dirty)
+    if (!this->shader.isLoaded())
     {
-        if (this->adaptive)
-        {
-            // Determine a suitable mesh resolution based on the dimensions of the window
-            // and the size of the mesh in pixels.
-            auto meshBounds = this->getMeshBounds();
-            this->setupMesh(meshBounds.getWidth() / this->resolution, meshBounds.getHeight() / this->resolution);
-        }
-        else
-        {
-            // Use a fixed mesh resolution.
-            this->setupMesh(this->width / this->resolution, this->height / this->resolution);
-        }
-        this->updateMesh();
+        this->shader.setupShaderFromSource(GL_VERTEX_SHADER, blVert);
+        this->shader.setupShaderFromSource(GL_FRAGMENT_SHADER, blFrag);
+        this->shader.bindDefaults();
+        this->shader.linkProgram();
     }
-}
-
-//--------------------------------------------------------------
-void RemoteWarpBilinear::setupMesh(int resolutionX, int resolutionY)
-{
-    // Convert from number of quads to number of vertices.
-    ++resolutionX;
-    ++resolutionY;
     
-    // Find a value for resolutionX and resolutionY that can be evenly divided by numControlsX and numControlsY.
-    if (this->numControlsX < resolutionX)
+    if (this->compactVertices != sCompactVertices)
     {
-        int dx = (resolutionX - 1) % (this->numControlsX - 1);
-        if (dx >= (this->numControlsX / 2))
-        {
-            dx -= (this->numControlsX - 1);
-        }
-        resolutionX -= dx;
-    }
-    else
-    {
-        resolutionX = this->numControlsX;
+        this->compactVertices = sCompactVertices;
+        this->dirty = true;
     }
     
-    if (this->numControlsY < resolutionY)
+    if (this->asyncMesh)
     {
-        int dy = (resolutionY - 1) % (this->numControlsY - 1);
-        if (dy >= (this->numControlsY / 2))
+        // Changes made while drawing show up with the next finished mesh.
+        this->requestMesh(false);
+        if (auto finished = this->asyncMesh->consume())
         {
-            dy -= (this->numControlsY - 1);
+            this->uploadMesh(*finished);
         }
-        resolutionY -= dy;
     }
     else
     {
-        resolutionY = this->numControlsY;
+        this->prepareMesh();
+        this->uploadMesh(this->mesh.mesh);
+        this->mesh.clearChanges();
     }
-    
-    this->resolutionX = resolutionX;
-    this->resolutionY = resolutionY;
-    
-    int numVertices = (resolutionX * resolutionY);
-    int numTriangles = 2 * (resolutionX - 1) * (resolutionY - 1);
-    int numIndices = numTriangles * 3;
-    
-    // Build the static data.
-    int i = 0;
-    int j = 0;
-    
-    auto indices = std::vector<ofIndexType>(numIndices);
-    auto texCoords = std::vector<glm::vec2>(numVertices);
-    
-    for (int x = 0; x < resolutionX; ++x)
-    {
-        for (int y = 0; y < resolutionY; ++y)
-        {
-            // Index.
-            if (((x + 1) < resolutionX) && ((y + 1) < resolutionY))
-            {
-                indices[i++] = (x + 0) * resolutionY + (y + 0);
-                indices[i++] = (x + 1) * resolutionY + (y + 0);
-                indices[i++] = (x + 1) * resolutionY + (y + 1);
-                
-                indices[i++] = (x + 0) * resolutionY + (y + 0);
-                indices[i++] = (x + 1) * resolutionY + (y + 1);
-                indices[i++] = (x + 0) * resolutionY + (y + 1);
-            }
-            
-            // Tex Coord.
-            float tx = ofLerp(this->corners.x, this->corners.z, x / (float)(this->resolutionX - 1));
-            float ty = ofLerp(this->corners.y, this->corners.w, y / (float)(this->resolutionY - 1));
-            
-            texCoords[j++] = glm::vec2(tx, ty);
-        }
-    }
-    
-    // Build placeholder data.
-    std::vector<glm::vec3> positions(this->resolutionX * this->resolutionY);
-    
-    // Build mesh.
-    this->vbo.clear();
-    this->vbo.setVertexData(positions.data(), positions.size(), GL_STATIC_DRAW);
-    this->vbo.setTexCoordData(texCoords.data(), texCoords.size(), GL_STATIC_DRAW);
-    this->vbo.setIndexData(indices.data(), indices.size(), GL_STATIC_DRAW);
-    
-    this->dirty = true;
 }
 
-// Mapped buffer seems to be a *tiny* bit faster.
-#define USE_MAPPED_BUFFER 1
-
 //--------------------------------------------------------------
-void RemoteWarpBilinear::updateMesh()
+void RemoteWarpBilinear::update()
 {
-    if (!this->vbo.getIsAllocated() || !this->dirty) return;
-    
-    glm::vec2 pt;
-    float u, v;
-    int col, row;
-    
-    std::vector<glm::vec2> cols, rows;
-    
-#if USE_MAPPED_BUFFER
-    auto vertexBuffer = this->vbo.getVertexBuffer();
-    auto mappedMesh = (glm::vec3 *)vertexBuffer.map(GL_WRITE_ONLY);
-#else
-    std::vector<glm::vec3> positions(this->resolutionX * this->resolutionY);
-    auto index = 0;
-#endif
-    
-    for (auto x = 0; x < this->resolutionX; ++x)
+    if (!this->asyncMesh)
     {
-        for (auto y = 0; y < this->resolutionY; ++y)
-        {
-            // Transform coordinates to [0..numControls]
-            u = x * (this->numControlsX - 1) / (float)(this->resolutionX - 1);
-            v = y * (this->numControlsY - 1) / (float)(this->resolutionY - 1);
-            
-            // Determine col and row.
-            col = (int)u;
-            row = (int)v;
-            
-            // Normalize coordinates to [0..1]
-            u -= col;
-            v -= row;
-            
-            if (this->linear)
-            {
-                // Perform linear interpolation.
-                auto p1 = (1.0f - u) * this->getPoint(col, row) + u * this->getPoint(col + 1, row);
-                auto p2 = (1.0f - u) * this->getPoint(col, row + 1) + u * this->getPoint(col + 1, row + 1);
-                pt = ((1.0f - v) * p1 + v * p2) * this->windowSize;
-            }
-            else {
-                // Perform bicubic interpolation.
-                rows.clear();
-                for (int i = -1; i < 3; ++i)
-                {
-                    cols.clear();
-                    for (int j = -1; j < 3; ++j)
-                    {
-                        cols.push_back(this->getPoint(col + i, row + j));
-                    }
-                    rows.push_back(this->cubicInterpolate(cols, v));
-                }
-                pt = this->cubicInterpolate(rows, u) * this->windowSize;
-            }
-            
-#if USE_MAPPED_BUFFER
-            *mappedMesh++ = glm::vec3(pt.x, pt.y, 0.0f);
-#else
-            positions[index++] = glm::vec3(pt.x, pt.y, 0.0f);
-#endif
-        }
+        this->asyncMesh = std::make_shared<RemoteAsyncMesh>(this->stats);
     }
-    
-#if USE_MAPPED_BUFFER
-    vertexBuffer.unmap();
-#else
-    this->vbo.updateVertexData(positions.data(), positions.size());
-#endif
-    
-    this->dirty = false;
+    if (this->compactVertices != sCompactVertices)
+    {
+        this->compactVertices = sCompactVertices;
+        this->dirty = true;
+    }
+    // Without a mesh there is nothing to keep drawing, build the first one right away.
+    this->requestMesh(this->numIndices == 0);
 }
 
 //--------------------------------------------------------------
-glm::vec2 RemoteWarpBilinear::getPoint(int col, int row) const
+RemoteWarpMemory RemoteWarpBilinear::getMemory() const
 {
-    auto maxCol = this->numControlsX - 1;
-    auto maxRow = this->numControlsY - 1;
-    
-    // Here's the magic: extrapolate points beyond the edges.
-    if (col < 0)
+    auto memory = RemoteWarpBase::getMemory();
+    memory.staging = this->mesh.getCapacityBytes() + this->shortIndices.capacity() * sizeof(uint16_t);
+    if (this->asyncMesh)
     {
-        return (2.0f * getPoint(0, row) - getPoint(0 - col, row));
+        memory.staging += this->asyncMesh->getCapacityBytes();
     }
-    if (row < 0)
+    if (this->drawCompact)
     {
-        return (2.0f * getPoint(col, 0) - getPoint(col, 0 - row));
+        memory.vertices = this->compactBuffer.size();
     }
-    if (col > maxCol)
+    else if (this->vbo.getIsAllocated())
     {
-        return (2.0f * getPoint(maxCol, row) - getPoint(2 * maxCol - col, row));
+        memory.vertices = this->vbo.getVertexBuffer().size();
     }
-    if (row > maxRow)
+    if (this->topology)
     {
-        return (2.0f * getPoint(col, maxRow) - getPoint(col, 2 * maxRow - row));
+        memory.texCoords = this->topology->getTexCoordBytes();
+        memory.indices = this->topology->getIndexBytes();
+        memory.sharedTopology = true;
     }
-    
-    // Points on the edges or within the mesh can simply be looked up.
-    auto idx = (col * this->numControlsY) + row;
-    return this->controlPoints[idx];
+    else if (this->numIndices > 0)
+    {
+        // Packed texture coordinates are part of the vertices.
+        memory.texCoords = this->drawCompact ? 0 : this->vbo.getNumVertices() * sizeof(glm::vec2);
+        memory.indices = this->numIndices * RemoteMeshTopology::getIndexSize(this->indexType);
+    }
+    return memory;
 }
 
 //--------------------------------------------------------------
-// From http://www.paulinternet.nl/?page=bicubic : fast catmull-rom calculation
-glm::vec2 RemoteWarpBilinear::cubicInterpolate(const std::vector<glm::vec2> & knots, float t) const
+RemoteMeshBuilder::Settings RemoteWarpBilinear::getMeshSettings() const
 {
-    assert(knots.size() >= 4);
+    RemoteMeshBuilder::Settings settings;
+    settings.numControlsX = this->numControlsX;
+    settings.numControlsY = this->numControlsY;
+    settings.linear = this->linear;
+    settings.adaptive = this->adaptive;
+    settings.resolution = this->resolution;
+    settings.tolerance = this->tolerance;
+    settings.compact = this->compactVertices;
+    settings.size = glm::vec2(this->width, this->height);
+    settings.windowSize = this->windowSize;
+    return settings;
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::prepareMesh()
+{
+    if (!this->dirty && !this->controlsMoved) return;
     
-    return (knots[1] + 0.5f * t * (knots[2] - knots[0] + t * (2.0f * knots[0] - 5.0f * knots[1] + 4.0f * knots[2] - knots[3] + t * (3.0f * (knots[1] - knots[2]) + knots[3] - knots[0]))));
+    this->mesh.settings = this->getMeshSettings();
+    this->updateMeshQuads(this->mesh.settings);
+    this->mesh.controlPoints = this->controlPoints;
+    if (this->dirty)
+    {
+        RemoteWarpStats::Timer timer(*this->stats, RemoteWarpStats::STAGE_BUILD_MESH);
+        this->mesh.build();
+        ++this->meshRebuilds;
+        this->stats->countRebuild();
+    }
+    else
+    {
+        RemoteWarpStats::Timer timer(*this->stats, RemoteWarpStats::STAGE_UPDATE_MESH);
+        this->mesh.update(this->firstMovedControl, this->lastMovedControl);
+        ++this->meshUpdates;
+        this->stats->countUpdate();
+    }
+    this->dirty = false;
+    this->controlsMoved = false;
 }
 
 //--------------------------------------------------------------
-void RemoteWarpBilinear::setNumControlsX(int n)
+void RemoteWarpBilinear::updateMeshQuads(const RemoteMeshBuilder::Settings & settings)
 {
-    if(remoteEditMode){
-        removeControlPoints();
+    // Moved control points resize an adaptive mesh on screen, once that changes its resolution the mesh is rebuilt.
+    auto quads = RemoteMeshBuilder::getQuads(settings, this->controlPoints);
+    if (quads != this->meshQuads)
+    {
+        this->meshQuads = quads;
+        this->dirty = true;
     }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::requestMesh(bool wait)
+{
+    if (!this->dirty && !this->controlsMoved) return;
     
-    // There should be a minimum of 2 control points.
-    n = MAX(2, n);
-    
-    // Prevent overflow.
-    if ((n * this->numControlsY) > MAX_NUM_CONTROL_POINTS) return;
-    
-    // Create a list of new points.
-    std::vector<glm::vec2> tempPoints(n * this->numControlsY);
+    auto settings = this->getMeshSettings();
+    this->updateMeshQuads(settings);
+    if (this->dirty)
+    {
+        ++this->meshRebuilds;
+        this->stats->countRebuild();
+    }
+    else
+    {
+        ++this->meshUpdates;
+        this->stats->countUpdate();
+    }
+    this->asyncMesh->request(settings, this->controlPoints, this->dirty, this->firstMovedControl, this->lastMovedControl, wait);
+    this->dirty = false;
+    this->controlsMoved = false;
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::uploadMesh(const RemoteMeshBuilder::Mesh & mesh)
+{
+    if (!mesh.rebuilt && mesh.firstColumn > mesh.lastColumn) return;
     
-    // Perform spline fitting.
-    for (auto row = 0; row < this->numControlsY; ++row) {
-        if (this->linear)
+    RemoteWarpStats::Timer timer(*this->stats, RemoteWarpStats::STAGE_UPLOAD);
+    if (mesh.rebuilt)
+    {
+        size_t bytes;
+        this->drawCompact = !mesh.compact.empty();
+        this->compactBounds = mesh.compactBounds;
+        this->vbo.clear();
+        if (this->drawCompact)
         {
-            // Construct piece-wise linear spline.
-            ofPolyline polyline;
-            for (auto col = 0; col < this->numControlsX; ++col)
+            bytes = mesh.compact.size() * sizeof(RemoteCompactVertex);
+            if (!this->compactVertexArray)
             {
-                polyline.lineTo(glm::vec3(this->getPoint(col, row), 0.0f));
+                glGenVertexArrays(1, &this->compactVertexArray);
             }
+            if (!this->compactBuffer.isAllocated())
+            {
+                this->compactBuffer.allocate();
+            }
+            this->compactBuffer.setData(mesh.compact, GL_DYNAMIC_DRAW);
             
-            // Calculate position of new control points.
-            auto step = 1.0f / (n - 1);
-            for (auto col = 0; col < n; ++col)
+            // Positions and texture coordinates interleaved, both read as normalized unsigned shorts.
+            glBindVertexArray(this->compactVertexArray);
+            this->compactBuffer.bind(GL_ARRAY_BUFFER);
+            glEnableVertexAttribArray(ofShader::POSITION_ATTRIBUTE);
+            glVertexAttribPointer(ofShader::POSITION_ATTRIBUTE, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(RemoteCompactVertex), (const void *)offsetof(RemoteCompactVertex, x));
+            glEnableVertexAttribArray(ofShader::TEXCOORD_ATTRIBUTE);
+            glVertexAttribPointer(ofShader::TEXCOORD_ATTRIBUTE, 2, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(RemoteCompactVertex), (const void *)offsetof(RemoteCompactVertex, u));
+            glBindVertexArray(0);
+            this->compactBuffer.unbind(GL_ARRAY_BUFFER);
+        }
+        else
+        {
+            bytes = mesh.positions.size() * sizeof(glm::vec2);
+            this->compactBuffer = ofBufferObject();
+            this->vbo.setVertexData(mesh.positions.data(), mesh.positions.size(), GL_DYNAMIC_DRAW);
+        }
+        
+        if (mesh.tessellated)
+        {
+            // Tessellated meshes don't share their topology.
+            this->topology.reset();
+            this->indexType = RemoteMeshTopology::getIndexType(mesh.positions.size());
+            bytes += mesh.indices.size() * RemoteMeshTopology::getIndexSize(this->indexType);
+            if (!this->drawCompact)
+            {
+                bytes += mesh.texCoords.size() * sizeof(glm::vec2);
+                this->vbo.setTexCoordData(mesh.texCoords.data(), mesh.texCoords.size(), GL_DYNAMIC_DRAW);
+            }
+            if (!this->indexBuffer.isAllocated())
+            {
+                this->indexBuffer.allocate();
+            }
+            if (this->indexType == GL_UNSIGNED_SHORT)
             {
-                auto idx = (col * this->numControlsY) + row;
-                tempPoints[idx] = glm::vec2(polyline.getPointAtPercent(col * step));
+                this->shortIndices.assign(mesh.indices.begin(), mesh.indices.end());
+                this->indexBuffer.setData(this->shortIndices, GL_DYNAMIC_DRAW);
             }
+            else
+            {
+                this->indexBuffer.setData(mesh.indices, GL_DYNAMIC_DRAW);
+            }
+            this->numIndices = mesh.indices.size();
         }
         else
         {
-            // Construct piece-wise catmull-rom spline.
-            ofPolyline polyline;
-            for (auto col = 0; col < this->numControlsX; ++col)
+            if (!this->topology || this->topology->getResolutionX() != mesh.resolutionX || this->topology->getResolutionY() != mesh.resolutionY)
             {
-                auto p0 = this->getPoint(col - 1, row);
-                auto p1 = this->getPoint(col, row);
-                auto p2 = this->getPoint(col + 1, row);
-                auto p3 = this->getPoint(col + 2, row);
-                
-                // Control points according to an optimized Catmull-Rom implementation
-                auto b1 = p1 + (p2 - p0) / 6.0f;
-                auto b2 = p2 - (p3 - p1) / 6.0f;
-                
-                if (col == 0)
-                {
-                    polyline.lineTo(glm::vec3(p1, 0.0f));
-                }
-                
-                polyline.curveTo(glm::vec3(p1, 0.0f));
-                
-                if (col < (this->numControlsX - 1))
-                {
-                    polyline.curveTo(glm::vec3(b1, 0.0f));
-                    polyline.curveTo(glm::vec3(b2, 0.0f));
-                }
-                else
-                {
-                    polyline.lineTo(glm::vec3(p1, 0.0f));
-                }
+                this->topology = RemoteMeshTopology::get(mesh.resolutionX, mesh.resolutionY);
             }
-            
-            // Calculate position of new control points.
-            auto step = 1.0f / (n - 1);
-            for (auto col = 0; col < n; ++col)
+            if (!this->drawCompact)
             {
-                auto idx = (col * this->numControlsY) + row;
-                tempPoints[idx] = glm::vec2(polyline.getPointAtPercent(col * step));
+                this->vbo.setTexCoordBuffer(this->topology->getTexCoordBuffer(), sizeof(glm::vec2));
             }
+            this->numIndices = this->topology->getNumIndices();
+            this->indexBuffer = ofBufferObject();
         }
+        this->stats->countUpload(mesh.positions.size(), bytes);
+    }
+    else if (this->drawCompact)
+    {
+        // Packed vertices are stored column by column as well, positions that left the bounds repacked all of them.
+        this->compactBounds = mesh.compactBounds;
+        auto first = mesh.firstColumn * mesh.resolutionY;
+        auto count = (mesh.lastColumn - mesh.firstColumn + 1) * mesh.resolutionY;
+        this->stats->countUpload(count, count * sizeof(RemoteCompactVertex));
+        this->compactBuffer.updateData(first * sizeof(RemoteCompactVertex), count * sizeof(RemoteCompactVertex), mesh.compact.data() + first);
+    }
+    else if (this->vbo.getIsAllocated())
+    {
+        // Vertices are stored column by column, so the columns that changed are one contiguous range.
+        auto first = mesh.firstColumn * mesh.resolutionY;
+        auto count = (mesh.lastColumn - mesh.firstColumn + 1) * mesh.resolutionY;
+        this->stats->countUpload(count, count * sizeof(glm::vec2));
+        this->vbo.getVertexBuffer().updateData(first * sizeof(glm::vec2), count * sizeof(glm::vec2), mesh.positions.data() + first);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::controlPointMoved(size_t index)
+{
+    auto control = glm::ivec2(index / this->numControlsY, index % this->numControlsY);
+    if (this->controlsMoved)
+    {
+        this->firstMovedControl = glm::min(this->firstMovedControl, control);
+        this->lastMovedControl = glm::max(this->lastMovedControl, control);
+    }
+    else
+    {
+        this->firstMovedControl = control;
+        this->lastMovedControl = control;
+        this->controlsMoved = true;
+    }
+}
+
+//--------------------------------------------------------------
+glm::vec2 RemoteWarpBilinear::getPoint(int col, int row) const
+{
+    return RemoteControlGrid::getPoint(this->controlPoints, this->numControlsX, this->numControlsY, col, row);
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::setNumControlsX(int n)
+{
+    // There should be a minimum of 2 control points.
+    n = MAX(2, n);
+    
+    // Prevent overflow.
+    if (n > MAX_NUM_CONTROLS || (n * this->numControlsY) > MAX_NUM_CONTROL_POINTS) return;
+    
+    if(remoteEditMode){
+        removeControlPoints();
     }
     
-    // Save new control points.
-    this->controlPoints = tempPoints;
+    // Fit the new columns along the rows.
+    RemoteControlGrid::resampleColumns(this->controlPoints, this->numControlsX, this->numControlsY, n, this->linear);
     this->numControlsX = n;
     
-    // Find new closest control point.
-    float distance;
-    //this->selectedIndex = this->findClosestControlPoint(glm::vec2(ofGetMouseX(), ofGetMouseY()), &distance);
-    
     this->dirty = true;
+    this->journalControlGrid();
     
     if(remoteEditMode){
         addControlPoints();
@@ -660,91 +795,68 @@ void RemoteWarpBilinear::setNumControlsX(int n)
 //--------------------------------------------------------------
 void RemoteWarpBilinear::setNumControlsY(int n)
 {
+    // There should be a minimum of 2 control points.
+    n = MAX(2, n);
+    
+    // Prevent overflow.
+    if (n > MAX_NUM_CONTROLS || (this->numControlsX * n) > MAX_NUM_CONTROL_POINTS) return;
+    
     if(remoteEditMode){
         removeControlPoints();
     }
     
-    // There should be a minimum of 2 control points.
-    n = MAX(2, n);
+    // Fit the new rows along the columns.
+    RemoteControlGrid::resampleRows(this->controlPoints, this->numControlsX, this->numControlsY, n, this->linear);
+    this->numControlsY = n;
     
-    // Prevent overflow.
-    if ((this->numControlsX * n) > MAX_NUM_CONTROL_POINTS) return;
+    this->dirty = true;
+    this->journalControlGrid();
     
-    // Create a list of new points.
-    std::vector<glm::vec2> tempPoints(this->numControlsX * n);
+    if(remoteEditMode){
+        addControlPoints();
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::subdivideX(float percent)
+{
+    if (this->numControlsX >= MAX_NUM_CONTROLS || ((this->numControlsX + 1) * this->numControlsY) > MAX_NUM_CONTROL_POINTS) return;
+    
+    if(remoteEditMode){
+        removeControlPoints();
+    }
     
-    // Perform spline fitting
-    for (auto col = 0; col < this->numControlsX; ++col)
+    if (RemoteControlGrid::insertColumn(this->controlPoints, this->numControlsX, this->numControlsY, percent, this->linear))
     {
-        if (this->linear)
-        {
-            // Construct piece-wise linear spline.
-            ofPolyline polyline;
-            for (auto row = 0; row < this->numControlsY; ++row)
-            {
-                polyline.lineTo(glm::vec3(this->getPoint(col, row), 0.0f));
-            }
-            
-            // Calculate position of new control points.
-            float step = 1.0f / (n - 1);
-            for (auto row = 0; row < n; ++row)
-            {
-                auto idx = (col * n) + row;
-                tempPoints[idx] = glm::vec2(polyline.getPointAtPercent(row * step));
-            }
-        }
-        else
-        {
-            // Construct piece-wise catmull-rom spline.
-            ofPolyline polyline;
-            for (auto row = 0; row < this->numControlsY; ++row)
-            {
-                auto p0 = this->getPoint(col, row - 1);
-                auto p1 = this->getPoint(col, row);
-                auto p2 = this->getPoint(col, row + 1);
-                auto p3 = this->getPoint(col, row + 2);
-                
-                // Control points according to an optimized Catmull-Rom implementation
-                auto b1 = p1 + (p2 - p0) / 6.0f;
-                auto b2 = p2 - (p3 - p1) / 6.0f;
-                
-                if (row == 0)
-                {
-                    polyline.lineTo(glm::vec3(p1, 0.0f));
-                }
-                
-                polyline.curveTo(glm::vec3(p1, 0.0f));
-                
-                if (row < (this->numControlsY - 1))
-                {
-                    polyline.curveTo(glm::vec3(b1, 0.0f));
-                    polyline.curveTo(glm::vec3(b2, 0.0f));
-                }
-                else
-                {
-                    polyline.lineTo(glm::vec3(p1, 0.0f));
-                }
-            }
-            
-            // Calculate position of new control points.
-            auto step = 1.0f / (n - 1);
-            for (auto row = 0; row < n; ++row)
-            {
-                auto idx = (col * n) + row;
-                tempPoints[idx] = glm::vec2(polyline.getPointAtPercent(row * step));
-            }
-        }
+        ++this->numControlsX;
+        this->selectedIndices.clear();
+        this->dirty = true;
+        this->remoteStale = true;
+        this->journalControlGrid();
     }
     
-    // Save new control points.
-    this->controlPoints = tempPoints;
-    this->numControlsY = n;
+    if(remoteEditMode){
+        addControlPoints();
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpBilinear::subdivideY(float percent)
+{
+    if (this->numControlsY >= MAX_NUM_CONTROLS || (this->numControlsX * (this->numControlsY + 1)) > MAX_NUM_CONTROL_POINTS) return;
     
-    // Find new closest control point.
-    float distance;
-    //this->selectedIndex = this->findClosestControlPoint(glm::vec2(ofGetMouseX(), ofGetMouseY()), &distance);
+    if(remoteEditMode){
+        removeControlPoints();
+    }
     
-    this->dirty = true;
+    if (RemoteControlGrid::insertRow(this->controlPoints, this->numControlsX, this->numControlsY, percent, this->linear))
+    {
+        ++this->numControlsY;
+        this->selectedIndices.clear();
+        this->dirty = true;
+        this->remoteStale = true;
+        this->journalControlGrid();
+    }
     
     if(remoteEditMode){
         addControlPoints();
@@ -752,80 +864,92 @@ void RemoteWarpBilinear::setNumControlsY(int n)
 }
 
 //--------------------------------------------------------------
-ofRectangle RemoteWarpBilinear::getMeshBounds() const
+bool RemoteWarpBilinear::setControlGrid(int columns, int rows, const std::vector<glm::vec2>& points)
 {
-    auto min = glm::vec2(1.0f);
-    auto max = glm::vec2(0.0f);
-    
-    for (auto & pt : this->controlPoints)
+    if (columns == this->numControlsX && rows == this->numControlsY)
+    {
+        return RemoteWarpBase::setControlGrid(columns, rows, points);
+    }
+    if (columns < 2 || rows < 2 || columns > MAX_NUM_CONTROLS || rows > MAX_NUM_CONTROLS || columns * rows > MAX_NUM_CONTROL_POINTS || points.size() != size_t(columns * rows))
     {
-        min.x = MIN(pt.x, min.x);
-        min.y = MIN(pt.y, min.y);
-        max.x = MAX(pt.x, max.x);
-        max.y = MAX(pt.y, min.y);
+        ofLogWarning("RemoteWarpBilinear::setControlGrid") << this->warpName << " can't take a " << columns << "x" << rows << " grid of " << points.size() << " points";
+        return false;
     }
     
-    return ofRectangle(min * this->windowSize, max * this->windowSize);
+    if(remoteEditMode){
+        removeControlPoints();
+    }
+    
+    this->controlPoints.assign(points.begin(), points.end());
+    this->numControlsX = columns;
+    this->numControlsY = rows;
+    this->selectedIndices.clear();
+    this->dirty = true;
+    this->journalControlGrid();
+    
+    if(remoteEditMode){
+        addControlPoints();
+    }
+    return true;
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBilinear::setCorners(float left, float top, float right, float bottom)
 {
-    this->dirty |= (left != this->corners.x || top != this->corners.y || right != this->corners.z || bottom != this->corners.w);
-    if (!this->dirty) return;
-    
+    // Only the shader uses the corners, the mesh stays as it is.
     this->corners = glm::vec4(left, top, right, bottom);
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBilinear::rotateClockwise()
 {
-    ofLogWarning("WarpBilinear::rotateClockwise") << "Not implemented!";
+    if(remoteEditMode){
+        removeControlPoints();
+    }
+    
+    RemoteControlGrid::rotateClockwise(this->controlPoints, this->numControlsX, this->numControlsY);
+    std::swap(this->numControlsX, this->numControlsY);
+    this->selectedIndices.clear();
+    this->dirty = true;
+    this->remoteStale = true;
+    this->journalControlGrid();
+    
+    if(remoteEditMode){
+        addControlPoints();
+    }
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBilinear::rotateCounterclockwise()
 {
-    ofLogWarning("WarpBilinear::rotateCounterclockwise") << "Not implemented!";
+    if(remoteEditMode){
+        removeControlPoints();
+    }
+    
+    RemoteControlGrid::rotateCounterclockwise(this->controlPoints, this->numControlsX, this->numControlsY);
+    std::swap(this->numControlsX, this->numControlsY);
+    this->selectedIndices.clear();
+    this->dirty = true;
+    this->remoteStale = true;
+    this->journalControlGrid();
+    
+    if(remoteEditMode){
+        addControlPoints();
+    }
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBilinear::flipHorizontal()
 {
-    std::vector<glm::vec2> flippedPoints;
-    for (int x = this->numControlsX - 1; x >= 0; --x)
-    {
-        for (int y = 0; y < this->numControlsY; ++y)
-        {
-            auto i = (x * this->numControlsY + y);
-            flippedPoints.push_back(this->controlPoints[i]);
-        }
-    }
-    this->controlPoints = flippedPoints;
+    RemoteControlGrid::flipHorizontal(this->controlPoints, this->numControlsX, this->numControlsY);
     this->dirty = true;
-    
-    // Find new closest control point.
-    float distance;
-    //this->selectedIndex = this->findClosestControlPoint(glm::vec2(ofGetMouseX(), ofGetMouseY()), &distance);
+    this->journalControlGrid();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpBilinear::flipVertical()
 {
-    std::vector<glm::vec2> flippedPoints;
-    for (int x = 0; x < this->numControlsX; ++x)
-    {
-        for (int y = this->numControlsY - 1; y >= 0; --y)
-        {
-            auto i = (x * this->numControlsY + y);
-            flippedPoints.push_back(this->controlPoints[i]);
-        }
-    }
-    this->controlPoints = flippedPoints;
+    RemoteControlGrid::flipVertical(this->controlPoints, this->numControlsX, this->numControlsY);
     this->dirty = true;
-    
-    // Find new closest control point.
-    float distance;
-    //this->selectedIndex = this->findClosestControlPoint(glm::vec2(ofGetMouseX(), ofGetMouseY()), &distance);
+    this->journalControlGrid();
 }
-
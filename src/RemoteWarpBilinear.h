@@ -8,14 +8,17 @@
 #pragma once
 
 #include "RemoteWarpBase.h"
+#include "RemoteMeshBuilder.h"
+#include "RemoteAsyncMesh.h"
+#include "RemoteMeshTopology.h"
 
 class RemoteWarpBilinear : public RemoteWarpBase {
 public:
     RemoteWarpBilinear(const std::string& name, const WarpSettings& settings);
     virtual ~RemoteWarpBilinear();
     
-    virtual void serialize(nlohmann::json & json) override;
-    virtual void deserialize(const nlohmann::json & json) override;
+    virtual void serialize(WarpRecord & record) const override;
+    virtual void deserialize(const WarpRecord & record) override;
         
     //! set whether the mesh is linear (or curved)
     void setLinear(bool linear);
@@ -34,6 +37,23 @@ public:
     //! return the mesh resolution
     int getResolution() const;
     
+    //! set how many pixels the mesh may deviate from the curved surface. above 0 the mesh is tessellated adaptively, so flat
+    //! areas take few triangles and curved ones as many as the resolution allows. 0 draws a regular grid
+    void setTolerance(float pixels);
+    //! return the tessellation tolerance in pixels
+    float getTolerance() const;
+    
+    //! draw every bilinear warp from 8 byte vertices, positions and texture coordinates as 16 bit fractions in one buffer,
+    //! instead of float positions and texture coordinates. meshes too large to pack within a quarter pixel stay float.
+    //! warps rebuild their meshes on their next draw
+    static void setCompactVertices(bool compact);
+    static bool getCompactVertices();
+    
+    //! number of times the whole mesh was rebuilt
+    inline size_t getNumMeshRebuilds() const { return meshRebuilds; }
+    //! number of partial mesh updates after control points moved
+    inline size_t getNumMeshUpdates() const { return meshUpdates; }
+    
     //! reset control points to undistorted image
     virtual void reset(const glm::vec2 & scale = glm::vec2(1.0f), const glm::vec2 & offset = glm::vec2(0.0f)) override;
     
@@ -45,6 +65,9 @@ public:
     void subdivideX( float percent );
     void subdivideY( float percent );
     
+    //! replace the control grid with one of any size up to MAX_NUM_CONTROLS per side and MAX_NUM_CONTROL_POINTS in total
+    virtual bool setControlGrid(int columns, int rows, const std::vector<glm::vec2>& points) override;
+    
     void setCorners(float left, float top, float right, float bottom);
     
     virtual void rotateClockwise() override;
@@ -53,6 +76,13 @@ public:
     virtual void flipHorizontal() override;
     virtual void flipVertical() override;
     
+    //! start building the mesh on the shared thread pool, draws pick it up once it's finished and keep the previous mesh until then.
+    //! warps that were updated once keep building their meshes that way
+    virtual void update() override;
+    
+    //! adds the mesh builders, the vertex buffer and the topology the warp draws with
+    virtual RemoteWarpMemory getMemory() const override;
+    
 
 protected:
     //! draw a specific area of a warped texture to a specific region
@@ -64,16 +94,18 @@ protected:
     void setupFbo();
     //! set up the shader and vertex buffer
     void setupVbo();
-    //! set up the vbo mesh
-    void setupMesh(int resolutionX = 36, int resolutionY = 36);
-    //! update the vbo mesh based on the control points
-    void updateMesh();
+    //! settings of the mesh for the current state of the warp
+    RemoteMeshBuilder::Settings getMeshSettings() const;
+    //! compute the vertices of whatever changed since the last call on the calling thread
+    void prepareMesh();
+    //! hand whatever changed since the last call to the async mesh, with wait set the mesh is built right away if no job is running
+    void requestMesh(bool wait);
+    //! mark the mesh dirty if the quads it is set up for changed, moving control points changes them for adaptive meshes
+    void updateMeshQuads(const RemoteMeshBuilder::Settings & settings);
+    //! upload the parts of a mesh that changed
+    void uploadMesh(const RemoteMeshBuilder::Mesh & mesh);
     //!    return the specified control point, values for col and row are clamped to prevent errors.
     glm::vec2 getPoint(int col, int row) const;
-    //! perform fast Catmull-Rom interpolation, and return the interpolated value at t
-    glm::vec2 cubicInterpolate(const std::vector<glm::vec2> & knots, float t) const;
-    //!
-    ofRectangle getMeshBounds() const;
     
 protected:
 
@@ -91,25 +123,67 @@ protected:
     //! detail of the generated mesh (multiples of 5 seem to work best)
     int resolution;
     
-    //! number of horizontal quads
-    int resolutionX;
-    //! number of vertical quads
-    int resolutionY;
+    //! pixels a tessellated mesh may deviate from the surface, 0 for a regular grid
+    float tolerance{0.0f};
+    //! quads along each axis of the mesh last built, see RemoteMeshBuilder::getQuads
+    glm::ivec2 meshQuads{-1};
+    //! indices drawn, from the shared topology or the tessellated mesh
+    int numIndices{0};
+    //! indices of a tessellated mesh, 16 bit when its vertices fit
+    ofBufferObject indexBuffer;
+    GLenum indexType{GL_UNSIGNED_INT};
+    //! reused by uploadMesh to narrow the indices of a tessellated mesh to 16 bit without allocating
+    std::vector<uint16_t> shortIndices;
+    //! packed vertices of the mesh, drawn through their own vertex array instead of the vbo while drawCompact is set, and
+    //! the bounds their positions were packed in
+    ofBufferObject compactBuffer;
+    GLuint compactVertexArray{0};
+    glm::vec4 compactBounds;
+    bool drawCompact{false};
+    //! vertex layout the current mesh was requested with
+    bool compactVertices{false};
+    static bool sCompactVertices;
+    
+    //! builds the mesh on the render thread until the warp is updated the first time
+    RemoteMeshBuilder mesh;
+    //! builds the mesh on the shared thread pool once the warp was updated
+    std::shared_ptr<RemoteAsyncMesh> asyncMesh;
+    //! indices and texture coordinates the vbo draws with, shared with every warp of the same resolution
+    std::shared_ptr<RemoteMeshTopology> topology;
+    //! set when control points moved without changing the topology of the mesh
+    bool controlsMoved{false};
+    //! first and last column and row of the control points that moved
+    glm::ivec2 firstMovedControl;
+    glm::ivec2 lastMovedControl;
+    
+    size_t meshRebuilds{0};
+    size_t meshUpdates{0};
 
     
     //remoteUI
-    int remoteNumControlsX{2};
-    int remoteNumControlsY{2};
+    RemoteShadow<int> remoteNumControlsX{2};
+    RemoteShadow<int> remoteNumControlsY{2};
     
-    bool remoteIncRes{false};
-    bool remoteDecRes{false};
+    RemoteShadow<bool> remoteIncRes{false};
+    RemoteShadow<bool> remoteDecRes{false};
     
-    bool remoteFlipH{false};
-    bool remoteFlipV{false};
+    RemoteShadow<bool> remoteFlipH{false};
+    RemoteShadow<bool> remoteFlipV{false};
+    
+    RemoteShadow<bool> remoteLinear{false};
+    RemoteShadow<bool> remoteAdaptive{true};
+    RemoteShadow<int> remoteResolution{16};
 
 protected:
         
     virtual void handleRemoteUpdate(RemoteUIServerCallBackArg & arg)override;
+    virtual void applyCommand(const RemoteWarpCommand & command)override;
+    virtual void shareRemoteParams()override;
+    virtual void pushRemoteState()override;
+    virtual void pullRemoteParams()override;
+    virtual void syncRemoteParams()override;
+    
+    virtual void controlPointMoved(size_t index)override;
 
     //! greatest common divisor using Euclidian algorithm (from: http://en.wikipedia.org/wiki/Greatest_common_divisor)
     inline int gcd(int a, int b) const
@@ -0,0 +1,273 @@
+//
+//  RemoteWarpJournal.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteWarpJournal.h"
+
+const uint32_t RemoteWarpJournal::sMagic = 0x4a4d5052; // "RPMJ"
+const uint32_t RemoteWarpJournal::sVersion = 1;
+
+namespace {
+
+    struct RecordHeader {
+        uint8_t type;
+        uint8_t reserved[3];
+        uint32_t index;
+        uint32_t count;
+    };
+
+    // FNV-1a, only used to detect records torn by a crash mid write.
+    uint32_t checksum(const char* data, size_t size, uint32_t hash = 2166136261u)
+    {
+        for (size_t i = 0; i < size; ++i)
+        {
+            hash ^= (uint8_t)data[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+}
+
+RemoteWarpJournal::~RemoteWarpJournal()
+{
+    close();
+}
+
+bool RemoteWarpJournal::open(const std::filesystem::path& file, bool truncate)
+{
+    close();
+
+    path = file;
+    numRecords = 0;
+    size = 0;
+
+    if(!truncate && std::filesystem::exists(file)){
+        size_t intactSize = 0;
+        bool intact = replay(file, [this](const Record&){ ++numRecords; }, &intactSize);
+        if(!intact){
+            ofLogWarning("RemoteWarpJournal::open") << "dropping unreadable journal at " << file;
+            truncate = true;
+            numRecords = 0;
+        }else if(std::filesystem::file_size(file) != intactSize){
+            // Cut off a torn record so new records don't end up behind it.
+            std::filesystem::resize_file(file, intactSize);
+        }
+        size = intactSize;
+    }else{
+        truncate = true;
+    }
+
+    handle = std::fopen(file.string().c_str(), truncate ? "wb" : "ab");
+    if(!handle){
+        ofLogError("RemoteWarpJournal::open") << "couldn't open journal at " << file;
+        return false;
+    }
+
+    if(truncate){
+        std::fwrite(&sMagic, sizeof(sMagic), 1, handle);
+        std::fwrite(&sVersion, sizeof(sVersion), 1, handle);
+        std::fflush(handle);
+        size = sizeof(sMagic) + sizeof(sVersion);
+    }
+    return true;
+}
+
+void RemoteWarpJournal::close()
+{
+    if(handle){
+        flush();
+        std::fclose(handle);
+        handle = nullptr;
+    }
+    pending.clear();
+}
+
+void RemoteWarpJournal::appendControlPoint(size_t index, const glm::vec2& pos)
+{
+    float values[2] = { pos.x, pos.y };
+    append(RECORD_CONTROL_POINT, index, values, 2);
+}
+
+void RemoteWarpJournal::appendCorner(size_t index, const glm::vec2& pos)
+{
+    float values[2] = { pos.x, pos.y };
+    append(RECORD_CORNER, index, values, 2);
+}
+
+void RemoteWarpJournal::appendBlend(float brightness, float exponent, const glm::vec4& edges, const glm::vec3& gamma, const glm::vec3& luminance)
+{
+    float values[12] = {
+        brightness, exponent,
+        edges.x, edges.y, edges.z, edges.w,
+        gamma.r, gamma.g, gamma.b,
+        luminance.r, luminance.g, luminance.b
+    };
+    append(RECORD_BLEND, 0, values, 12);
+}
+
+void RemoteWarpJournal::appendGrid(int columns, int rows, const std::vector<glm::vec2>& points)
+{
+    append(RECORD_GRID, (uint32_t(columns) << 16) | uint32_t(rows & 0xffff), points.empty() ? nullptr : &points[0].x, points.size() * 2);
+}
+
+void RemoteWarpJournal::append(const Record& record)
+{
+    append(record.type, record.index, record.values.data(), record.values.size());
+}
+
+void RemoteWarpJournal::append(RecordType type, uint32_t index, const float* values, uint32_t count)
+{
+    if(!handle) return;
+    encode(pending, type, index, values, count);
+    if(mirroring){
+        encode(mirrored, type, index, values, count);
+    }
+    ++numRecords;
+}
+
+void RemoteWarpJournal::setMirroring(bool mirroring)
+{
+    this->mirroring = mirroring;
+    if(!mirroring){
+        mirrored.clear();
+    }
+}
+
+void RemoteWarpJournal::takeMirrored(std::vector<char>& records)
+{
+    records.insert(records.end(), mirrored.begin(), mirrored.end());
+    mirrored.clear();
+}
+
+void RemoteWarpJournal::encode(std::vector<char>& bytes, RecordType type, uint32_t index, const float* values, uint32_t count)
+{
+    RecordHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.type = type;
+    header.index = index;
+    header.count = count;
+
+    auto start = bytes.size();
+    auto headerBytes = reinterpret_cast<const char*>(&header);
+    auto valueBytes = reinterpret_cast<const char*>(values);
+    bytes.insert(bytes.end(), headerBytes, headerBytes + sizeof(header));
+    bytes.insert(bytes.end(), valueBytes, valueBytes + count * sizeof(float));
+
+    auto sum = checksum(bytes.data() + start, bytes.size() - start);
+    auto sumBytes = reinterpret_cast<const char*>(&sum);
+    bytes.insert(bytes.end(), sumBytes, sumBytes + sizeof(sum));
+}
+
+void RemoteWarpJournal::flush()
+{
+    if(!handle || pending.empty()) return;
+    std::fwrite(pending.data(), 1, pending.size(), handle);
+    std::fflush(handle);
+    size += pending.size();
+    pending.clear();
+}
+
+void RemoteWarpJournal::truncate()
+{
+    if(path.empty()) return;
+    open(path, true);
+}
+
+void RemoteWarpJournal::dropBefore(size_t offset)
+{
+    if(!handle || offset <= sizeof(sMagic) + sizeof(sVersion)) return;
+    if(offset >= size && pending.empty()){
+        truncate();
+        return;
+    }
+    flush();
+
+    std::vector<char> tail;
+    {
+        std::ifstream in(path, std::ios::binary);
+        in.seekg(offset);
+        tail.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    auto temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out.write(reinterpret_cast<const char*>(&sMagic), sizeof(sMagic));
+        out.write(reinterpret_cast<const char*>(&sVersion), sizeof(sVersion));
+        out.write(tail.data(), tail.size());
+        if(!out){
+            ofLogError("RemoteWarpJournal::dropBefore") << "couldn't write " << temporary;
+            return;
+        }
+    }
+
+    auto file = path;
+    close();
+    std::error_code error;
+    std::filesystem::rename(temporary, file, error);
+    if(error){
+        ofLogError("RemoteWarpJournal::dropBefore") << "couldn't replace " << file << ": " << error.message();
+    }
+    open(file);
+}
+
+bool RemoteWarpJournal::replay(const std::filesystem::path& file, const std::function<void(const Record&)>& apply, size_t* intactSize)
+{
+    std::ifstream in(file, std::ios::binary);
+    if(!in) return false;
+
+    uint32_t magic = 0, version = 0;
+    in.read(reinterpret_cast<char*>(&magic), sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(version));
+    if(!in || magic != sMagic || version != sVersion){
+        return false;
+    }
+    size_t intact = sizeof(magic) + sizeof(version);
+
+    std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    intact += decode(bytes.data(), bytes.size(), apply);
+    if(intactSize){
+        *intactSize = intact;
+    }
+    return true;
+}
+
+size_t RemoteWarpJournal::getRecordSize(const char* data, size_t size)
+{
+    RecordHeader header;
+    if(size < sizeof(header)) return 0;
+    std::memcpy(&header, data, sizeof(header));
+
+    // Guard against garbage lengths from a torn header.
+    if(header.count > (1u << 24)) return 0;
+
+    size_t length = sizeof(header) + header.count * sizeof(float);
+    uint32_t sum = 0;
+    if(size < length + sizeof(sum)) return 0;
+    std::memcpy(&sum, data + length, sizeof(sum));
+    if(sum != checksum(data, length)) return 0;
+
+    return length + sizeof(sum);
+}
+
+size_t RemoteWarpJournal::decode(const char* data, size_t size, const std::function<void(const Record&)>& apply)
+{
+    size_t offset = 0;
+    Record record;
+    while(auto recordSize = getRecordSize(data + offset, size - offset)){
+        RecordHeader header;
+        std::memcpy(&header, data + offset, sizeof(header));
+        record.type = (RecordType)header.type;
+        record.index = header.index;
+        record.values.resize(header.count);
+        if(header.count){
+            std::memcpy(record.values.data(), data + offset + sizeof(header), header.count * sizeof(float));
+        }
+        apply(record);
+        offset += recordSize;
+    }
+    return offset;
+}
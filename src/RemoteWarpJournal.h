@@ -0,0 +1,101 @@
+//
+//  RemoteWarpJournal.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+#include <cstdio>
+
+//! append-only binary log of edits made to a warp since its last snapshot (controlpoints.json).
+//! records are buffered in memory and written once per frame, replaying the journal on top of
+//! the snapshot restores any calibration that was in progress when the app went down.
+class RemoteWarpJournal {
+public:
+
+    typedef enum
+    {
+        RECORD_UNKNOWN,
+        //! index: control point index, values: x, y
+        RECORD_CONTROL_POINT,
+        //! index: perspective corner index, values: x, y
+        RECORD_CORNER,
+        //! values: brightness, exponent, edges(4), gamma(3), luminance(3)
+        RECORD_BLEND,
+        //! index: (columns << 16) | rows, values: every control point as x, y
+        RECORD_GRID
+    } RecordType;
+
+    struct Record {
+        RecordType type{RECORD_UNKNOWN};
+        uint32_t index{0};
+        std::vector<float> values;
+    };
+
+    RemoteWarpJournal() = default;
+    ~RemoteWarpJournal();
+
+    RemoteWarpJournal(const RemoteWarpJournal&) = delete;
+    RemoteWarpJournal& operator=(const RemoteWarpJournal&) = delete;
+
+    //! open the journal at file for appending, when truncate is set any existing records are dropped
+    bool open(const std::filesystem::path& file, bool truncate = false);
+    void close();
+    bool isOpen() const { return handle != nullptr; }
+    const std::filesystem::path& getPath() const { return path; }
+
+    void appendControlPoint(size_t index, const glm::vec2& pos);
+    void appendCorner(size_t index, const glm::vec2& pos);
+    void appendBlend(float brightness, float exponent, const glm::vec4& edges, const glm::vec3& gamma, const glm::vec3& luminance);
+    void appendGrid(int columns, int rows, const std::vector<glm::vec2>& points);
+    //! append a record received from elsewhere, like a replicated edit
+    void append(const Record& record);
+
+    //! write buffered records to disk
+    void flush();
+    //! drop every record, called after the snapshot has been rewritten
+    void truncate();
+    //! drop the records written before offset (a getSize() taken earlier), called once a snapshot holding them is in place.
+    //! the remaining records are written to a new file that replaces the journal, so a crash never loses them
+    void dropBefore(size_t offset);
+
+    //! number of records in the journal since the last truncate
+    size_t getNumRecords() const { return numRecords; }
+    //! bytes written to the file so far, pending records aren't included until flushed
+    size_t getSize() const { return size; }
+    //! while mirroring, appended records are also kept until takeMirrored() is called, used to replicate edits to other nodes
+    void setMirroring(bool mirroring);
+    bool isMirroring() const { return mirroring; }
+    //! append the records mirrored since the last call to records, in the on disk format
+    void takeMirrored(std::vector<char>& records);
+    //! bytes allocated for pending and mirrored records
+    size_t getCapacityBytes() const { return pending.capacity() + mirrored.capacity(); }
+
+    //! read every intact record from file, a torn record at the tail ends the replay.
+    //! intactSize receives the length of the file up to the last intact record.
+    static bool replay(const std::filesystem::path& file, const std::function<void(const Record&)>& apply, size_t* intactSize = nullptr);
+    
+    //! encode a record in the on disk format at the end of bytes
+    static void encode(std::vector<char>& bytes, RecordType type, uint32_t index, const float* values, uint32_t count);
+    //! return the size of the intact record at the start of data, 0 if it is torn or corrupt
+    static size_t getRecordSize(const char* data, size_t size);
+    //! decode every intact record in data, returns the number of bytes decoded
+    static size_t decode(const char* data, size_t size, const std::function<void(const Record&)>& apply);
+
+private:
+
+    void append(RecordType type, uint32_t index, const float* values, uint32_t count);
+
+    static const uint32_t sMagic;
+    static const uint32_t sVersion;
+
+    std::filesystem::path path;
+    std::FILE* handle{nullptr};
+    std::vector<char> pending;
+    size_t numRecords{0};
+    size_t size{0};
+    bool mirroring{false};
+    //! survives reopening the journal, so edits made right before a save are still replicated
+    std::vector<char> mirrored;
+};
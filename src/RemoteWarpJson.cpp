@@ -0,0 +1,776 @@
+//
+//  RemoteWarpJson.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteWarpJson.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+
+//--------------------------------------------------------------
+void WarpRecord::clear()
+{
+    name.clear();
+    preset.clear();
+    type = 0;
+    brightness = 1.0f;
+    columns = 2;
+    rows = 2;
+    controlPoints.clear();
+    exponent = 2.0f;
+    edges = glm::vec4(0.0f);
+    gamma = glm::vec3(1.0f);
+    luminance = glm::vec3(0.5f);
+    hasBilinear = false;
+    resolution = 16;
+    linear = false;
+    adaptive = true;
+    tolerance = 0.0f;
+    hasCorners = false;
+    for(auto & corner : corners){
+        corner = glm::vec2(0.0f);
+    }
+}
+
+//--------------------------------------------------------------
+size_t WarpRecord::getCapacityBytes() const
+{
+    return name.capacity() + preset.capacity() + controlPoints.capacity() * sizeof(glm::vec2);
+}
+
+//--------------------------------------------------------------
+size_t MappingRecord::getCapacityBytes() const
+{
+    size_t bytes = warps.capacity() * sizeof(Entry);
+    for(auto & entry : warps){
+        bytes += entry.name.capacity() + entry.warp.getCapacityBytes();
+    }
+    return bytes;
+}
+
+//--------------------------------------------------------------
+MappingRecord::Entry& MappingRecord::addWarp()
+{
+    if(numWarps == warps.size()){
+        warps.emplace_back();
+    }
+    auto & entry = warps[numWarps++];
+    entry.name.clear();
+    entry.type = 0;
+    entry.srcSize = glm::ivec2(0, 0);
+    entry.srcArea = ofRectangle();
+    entry.drawArea = ofRectangle();
+    entry.warp.clear();
+    return entry;
+}
+
+//--------------------------------------------------------------
+// Writer
+//--------------------------------------------------------------
+
+void WarpJsonWriter::write(const WarpRecord& record)
+{
+    buffer.clear();
+    first.clear();
+    writeWarp(record);
+    buffer += '\n';
+}
+
+void WarpJsonWriter::write(const MappingRecord& mapping)
+{
+    buffer.clear();
+    first.clear();
+    beginObject();
+    key("warps");
+    beginArray();
+    for(size_t i = 0; i < mapping.numWarps; ++i){
+        const auto & entry = mapping.warps[i];
+        element();
+        beginObject();
+        key("name"); value(entry.name);
+        key("type"); value(entry.type);
+        key("srcSize");
+        float srcSize[2] = { float(entry.srcSize.x), float(entry.srcSize.y) };
+        values(srcSize, 2);
+        key("srcArea");
+        beginObject();
+        key("x"); value(entry.srcArea.x);
+        key("y"); value(entry.srcArea.y);
+        key("w"); value(entry.srcArea.width);
+        key("h"); value(entry.srcArea.height);
+        endObject();
+        key("drawArea");
+        beginObject();
+        key("x"); value(entry.drawArea.x);
+        key("y"); value(entry.drawArea.y);
+        key("w"); value(entry.drawArea.width);
+        key("h"); value(entry.drawArea.height);
+        endObject();
+        key("warp");
+        writeWarp(entry.warp);
+        endObject();
+    }
+    endArray();
+    endObject();
+    buffer += '\n';
+}
+
+void WarpJsonWriter::writeWarp(const WarpRecord& record)
+{
+    beginObject();
+    key("name"); value(record.name);
+    key("preset"); value(record.preset);
+    key("type"); value(record.type);
+    key("brightness"); value(record.brightness);
+
+    key("warp");
+    beginObject();
+    key("columns"); value(record.columns);
+    key("rows"); value(record.rows);
+    key("control points");
+    values(record.controlPoints.empty() ? nullptr : &record.controlPoints[0].x, record.controlPoints.size() * 2);
+    endObject();
+
+    key("blend");
+    beginObject();
+    key("exponent"); value(record.exponent);
+    key("edges"); values(&record.edges.x, 4);
+    key("gamma"); values(&record.gamma.x, 3);
+    key("luminance"); values(&record.luminance.x, 3);
+    endObject();
+
+    if(record.hasBilinear){
+        key("resolution"); value(record.resolution);
+        key("linear"); value(record.linear);
+        key("adaptive"); value(record.adaptive);
+        key("tolerance"); value(record.tolerance);
+    }
+
+    if(record.hasCorners){
+        key("corners"); values(&record.corners[0].x, 8);
+    }
+    endObject();
+}
+
+void WarpJsonWriter::newline()
+{
+    buffer += '\n';
+    buffer.append(first.size() * 4, ' ');
+}
+
+void WarpJsonWriter::beginObject()
+{
+    buffer += '{';
+    first.push_back(true);
+}
+
+void WarpJsonWriter::endObject()
+{
+    bool empty = first.back();
+    first.pop_back();
+    if(!empty) newline();
+    buffer += '}';
+}
+
+void WarpJsonWriter::beginArray()
+{
+    buffer += '[';
+    first.push_back(true);
+}
+
+void WarpJsonWriter::endArray()
+{
+    bool empty = first.back();
+    first.pop_back();
+    if(!empty) newline();
+    buffer += ']';
+}
+
+void WarpJsonWriter::element()
+{
+    if(!first.back()){
+        buffer += ',';
+    }
+    first.back() = false;
+    newline();
+}
+
+void WarpJsonWriter::key(const char* name)
+{
+    element();
+    buffer += '"';
+    buffer += name;
+    buffer += "\": ";
+}
+
+void WarpJsonWriter::value(const std::string& str)
+{
+    buffer += '"';
+    for(char c : str){
+        switch(c){
+            case '"': buffer += "\\\""; break;
+            case '\\': buffer += "\\\\"; break;
+            case '\n': buffer += "\\n"; break;
+            case '\r': buffer += "\\r"; break;
+            case '\t': buffer += "\\t"; break;
+            default:
+                if((unsigned char)c < 0x20){
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                    buffer += escaped;
+                }else{
+                    buffer += c;
+                }
+                break;
+        }
+    }
+    buffer += '"';
+}
+
+void WarpJsonWriter::value(float val)
+{
+    // 9 significant digits round trip any float.
+    char number[32];
+    int length = std::isfinite(val) ? std::snprintf(number, sizeof(number), "%.9g", val) : std::snprintf(number, sizeof(number), "0");
+    buffer.append(number, length);
+}
+
+void WarpJsonWriter::value(int val)
+{
+    char number[16];
+    int length = std::snprintf(number, sizeof(number), "%d", val);
+    buffer.append(number, length);
+}
+
+void WarpJsonWriter::value(bool val)
+{
+    buffer += val ? "true" : "false";
+}
+
+void WarpJsonWriter::values(const float* vals, size_t count)
+{
+    buffer += '[';
+    for(size_t i = 0; i < count; ++i){
+        if(i) buffer += ", ";
+        value(vals[i]);
+    }
+    buffer += ']';
+}
+
+//--------------------------------------------------------------
+// Reader
+//--------------------------------------------------------------
+
+namespace {
+
+    typedef enum
+    {
+        KEY_UNKNOWN,
+        KEY_WARPS,
+        KEY_NAME,
+        KEY_PRESET,
+        KEY_TYPE,
+        KEY_BRIGHTNESS,
+        KEY_WARP,
+        KEY_COLUMNS,
+        KEY_ROWS,
+        KEY_CONTROL_POINTS,
+        KEY_BLEND,
+        KEY_EXPONENT,
+        KEY_EDGES,
+        KEY_GAMMA,
+        KEY_LUMINANCE,
+        KEY_RESOLUTION,
+        KEY_LINEAR,
+        KEY_ADAPTIVE,
+        KEY_TOLERANCE,
+        KEY_CORNERS,
+        KEY_SRC_SIZE,
+        KEY_SRC_AREA,
+        KEY_DRAW_AREA,
+        KEY_X,
+        KEY_Y,
+        KEY_W,
+        KEY_H
+    } Key;
+
+    typedef enum
+    {
+        CONTEXT_SKIP,
+        CONTEXT_MAPPING,
+        CONTEXT_WARPS,
+        CONTEXT_ENTRY,
+        CONTEXT_SRC_AREA,
+        CONTEXT_DRAW_AREA,
+        CONTEXT_RECORD,
+        CONTEXT_RECORD_WARP,
+        CONTEXT_RECORD_BLEND,
+        CONTEXT_FLOATS
+    } Context;
+
+    Key toKey(const char* str, size_t length)
+    {
+        static const struct { const char* name; Key key; } keys[] = {
+            { "warps", KEY_WARPS },
+            { "name", KEY_NAME },
+            { "preset", KEY_PRESET },
+            { "type", KEY_TYPE },
+            { "brightness", KEY_BRIGHTNESS },
+            { "warp", KEY_WARP },
+            { "columns", KEY_COLUMNS },
+            { "rows", KEY_ROWS },
+            { "control points", KEY_CONTROL_POINTS },
+            { "blend", KEY_BLEND },
+            { "exponent", KEY_EXPONENT },
+            { "edges", KEY_EDGES },
+            { "gamma", KEY_GAMMA },
+            { "luminance", KEY_LUMINANCE },
+            { "resolution", KEY_RESOLUTION },
+            { "linear", KEY_LINEAR },
+            { "adaptive", KEY_ADAPTIVE },
+            { "tolerance", KEY_TOLERANCE },
+            { "corners", KEY_CORNERS },
+            { "srcSize", KEY_SRC_SIZE },
+            { "srcArea", KEY_SRC_AREA },
+            { "drawArea", KEY_DRAW_AREA },
+            { "x", KEY_X },
+            { "y", KEY_Y },
+            { "w", KEY_W },
+            { "h", KEY_H },
+        };
+        for(auto & k : keys){
+            if(std::strlen(k.name) == length && std::memcmp(k.name, str, length) == 0){
+                return k.key;
+            }
+        }
+        return KEY_UNKNOWN;
+    }
+
+    //! characters a JSON number is made of
+    inline bool isNumberChar(char c)
+    {
+        return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    //! appends every number found in a "x, y" style string
+    void appendFloats(const char* str, size_t length, std::vector<float>& out)
+    {
+        const char* end = str + length;
+        while(str < end){
+            if((*str >= '0' && *str <= '9') || *str == '-' || *str == '+' || *str == '.'){
+                char* next = nullptr;
+                float val = std::strtof(str, &next);
+                if(next == str || next > end){
+                    break;
+                }
+                out.push_back(val);
+                str = next;
+            }else{
+                ++str;
+            }
+        }
+    }
+
+    class Parser {
+    public:
+
+        Parser(const char* text, size_t length, std::string& scratch, std::vector<float>& floats, std::string& error) :
+            p(text),
+            begin(text),
+            end(text + length),
+            scratch(scratch),
+            floats(floats),
+            error(error)
+        {}
+
+        bool parse(Context rootContext)
+        {
+            error.clear();
+            skipWhitespace();
+            if(p >= end || *p != '{'){
+                return fail("expected an object");
+            }
+            stack.clear();
+            stack.push_back(Frame{CONTEXT_SKIP, KEY_UNKNOWN});
+            pendingContext = rootContext;
+            return parseValue(KEY_UNKNOWN);
+        }
+
+        WarpRecord* record{nullptr};
+        MappingRecord* mapping{nullptr};
+
+    private:
+
+        struct Frame {
+            Context context;
+            Key target;
+        };
+
+        static const int sMaxDepth = 32;
+
+        bool fail(const char* what)
+        {
+            error = std::string(what) + " at offset " + ofToString(p - begin);
+            return false;
+        }
+
+        void skipWhitespace()
+        {
+            while(p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) ++p;
+        }
+
+        //! parse a string, returning a view either into the text or into scratch when it had escapes
+        bool parseString(const char*& str, size_t& length)
+        {
+            ++p; // opening quote
+            const char* start = p;
+            while(p < end && *p != '"' && *p != '\\') ++p;
+            if(p < end && *p == '"'){
+                str = start;
+                length = p - start;
+                ++p;
+                return true;
+            }
+
+            scratch.assign(start, p - start);
+            while(p < end && *p != '"'){
+                if(*p == '\\'){
+                    if(++p >= end) break;
+                    switch(*p){
+                        case 'n': scratch += '\n'; break;
+                        case 't': scratch += '\t'; break;
+                        case 'r': scratch += '\r'; break;
+                        case 'b': scratch += '\b'; break;
+                        case 'f': scratch += '\f'; break;
+                        case 'u':
+                        {
+                            if(end - p < 5) return fail("truncated escape");
+                            unsigned code = std::strtoul(std::string(p + 1, 4).c_str(), nullptr, 16);
+                            if(code < 0x80){
+                                scratch += char(code);
+                            }else if(code < 0x800){
+                                scratch += char(0xc0 | (code >> 6));
+                                scratch += char(0x80 | (code & 0x3f));
+                            }else{
+                                scratch += char(0xe0 | (code >> 12));
+                                scratch += char(0x80 | ((code >> 6) & 0x3f));
+                                scratch += char(0x80 | (code & 0x3f));
+                            }
+                            p += 4;
+                        }break;
+                        default: scratch += *p; break;
+                    }
+                    ++p;
+                }else{
+                    scratch += *p++;
+                }
+            }
+            if(p >= end) return fail("unterminated string");
+            ++p;
+            str = scratch.data();
+            length = scratch.size();
+            return true;
+        }
+
+        //! context of a container opened under key inside the current frame
+        Context childContext(Key key, bool isArray) const
+        {
+            switch(stack.back().context){
+                case CONTEXT_MAPPING:
+                    if(isArray && key == KEY_WARPS) return CONTEXT_WARPS;
+                    break;
+                case CONTEXT_WARPS:
+                    if(!isArray) return CONTEXT_ENTRY;
+                    break;
+                case CONTEXT_ENTRY:
+                    if(isArray && key == KEY_SRC_SIZE) return CONTEXT_FLOATS;
+                    if(!isArray && key == KEY_SRC_AREA) return CONTEXT_SRC_AREA;
+                    if(!isArray && key == KEY_DRAW_AREA) return CONTEXT_DRAW_AREA;
+                    if(!isArray && key == KEY_WARP) return CONTEXT_RECORD;
+                    break;
+                case CONTEXT_RECORD:
+                    if(!isArray && key == KEY_WARP) return CONTEXT_RECORD_WARP;
+                    if(!isArray && key == KEY_BLEND) return CONTEXT_RECORD_BLEND;
+                    if(isArray && key == KEY_CORNERS) return CONTEXT_FLOATS;
+                    break;
+                case CONTEXT_RECORD_WARP:
+                    if(isArray && key == KEY_CONTROL_POINTS) return CONTEXT_FLOATS;
+                    break;
+                case CONTEXT_RECORD_BLEND:
+                    if(isArray && (key == KEY_EDGES || key == KEY_GAMMA || key == KEY_LUMINANCE)) return CONTEXT_FLOATS;
+                    break;
+                default:
+                    break;
+            }
+            return CONTEXT_SKIP;
+        }
+
+        MappingRecord::Entry& entry()
+        {
+            return mapping->warps[mapping->numWarps - 1];
+        }
+
+        //! move the collected floats into the field named by key
+        void assignFloats(Key key)
+        {
+            auto get = [this](size_t i){ return i < floats.size() ? floats[i] : 0.0f; };
+            switch(key){
+                case KEY_CONTROL_POINTS:
+                    record->controlPoints.resize(floats.size() / 2);
+                    for(size_t i = 0; i < record->controlPoints.size(); ++i){
+                        record->controlPoints[i] = glm::vec2(floats[i * 2], floats[i * 2 + 1]);
+                    }
+                    break;
+                case KEY_EDGES:
+                    record->edges = glm::vec4(get(0), get(1), get(2), get(3));
+                    break;
+                case KEY_GAMMA:
+                    record->gamma = glm::vec3(get(0), get(1), get(2));
+                    break;
+                case KEY_LUMINANCE:
+                    record->luminance = glm::vec3(get(0), get(1), get(2));
+                    break;
+                case KEY_CORNERS:
+                    for(int i = 0; i < 4; ++i){
+                        record->corners[i] = glm::vec2(get(i * 2), get(i * 2 + 1));
+                    }
+                    record->hasCorners = true;
+                    break;
+                case KEY_SRC_SIZE:
+                    entry().srcSize = glm::ivec2(get(0), get(1));
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        void handleNumber(Key key, double number)
+        {
+            auto context = stack.back().context;
+            if(context == CONTEXT_FLOATS){
+                floats.push_back(number);
+                return;
+            }
+            if(context == CONTEXT_SRC_AREA || context == CONTEXT_DRAW_AREA){
+                auto & rect = context == CONTEXT_SRC_AREA ? entry().srcArea : entry().drawArea;
+                switch(key){
+                    case KEY_X: rect.x = number; break;
+                    case KEY_Y: rect.y = number; break;
+                    case KEY_W: rect.width = number; break;
+                    case KEY_H: rect.height = number; break;
+                    default: break;
+                }
+            }else if(context == CONTEXT_ENTRY){
+                if(key == KEY_TYPE) entry().type = int(number);
+            }else if(context == CONTEXT_RECORD){
+                switch(key){
+                    case KEY_TYPE: record->type = int(number); break;
+                    case KEY_BRIGHTNESS: record->brightness = number; break;
+                    case KEY_RESOLUTION: record->resolution = int(number); record->hasBilinear = true; break;
+                    case KEY_TOLERANCE: record->tolerance = number; record->hasBilinear = true; break;
+                    default: break;
+                }
+            }else if(context == CONTEXT_RECORD_WARP){
+                if(key == KEY_COLUMNS) record->columns = int(number);
+                if(key == KEY_ROWS) record->rows = int(number);
+            }else if(context == CONTEXT_RECORD_BLEND){
+                if(key == KEY_EXPONENT) record->exponent = number;
+            }
+        }
+
+        void handleBool(Key key, bool val)
+        {
+            if(stack.back().context != CONTEXT_RECORD) return;
+            if(key == KEY_LINEAR){ record->linear = val; record->hasBilinear = true; }
+            if(key == KEY_ADAPTIVE){ record->adaptive = val; record->hasBilinear = true; }
+        }
+
+        void handleString(Key key, const char* str, size_t length)
+        {
+            auto context = stack.back().context;
+            if(context == CONTEXT_FLOATS){
+                // Older files store each vector as a "x, y" string.
+                appendFloats(str, length, floats);
+            }else if(context == CONTEXT_ENTRY){
+                if(key == KEY_NAME){
+                    entry().name.assign(str, length);
+                }else if(key == KEY_SRC_SIZE){
+                    floats.clear();
+                    appendFloats(str, length, floats);
+                    assignFloats(KEY_SRC_SIZE);
+                }
+            }else if(context == CONTEXT_RECORD){
+                if(key == KEY_NAME) record->name.assign(str, length);
+                if(key == KEY_PRESET) record->preset.assign(str, length);
+            }else if(context == CONTEXT_RECORD_BLEND){
+                if(key == KEY_EDGES || key == KEY_GAMMA || key == KEY_LUMINANCE){
+                    floats.clear();
+                    appendFloats(str, length, floats);
+                    assignFloats(key);
+                }
+            }
+        }
+
+        bool open(Key key, bool isArray)
+        {
+            if(stack.size() >= sMaxDepth) return fail("nesting too deep");
+            Context context = pendingContext != CONTEXT_SKIP ? pendingContext : (stack.back().context == CONTEXT_SKIP ? CONTEXT_SKIP : childContext(key, isArray));
+            pendingContext = CONTEXT_SKIP;
+
+            if(context == CONTEXT_ENTRY){
+                record = &mapping->addWarp().warp;
+            }else if(context == CONTEXT_FLOATS){
+                floats.clear();
+            }
+            stack.push_back(Frame{context, key});
+            return true;
+        }
+
+        void close()
+        {
+            auto frame = stack.back();
+            stack.pop_back();
+            if(frame.context == CONTEXT_FLOATS){
+                assignFloats(frame.target);
+            }
+        }
+
+        bool parseValue(Key key)
+        {
+            skipWhitespace();
+            if(p >= end) return fail("unexpected end");
+
+            switch(*p){
+                case '{':
+                {
+                    ++p;
+                    if(!open(key, false)) return false;
+                    skipWhitespace();
+                    if(p < end && *p == '}'){
+                        ++p;
+                        close();
+                        return true;
+                    }
+                    while(true){
+                        skipWhitespace();
+                        if(p >= end || *p != '"') return fail("expected a key");
+                        const char* str;
+                        size_t length;
+                        if(!parseString(str, length)) return false;
+                        auto memberKey = toKey(str, length);
+                        skipWhitespace();
+                        if(p >= end || *p != ':') return fail("expected ':'");
+                        ++p;
+                        if(!parseValue(memberKey)) return false;
+                        skipWhitespace();
+                        if(p < end && *p == ','){
+                            ++p;
+                            continue;
+                        }
+                        if(p < end && *p == '}'){
+                            ++p;
+                            break;
+                        }
+                        return fail("expected ',' or '}'");
+                    }
+                    close();
+                    return true;
+                }
+                case '[':
+                {
+                    ++p;
+                    if(!open(key, true)) return false;
+                    skipWhitespace();
+                    if(p < end && *p == ']'){
+                        ++p;
+                        close();
+                        return true;
+                    }
+                    while(true){
+                        if(!parseValue(KEY_UNKNOWN)) return false;
+                        skipWhitespace();
+                        if(p < end && *p == ','){
+                            ++p;
+                            continue;
+                        }
+                        if(p < end && *p == ']'){
+                            ++p;
+                            break;
+                        }
+                        return fail("expected ',' or ']'");
+                    }
+                    close();
+                    return true;
+                }
+                case '"':
+                {
+                    const char* str;
+                    size_t length;
+                    if(!parseString(str, length)) return false;
+                    handleString(key, str, length);
+                    return true;
+                }
+                case 't':
+                    if(end - p < 4 || std::memcmp(p, "true", 4) != 0) return fail("invalid literal");
+                    p += 4;
+                    handleBool(key, true);
+                    return true;
+                case 'f':
+                    if(end - p < 5 || std::memcmp(p, "false", 5) != 0) return fail("invalid literal");
+                    p += 5;
+                    handleBool(key, false);
+                    return true;
+                case 'n':
+                    if(end - p < 4 || std::memcmp(p, "null", 4) != 0) return fail("invalid literal");
+                    p += 4;
+                    return true;
+                default:
+                {
+                    // The text isn't terminated, strtod reads a terminated copy of the number so it can't run past end.
+                    char token[64];
+                    size_t length = 0;
+                    while(p + length < end && isNumberChar(p[length])){
+                        if(length == sizeof(token) - 1) return fail("invalid number");
+                        token[length] = p[length];
+                        ++length;
+                    }
+                    token[length] = '\0';
+                    char* next = nullptr;
+                    double number = std::strtod(token, &next);
+                    if(next == token || next > token + length) return fail("invalid number");
+                    p += next - token;
+                    handleNumber(key, number);
+                    return true;
+                }
+            }
+        }
+
+        const char* p;
+        const char* begin;
+        const char* end;
+        std::string& scratch;
+        std::vector<float>& floats;
+        std::string& error;
+        std::vector<Frame> stack;
+        Context pendingContext{CONTEXT_SKIP};
+    };
+
+}
+
+bool WarpJsonReader::read(const char* text, size_t length, WarpRecord& record)
+{
+    record.clear();
+    Parser parser(text, length, scratch, floats, error);
+    parser.record = &record;
+    return parser.parse(CONTEXT_RECORD);
+}
+
+bool WarpJsonReader::read(const char* text, size_t length, MappingRecord& mapping)
+{
+    mapping.clear();
+    Parser parser(text, length, scratch, floats, error);
+    parser.mapping = &mapping;
+    return parser.parse(CONTEXT_MAPPING);
+}
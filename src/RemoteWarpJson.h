@@ -0,0 +1,120 @@
+//
+//  RemoteWarpJson.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include "ofMain.h"
+
+//! flat copy of everything a warp writes to controlpoints.json.
+//! records are meant to be reused, clear() keeps the allocated storage around.
+struct WarpRecord {
+
+    void clear();
+    //! bytes allocated beyond the record itself
+    size_t getCapacityBytes() const;
+
+    std::string name;
+    std::string preset;
+    int type{0};
+    float brightness{1.0f};
+
+    int columns{2};
+    int rows{2};
+    std::vector<glm::vec2> controlPoints;
+
+    float exponent{2.0f};
+    glm::vec4 edges{0.0f};
+    glm::vec3 gamma{1.0f};
+    glm::vec3 luminance{0.5f};
+
+    //! bilinear warps only
+    bool hasBilinear{false};
+    int resolution{16};
+    bool linear{false};
+    bool adaptive{true};
+    float tolerance{0.0f};
+
+    //! perspective bilinear warps only
+    bool hasCorners{false};
+    glm::vec2 corners[4];
+};
+
+//! contents of ProjectionMapping.json
+struct MappingRecord {
+
+    struct Entry {
+        std::string name;
+        int type{0};
+        glm::ivec2 srcSize;
+        ofRectangle srcArea;
+        ofRectangle drawArea;
+        WarpRecord warp;
+    };
+
+    //! drop every entry, keeping them allocated for the next read
+    void clear(){ numWarps = 0; }
+    //! append an entry, reusing a previously allocated one if possible
+    Entry& addWarp();
+    //! bytes allocated for every entry, valid or not
+    size_t getCapacityBytes() const;
+
+    //! only the first numWarps entries are valid
+    std::vector<Entry> warps;
+    size_t numWarps{0};
+};
+
+//! writes the mapping schema straight into a reusable text buffer, numeric data is written as plain arrays.
+class WarpJsonWriter {
+public:
+
+    void write(const WarpRecord& record);
+    void write(const MappingRecord& mapping);
+
+    const std::string& str() const { return buffer; }
+    size_t getCapacityBytes() const { return buffer.capacity() + first.capacity() / 8; }
+
+private:
+
+    void writeWarp(const WarpRecord& record);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const char* name);
+    void element();
+    void value(const std::string& str);
+    void value(float val);
+    void value(int val);
+    void value(bool val);
+    void values(const float* vals, size_t count);
+
+    void newline();
+
+    std::string buffer;
+    //! one entry per open container, true until its first member is written
+    std::vector<bool> first;
+};
+
+//! SAX-style reader for the mapping schema that fills preallocated records without building a document.
+//! reads both the numeric arrays written by WarpJsonWriter and the older format that stored vectors as "x, y" strings.
+class WarpJsonReader {
+public:
+
+    bool read(const char* text, size_t length, WarpRecord& record);
+    bool read(const char* text, size_t length, MappingRecord& mapping);
+
+    bool read(const std::string& text, WarpRecord& record){ return read(text.data(), text.size(), record); }
+    bool read(const std::string& text, MappingRecord& mapping){ return read(text.data(), text.size(), mapping); }
+
+    const std::string& getError() const { return error; }
+    size_t getCapacityBytes() const { return scratch.capacity() + floats.capacity() * sizeof(float) + error.capacity(); }
+
+private:
+
+    std::string scratch;
+    std::vector<float> floats;
+    std::string error;
+};
@@ -0,0 +1,55 @@
+//
+//  RemoteWarpMemory.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteWarpMemory.h"
+
+#include <algorithm>
+
+size_t RemoteWarpMemory::getCpuBytes() const
+{
+    return controlPoints + selection + staging + journal + caches;
+}
+
+size_t RemoteWarpMemory::getGpuBytes() const
+{
+    return vertices + texCoords + indices + controls;
+}
+
+RemoteWarpMemory& RemoteWarpMemory::operator+=(const RemoteWarpMemory& other)
+{
+    controlPoints += other.controlPoints;
+    selection += other.selection;
+    staging += other.staging;
+    journal += other.journal;
+    caches += other.caches;
+    vertices += other.vertices;
+    texCoords += other.texCoords;
+    indices += other.indices;
+    controls += other.controls;
+    return *this;
+}
+
+void RemoteMemoryReport::sample(const RemoteWarpMemory& memory)
+{
+    current = memory;
+    peak.controlPoints = std::max(peak.controlPoints, memory.controlPoints);
+    peak.selection = std::max(peak.selection, memory.selection);
+    peak.staging = std::max(peak.staging, memory.staging);
+    peak.journal = std::max(peak.journal, memory.journal);
+    peak.caches = std::max(peak.caches, memory.caches);
+    peak.vertices = std::max(peak.vertices, memory.vertices);
+    peak.texCoords = std::max(peak.texCoords, memory.texCoords);
+    peak.indices = std::max(peak.indices, memory.indices);
+    peak.controls = std::max(peak.controls, memory.controls);
+    peakCpuBytes = std::max(peakCpuBytes, memory.getCpuBytes());
+    peakGpuBytes = std::max(peakGpuBytes, memory.getGpuBytes());
+}
+
+void RemoteMemoryReport::resetPeaks()
+{
+    peak = current;
+    peakCpuBytes = current.getCpuBytes();
+    peakGpuBytes = current.getGpuBytes();
+}
@@ -0,0 +1,55 @@
+//
+//  RemoteWarpMemory.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <cstddef>
+
+//! bytes held by a warp, or by the whole mapper, split up by what they're for. CPU bytes count allocated capacity, not
+//! what's in use, GPU bytes count the buffers as they were uploaded.
+struct RemoteWarpMemory {
+
+    //! control points and the params shared with RemoteUI
+    size_t controlPoints{0};
+    //! selected control points and the queued control overlay instances
+    size_t selection{0};
+    //! mesh builders, async mesh requests and the triple buffered meshes
+    size_t staging{0};
+    //! pending journal records, replicated records and queued commands
+    size_t journal{0};
+    //! JSON records and text buffers kept around for saving and loading, and the frame arena. only the mapper counts these
+    size_t caches{0};
+
+    //! vertex positions of the mesh
+    size_t vertices{0};
+    //! texture coordinates and triangle indices, shared by every warp of the same mesh resolution unless the mesh is
+    //! tessellated. the mapper counts each shared buffer once
+    size_t texCoords{0};
+    size_t indices{0};
+    //! control overlay vbo
+    size_t controls{0};
+    //! set when texCoords and indices are a topology shared with other warps
+    bool sharedTopology{false};
+
+    size_t getCpuBytes() const;
+    size_t getGpuBytes() const;
+
+    RemoteWarpMemory& operator+=(const RemoteWarpMemory& other);
+};
+
+//! what something holds now, and the most it held since the peaks were reset
+struct RemoteMemoryReport {
+
+    RemoteWarpMemory current;
+    //! the highest every field was on its own
+    RemoteWarpMemory peak;
+    size_t peakCpuBytes{0};
+    size_t peakGpuBytes{0};
+
+    //! take memory as current and raise the peaks
+    void sample(const RemoteWarpMemory& memory);
+    //! start the peaks over from current
+    void resetPeaks();
+};
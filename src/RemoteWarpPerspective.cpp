@@ -76,18 +76,6 @@ RemoteWarpPerspective::RemoteWarpPerspective(const std::string& name, const Warp
     this->srcPoints[1] = glm::vec2(this->width, 0.0f);
     this->srcPoints[2] = glm::vec2(this->width, this->height);
     this->srcPoints[3] = glm::vec2(0.0f, this->height);
-
-    if(!this->shader.isLoaded()){
-        this->shader.setupShaderFromSource(GL_VERTEX_SHADER, prVert);
-        this->shader.setupShaderFromSource(GL_FRAGMENT_SHADER, prFrag);
-        this->shader.bindDefaults();
-        this->shader.linkProgram();
-    }
-    
-    RUI_SHARE_PARAM_WCN(warpName+"-flipVertical",remoteFlipV);
-    RUI_SHARE_PARAM_WCN(warpName+"-flipHorizontal",remoteFlipH);
-    RUI_SHARE_PARAM_WCN(warpName+"-rot CW",remoteRotateCW);
-    RUI_SHARE_PARAM_WCN(warpName+"-rot CCW",remoteRotateCCW);
     
     if(std::filesystem::exists(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename)){
         loadControlPoints(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename);
@@ -103,24 +91,24 @@ void RemoteWarpPerspective::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
     switch (arg.action) {
         case CLIENT_UPDATED_PARAM:
             if(arg.group == remoteGroupName){
+                RemoteWarpCommand command;
                 if(arg.paramName == (warpName+"-flipHorizontal")){
-                    flipHorizontal();
+                    command.type = RemoteWarpCommand::COMMAND_FLIP_HORIZONTAL;
                     remoteFlipH = false;
-                    RUI_PUSH_TO_CLIENT();
                 }else if(arg.paramName == (warpName+"-flipVertical")){
-                    flipVertical();
+                    command.type = RemoteWarpCommand::COMMAND_FLIP_VERTICAL;
                     remoteFlipV = false;
-                    RUI_PUSH_TO_CLIENT();
                 }else if(arg.paramName == (warpName+"-rot CW")){
-                    rotateClockwise();
+                    command.type = RemoteWarpCommand::COMMAND_ROTATE_CLOCKWISE;
                     remoteRotateCW = false;
-                    RUI_PUSH_TO_CLIENT();
                 }else if(arg.paramName == (warpName+"-rot CCW")){
-                    rotateCounterclockwise();
+                    command.type = RemoteWarpCommand::COMMAND_ROTATE_COUNTERCLOCKWISE;
                     remoteRotateCCW = false;
-                    RUI_PUSH_TO_CLIENT();
-                }else if( arg.paramName.substr(0,ctrlptPrefix.size()) == ctrlptPrefix ){
-                    dirty = true;
+                }
+                if(command.type != RemoteWarpCommand::COMMAND_NONE){
+                    pushCommand(command);
+                    requestPushToClient();
+                    return;
                 }
             }
             break;
@@ -130,17 +118,57 @@ void RemoteWarpPerspective::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
     RemoteWarpBase::handleRemoteUpdate(arg);
 }
 
+void RemoteWarpPerspective::applyCommand(const RemoteWarpCommand & command)
+{
+    switch (command.type) {
+        case RemoteWarpCommand::COMMAND_FLIP_HORIZONTAL:
+            flipHorizontal();
+            break;
+        case RemoteWarpCommand::COMMAND_FLIP_VERTICAL:
+            flipVertical();
+            break;
+        case RemoteWarpCommand::COMMAND_ROTATE_CLOCKWISE:
+            rotateClockwise();
+            break;
+        case RemoteWarpCommand::COMMAND_ROTATE_COUNTERCLOCKWISE:
+            rotateCounterclockwise();
+            break;
+        default:
+            RemoteWarpBase::applyCommand(command);
+            break;
+    }
+}
+
+//--------------------------------------------------------------
+bool RemoteWarpPerspective::setStreamedCorner(size_t index, const glm::vec2& pos)
+{
+    return index < 4 && setStreamedControlPoint(index, pos);
+}
+
 //--------------------------------------------------------------
 RemoteWarpPerspective::~RemoteWarpPerspective()
 {
     
 }
 
+//--------------------------------------------------------------
+void RemoteWarpPerspective::shareRemoteParams()
+{
+    RemoteWarpBase::shareRemoteParams();
+    
+    RUI_SHARE_PARAM_WCN(warpName+"-flipVertical",remoteFlipV.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-flipHorizontal",remoteFlipH.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-rot CW",remoteRotateCW.bind());
+    RUI_SHARE_PARAM_WCN(warpName+"-rot CCW",remoteRotateCCW.bind());
+}
+
 //--------------------------------------------------------------
 const glm::mat4 & RemoteWarpPerspective::getTransform()
 {
     // Calculate warp matrix.
     if (this->dirty) {
+        RemoteWarpStats::Timer timer(*this->stats, RemoteWarpStats::STAGE_TRANSFORM);
+        
         // Update source size.
         this->srcPoints[1].x = this->width;
         this->srcPoints[2].x = this->width;
@@ -163,6 +191,12 @@ const glm::mat4 & RemoteWarpPerspective::getTransform()
     return this->transform;
 }
 
+//--------------------------------------------------------------
+void RemoteWarpPerspective::update()
+{
+    this->getTransform();
+}
+
 //--------------------------------------------------------------
 const glm::mat4 & RemoteWarpPerspective::getTransformInverted()
 {
@@ -205,35 +239,21 @@ void RemoteWarpPerspective::end()
 //--------------------------------------------------------------
 void RemoteWarpPerspective::drawTexture(const ofTexture & texture, const ofRectangle & srcBounds, const ofRectangle & dstBounds)
 {
+    if (!this->shader.isLoaded())
+    {
+        this->shader.setupShaderFromSource(GL_VERTEX_SHADER, prVert);
+        this->shader.setupShaderFromSource(GL_FRAGMENT_SHADER, prFrag);
+        this->shader.bindDefaults();
+        this->shader.linkProgram();
+    }
+    
     // Clip against bounds.
     auto srcClip = srcBounds;
     auto dstClip = dstBounds;
     this->clip(srcClip, dstClip);
     
     // Set corner texture coordinates.
-    glm::vec4 corners;
-    if (texture.getTextureData().textureTarget == GL_TEXTURE_RECTANGLE_ARB)
-    {
-        if (texture.getTextureData().bFlipTexture)
-        {
-            corners = glm::vec4(srcClip.getMinX(), srcClip.getMaxY(), srcClip.getMaxX(), srcClip.getMinY());
-        }
-        else
-        {
-            corners = glm::vec4(srcClip.getMinX(), srcClip.getMinY(), srcClip.getMaxX(), srcClip.getMaxY());
-        }
-    }
-    else
-    {
-        if (texture.getTextureData().bFlipTexture)
-        {
-            corners = glm::vec4(srcClip.getMinX() / texture.getWidth(), srcClip.getMaxY() / texture.getHeight(), srcClip.getMaxX() / texture.getWidth(), srcClip.getMinY() / texture.getHeight());
-        }
-        else
-        {
-            corners = glm::vec4(srcClip.getMinX() / texture.getWidth(), srcClip.getMinY() / texture.getHeight(), srcClip.getMaxX() / texture.getWidth(), srcClip.getMaxY() / texture.getHeight());
-        }
-    }
+    auto corners = RemoteGeometry::getTextureCorners(glm::vec4(srcClip.getMinX(), srcClip.getMinY(), srcClip.getMaxX(), srcClip.getMaxY()), glm::vec2(texture.getWidth(), texture.getHeight()), texture.getTextureData().textureTarget != GL_TEXTURE_RECTANGLE_ARB, texture.getTextureData().bFlipTexture);
     
     ofPushMatrix();
     {
@@ -312,32 +332,29 @@ void RemoteWarpPerspective::drawControls()
 //--------------------------------------------------------------
 void RemoteWarpPerspective::rotateClockwise()
 {
-    std::swap(this->controlPoints[3], this->controlPoints[0]);
-    std::swap(this->controlPoints[0], this->controlPoints[1]);
-    std::swap(this->controlPoints[1], this->controlPoints[2]);
+    RemoteGeometry::rotateCorners(this->controlPoints.data(), true);
     if(selectedIndices.size() == 1){
         selectedIndices.front().index = (selectedIndices.front().index + 3) % 4;
     }
     this->dirty = true;
+    this->journalControlGrid();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpPerspective::rotateCounterclockwise()
 {
-    std::swap(this->controlPoints[1], this->controlPoints[2]);
-    std::swap(this->controlPoints[0], this->controlPoints[1]);
-    std::swap(this->controlPoints[3], this->controlPoints[0]);
+    RemoteGeometry::rotateCorners(this->controlPoints.data(), false);
     if(selectedIndices.size() == 1){
         selectedIndices.front().index = (selectedIndices.front().index + 1) % 4;
     }
     this->dirty = true;
+    this->journalControlGrid();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpPerspective::flipHorizontal()
 {
-    std::swap(this->controlPoints[0], this->controlPoints[1]);
-    std::swap(this->controlPoints[2], this->controlPoints[3]);
+    RemoteGeometry::flipCornersHorizontal(this->controlPoints.data());
     
     if(selectedIndices.size() == 1){
         if (selectedIndices.front().index % 2)
@@ -350,98 +367,18 @@ void RemoteWarpPerspective::flipHorizontal()
         }
     }
     this->dirty = true;
+    this->journalControlGrid();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpPerspective::flipVertical()
 {
-    std::swap(this->controlPoints[0], this->controlPoints[3]);
-    std::swap(this->controlPoints[1], this->controlPoints[2]);
+    RemoteGeometry::flipCornersVertical(this->controlPoints.data());
     
     if(selectedIndices.size() == 1){
         selectedIndices.front().index = (this->controlPoints.size() - 1) - selectedIndices.front().index;
     }
     
     this->dirty = true;
+    this->journalControlGrid();
 }
-
-glm::mat4 PerspectiveTransformation::transform(const glm::vec2 src[4], const glm::vec2 dst[4])
-{
-    float p[8][9] =
-    {
-        { -src[0][0], -src[0][1], -1, 0, 0, 0, src[0][0] * dst[0][0], src[0][1] * dst[0][0], -dst[0][0] }, // h11
-        { 0, 0, 0, -src[0][0], -src[0][1], -1, src[0][0] * dst[0][1], src[0][1] * dst[0][1], -dst[0][1] }, // h12
-        { -src[1][0], -src[1][1], -1, 0, 0, 0, src[1][0] * dst[1][0], src[1][1] * dst[1][0], -dst[1][0] }, // h13
-        { 0, 0, 0, -src[1][0], -src[1][1], -1, src[1][0] * dst[1][1], src[1][1] * dst[1][1], -dst[1][1] }, // h21
-        { -src[2][0], -src[2][1], -1, 0, 0, 0, src[2][0] * dst[2][0], src[2][1] * dst[2][0], -dst[2][0] }, // h22
-        { 0, 0, 0, -src[2][0], -src[2][1], -1, src[2][0] * dst[2][1], src[2][1] * dst[2][1], -dst[2][1] }, // h23
-        { -src[3][0], -src[3][1], -1, 0, 0, 0, src[3][0] * dst[3][0], src[3][1] * dst[3][0], -dst[3][0] }, // h31
-        { 0, 0, 0, -src[3][0], -src[3][1], -1, src[3][0] * dst[3][1], src[3][1] * dst[3][1], -dst[3][1] }, // h32
-    };
-    
-    PerspectiveTransformation::gaussianElimination(&p[0][0], 9);
-    
-    return glm::mat4(p[0][8], p[3][8], 0, p[6][8],
-                     p[1][8], p[4][8], 0, p[7][8],
-                     0, 0, 1, 0,
-                     p[2][8], p[5][8], 0, 1);
-}
-
-void PerspectiveTransformation::gaussianElimination(float * input, int n)
-{
-    auto i = 0;
-    auto j = 0;
-    auto m = n - 1;
-    
-    while (i < m && j < n)
-    {
-        auto iMax = i;
-        for (auto k = i + 1; k < m; ++k)
-        {
-            if (fabs(input[k * n + j]) > fabs(input[iMax * n + j]))
-            {
-                iMax = k;
-            }
-        }
-        
-        if (input[iMax * n + j] != 0)
-        {
-            if (i != iMax)
-            {
-                for (auto k = 0; k < n; ++k)
-                {
-                    auto ikIn = input[i * n + k];
-                    input[i * n + k] = input[iMax * n + k];
-                    input[iMax * n + k] = ikIn;
-                }
-            }
-            
-            float ijIn = input[i * n + j];
-            for (auto k = 0; k < n; ++k)
-            {
-                input[i * n + k] /= ijIn;
-            }
-            
-            for (auto u = i + 1; u < m; ++u)
-            {
-                auto ujIn = input[u * n + j];
-                for (auto k = 0; k < n; ++k)
-                {
-                    input[u * n + k] -= ujIn * input[i * n + k];
-                }
-            }
-            
-            ++i;
-        }
-        ++j;
-    }
-    
-    for (auto i = m - 2; i >= 0; --i)
-    {
-        for (auto j = i + 1; j < n - 1; ++j)
-        {
-            input[i * n + m] -= input[i * n + j] * input[j * n + m];
-        }
-    }
-}
-
@@ -9,19 +9,6 @@
 
 #include "RemoteWarpBase.h"
 
-class PerspectiveTransformation {
-public:
-    
-    static glm::mat4 transform(const glm::vec2 src[4], const glm::vec2 dst[4]);
-    static void gaussianElimination(float * input, int n);
-
-private:
-    
-    PerspectiveTransformation() = default;
-    
-};
-
-
 class RemoteWarpPerspective : public RemoteWarpBase {
 public:
     RemoteWarpPerspective(const std::string& name, const WarpSettings& settings);
@@ -44,6 +31,12 @@ public:
     virtual void flipHorizontal() override;
     virtual void flipVertical() override;
     
+    //! the four control points are the corners
+    virtual bool setStreamedCorner(size_t index, const glm::vec2& pos) override;
+    
+    //! compute the transform
+    virtual void update() override;
+    
 protected:
     //! draw a specific area of a warped texture to a specific region
     virtual void drawTexture(const ofTexture & texture, const ofRectangle & srcBounds, const ofRectangle & dstBounds) override;
@@ -53,11 +46,13 @@ protected:
 protected:
     
     virtual void handleRemoteUpdate(RemoteUIServerCallBackArg & arg)override;
+    virtual void applyCommand(const RemoteWarpCommand & command)override;
+    virtual void shareRemoteParams()override;
     
-    bool remoteFlipH{false};
-    bool remoteFlipV{false};
-    bool remoteRotateCW{false};
-    bool remoteRotateCCW{false};
+    RemoteShadow<bool> remoteFlipH{false};
+    RemoteShadow<bool> remoteFlipV{false};
+    RemoteShadow<bool> remoteRotateCW{false};
+    RemoteShadow<bool> remoteRotateCCW{false};
 
     glm::vec2 srcPoints[4];
     glm::vec2 dstPoints[4];
@@ -21,10 +21,11 @@ RemoteWarpPerspectiveBilinear::RemoteWarpPerspectiveBilinear(const std::string&
     this->srcPoints[2] = glm::vec2(windowSize.x, windowSize.y);
     this->srcPoints[3] = glm::vec2(0.0f, windowSize.y);
     
-    remoteCorners[0] = glm::vec2(0.0f, 0.0f);
-    remoteCorners[1] = glm::vec2(1.0f, 0.0f);
-    remoteCorners[2] = glm::vec2(1.0f, 1.0f);
-    remoteCorners[3] = glm::vec2(0.0f, 1.0f);
+    perspCorners[0] = glm::vec2(0.0f, 0.0f);
+    perspCorners[1] = glm::vec2(1.0f, 0.0f);
+    perspCorners[2] = glm::vec2(1.0f, 1.0f);
+    perspCorners[3] = glm::vec2(0.0f, 1.0f);
+    syncRemoteCorners();
     
     if(std::filesystem::exists(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename)){
         loadControlPoints(saveLocation/currentPreset/RemoteWarpBase::sSaveFilename);
@@ -45,9 +46,20 @@ void RemoteWarpPerspectiveBilinear::handleRemoteUpdate(RemoteUIServerCallBackArg
     switch (arg.action) {
         case CLIENT_UPDATED_PARAM:
             if(arg.group == remoteGroupName){
-                static auto c = std::string(ctrlptPrefix+" corner");
-                if( arg.paramName.substr(0,c.size()) == c){
-                    dirty = true;
+                auto prefix = ctrlptPrefix+" corner";
+                if( arg.paramName.compare(0, prefix.size(), prefix) == 0){
+                    static const std::string names[4] = {" TL", " TR", " BR", " BL"};
+                    for(size_t i = 0; i < 4; ++i){
+                        if(arg.paramName.compare(prefix.size(), names[i].size(), names[i]) == 0){
+                            RemoteWarpCommand command;
+                            command.type = RemoteWarpCommand::COMMAND_CORNER;
+                            command.index = i;
+                            command.component = arg.paramName.back() == 'y' ? 1 : 0;
+                            command.value[command.component] = arg.param.floatVal;
+                            pushCommand(command);
+                        }
+                    }
+                    return;
                 }
             }
             break;
@@ -57,24 +69,56 @@ void RemoteWarpPerspectiveBilinear::handleRemoteUpdate(RemoteUIServerCallBackArg
     RemoteWarpBilinear::handleRemoteUpdate(arg);
 }
 
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::applyCommand(const RemoteWarpCommand & command)
+{
+    if(command.type == RemoteWarpCommand::COMMAND_CORNER){
+        if(command.index >= 0 && command.index < 4){
+            perspCorners[command.index][command.component] = command.value[command.component];
+            getJournal().appendCorner(command.index, perspCorners[command.index]);
+            transformDirty = true;
+        }
+    }else{
+        RemoteWarpBilinear::applyCommand(command);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::syncRemoteParams()
+{
+    RemoteWarpBilinear::syncRemoteParams();
+    
+    syncRemoteCorners();
+}
+
+
+void RemoteWarpPerspectiveBilinear::syncRemoteCorners()
+{
+    for(size_t i = 0; i < 4; ++i){
+        remoteCorners[i][0] = perspCorners[i].x;
+        remoteCorners[i][1] = perspCorners[i].y;
+    }
+}
 
 void RemoteWarpPerspectiveBilinear::addControlPoints()
 {
     RUI_NEW_GROUP(remoteGroupName);
     
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TL x",remoteCorners[0].x,0.f, 1.f);
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TL y",remoteCorners[0].y,0.f, 1.f);
+    syncRemoteCorners();
     
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TR x",remoteCorners[1].x,0.f, 1.f);
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TR y",remoteCorners[1].y,0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TL x",remoteCorners[0][0].bind(),0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TL y",remoteCorners[0][1].bind(),0.f, 1.f);
     
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BR x",remoteCorners[2].x,0.f, 1.f);
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BR y",remoteCorners[2].y,0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TR x",remoteCorners[1][0].bind(),0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner TR y",remoteCorners[1][1].bind(),0.f, 1.f);
     
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BL x",remoteCorners[3].x,0.f, 1.f);
-    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BL y",remoteCorners[3].y,0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BR x",remoteCorners[2][0].bind(),0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BR y",remoteCorners[2][1].bind(),0.f, 1.f);
     
-    RUI_PUSH_TO_CLIENT();
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BL x",remoteCorners[3][0].bind(),0.f, 1.f);
+    RUI_SHARE_PARAM_WCN(ctrlptPrefix+" corner BL y",remoteCorners[3][1].bind(),0.f, 1.f);
+    
+    requestPushToClient();
     
     RemoteWarpBilinear::addControlPoints();
 }
@@ -95,55 +139,81 @@ void RemoteWarpPerspectiveBilinear::removeControlPoints()
     instance->removeParamFromDB(ctrlptPrefix + " corner BL x", true);
     instance->removeParamFromDB(ctrlptPrefix + " corner BL y", true);
     
-    RUI_PUSH_TO_CLIENT();
+    requestPushToClient();
     
     RemoteWarpBilinear::removeControlPoints();
 }
 
 //--------------------------------------------------------------
-void RemoteWarpPerspectiveBilinear::serialize(nlohmann::json & json)
+void RemoteWarpPerspectiveBilinear::serialize(WarpRecord & record) const
 {
-    RemoteWarpBilinear::serialize(json);
+    RemoteWarpBilinear::serialize(record);
     
-    std::vector<std::string> corners;
+    record.hasCorners = true;
     for (auto i = 0; i < 4; ++i)
     {
-        const auto corner = remoteCorners[i];
-        std::ostringstream oss;
-        oss << corner;
-        corners.push_back(oss.str());
+        record.corners[i] = perspCorners[i];
     }
-    json["corners"] = corners;
 }
 
 //--------------------------------------------------------------
-void RemoteWarpPerspectiveBilinear::deserialize(const nlohmann::json & json)
+void RemoteWarpPerspectiveBilinear::deserialize(const WarpRecord & record)
 {
-    RemoteWarpBilinear::deserialize(json);
+    RemoteWarpBilinear::deserialize(record);
     
-    auto i = 0;
-    for (const auto & jsonPoint : json["corners"])
-    {
-        glm::vec2 corner;
-        std::istringstream iss;
-        iss.str(jsonPoint);
-        iss >> corner;
-        remoteCorners[i] = corner;
-        
-        ++i;
+    if(record.hasCorners){
+        for (auto i = 0; i < 4; ++i)
+        {
+            perspCorners[i] = record.corners[i];
+        }
     }
     
-    if(remoteEditMode)
-        RUI_PUSH_TO_CLIENT();
+    if(remoteEditMode){
+        syncRemoteParams();
+        requestPushToClient();
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::encodeReplicatedState(std::vector<char>& records) const
+{
+    RemoteWarpBilinear::encodeReplicatedState(records);
+    
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        RemoteWarpJournal::encode(records, RemoteWarpJournal::RECORD_CORNER, i, &perspCorners[i].x, 2);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::replayJournalRecord(const RemoteWarpJournal::Record& record)
+{
+    if(record.type == RemoteWarpJournal::RECORD_CORNER){
+        if(record.index < 4 && record.values.size() >= 2){
+            perspCorners[record.index] = glm::vec2(record.values[0], record.values[1]);
+        }
+        transformDirty = true;
+    }else{
+        RemoteWarpBilinear::replayJournalRecord(record);
+    }
+}
+
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::journalCorners()
+{
+    auto & journal = getJournal();
+    for(size_t i = 0; i < 4; ++i){
+        journal.appendCorner(i, perspCorners[i]);
+    }
 }
 
 //--------------------------------------------------------------
 void RemoteWarpPerspectiveBilinear::reset(const glm::vec2 & scale, const glm::vec2 & offset)
 {
-    remoteCorners[0] = glm::vec2(0.0f, 0.0f);
-    remoteCorners[1] = glm::vec2(1.0f, 0.0f);
-    remoteCorners[2] = glm::vec2(1.0f, 1.0f);
-    remoteCorners[3] = glm::vec2(0.0f, 1.0f);
+    perspCorners[0] = glm::vec2(0.0f, 0.0f);
+    perspCorners[1] = glm::vec2(1.0f, 0.0f);
+    perspCorners[2] = glm::vec2(1.0f, 1.0f);
+    perspCorners[3] = glm::vec2(0.0f, 1.0f);
     
     RemoteWarpBilinear::reset();
 }
@@ -155,19 +225,15 @@ glm::vec2 RemoteWarpPerspectiveBilinear::getControlPoint(size_t index)
 //    if (this->isCorner(index))
 //    {
 //        // Perspective: simply return one of the corners.
-//        return remoteCorners[(this->convertIndex(index))];
+//        return perspCorners[(this->convertIndex(index))];
 //    }
 //    else
 //    {
         // Bilinear: transform control point from warped space to normalized screen space.
         auto s = glm::vec2(drawArea.width, drawArea.height);
         auto cp = RemoteWarpBase::getControlPoint(index) * s + drawArea.getTopLeft();
-        auto pt = getTransform() * glm::vec4(cp.x, cp.y, 0.0f, 1.0f);
-        
-        if (pt.w != 0) pt.w = 1.0f / pt.w;
-        pt *= pt.w;
         
-        return glm::vec2(pt.x, pt.y) / s;
+        return PerspectiveTransformation::project(getTransform(), cp) / s;
     //}
 }
 
@@ -178,19 +244,15 @@ void RemoteWarpPerspectiveBilinear::setControlPoint(size_t index, const glm::vec
 //    if (this->isCorner(index))
 //    {
 //        // Perspective: simply set the control point.
-//        remoteCorners[convertIndex(index)] = pos;
+//        perspCorners[convertIndex(index)] = pos;
 //    }
 //    else
 //    {
         // Bilinear:: transform control point from normalized screen space to warped space.
         auto s = glm::vec2(drawArea.width, drawArea.height);
         auto cp = pos * s;
-        auto pt = getTransformInverted() * glm::vec4(cp.x, cp.y, 0.0f, 1.0f);
         
-        if (pt.w != 0) pt.w = 1.0f / pt.w;
-        pt *= pt.w; 
-        
-        RemoteWarpBase::setControlPoint(index, glm::vec2(pt.x, pt.y) / s);
+        RemoteWarpBase::setControlPoint(index, PerspectiveTransformation::project(getTransformInverted(), cp) / s);
    // }
 }
 
@@ -237,19 +299,29 @@ void RemoteWarpPerspectiveBilinear::deselectControlPoint(size_t index)
 //--------------------------------------------------------------
 void RemoteWarpPerspectiveBilinear::rotateClockwise()
 {
-    std::swap(remoteCorners[3], remoteCorners[0]);
-    std::swap(remoteCorners[0], remoteCorners[1]);
-    std::swap(remoteCorners[1], remoteCorners[2]);
-    this->dirty = true;
+    RemoteGeometry::rotateCorners(perspCorners, true);
+    this->transformDirty = true;
+    this->remoteStale = true;
+    this->journalCorners();
 }
 
 //--------------------------------------------------------------
 void RemoteWarpPerspectiveBilinear::rotateCounterclockwise()
 {
-    std::swap(remoteCorners[1], remoteCorners[2]);
-    std::swap(remoteCorners[0], remoteCorners[1]);
-    std::swap(remoteCorners[3], remoteCorners[0]);
-    this->dirty = true;
+    RemoteGeometry::rotateCorners(perspCorners, false);
+    this->transformDirty = true;
+    this->remoteStale = true;
+    this->journalCorners();
+}
+
+//--------------------------------------------------------------
+bool RemoteWarpPerspectiveBilinear::setStreamedCorner(size_t index, const glm::vec2& pos)
+{
+    if (index >= 4) return false;
+    
+    perspCorners[index] = pos;
+    this->transformDirty = true;
+    return true;
 }
 
 //--------------------------------------------------------------
@@ -327,6 +399,11 @@ size_t RemoteWarpPerspectiveBilinear::convertIndex(size_t index) const
 
 void RemoteWarpPerspectiveBilinear::drawWarp(const ofTexture& tex)
 {
+    applyRemoteCommands();
+    if(!mapped){
+        flushPushToClient();
+    }
+    flushJournal();
     if(show){
         ofPushMatrix();
         ofTranslate(drawArea.x, drawArea.y);
@@ -346,7 +423,9 @@ void RemoteWarpPerspectiveBilinear::drawWarp(const ofTexture& tex)
 const glm::mat4 & RemoteWarpPerspectiveBilinear::getTransform()
 {
     // Calculate warp matrix.
-    if (this->dirty) {
+    if (this->dirty || this->transformDirty) {
+        RemoteWarpStats::Timer timer(*this->stats, RemoteWarpStats::STAGE_TRANSFORM);
+        
         // Update source size.
         this->srcPoints[1].x = windowSize.x;
         this->srcPoints[2].x = windowSize.x;
@@ -356,22 +435,30 @@ const glm::mat4 & RemoteWarpPerspectiveBilinear::getTransform()
         // Convert corners to actual destination pixels.
         for (int i = 0; i < 4; ++i)
         {
-            this->dstPoints[i] = remoteCorners[i] * this->windowSize;
+            this->dstPoints[i] = perspCorners[i] * this->windowSize;
         }
         
         // Calculate warp matrix.
         this->transform = PerspectiveTransformation::transform(this->srcPoints, this->dstPoints);
         this->transformInverted = glm::inverse(this->transform);
-        
+        this->transformDirty = false;
     }
     
     return this->transform;
 }
 
+//--------------------------------------------------------------
+void RemoteWarpPerspectiveBilinear::update()
+{
+    // Before the mesh, requesting it clears dirty.
+    this->getTransform();
+    RemoteWarpBilinear::update();
+}
+
 //--------------------------------------------------------------
 const glm::mat4 & RemoteWarpPerspectiveBilinear::getTransformInverted()
 {
-    if (this->dirty)
+    if (this->dirty || this->transformDirty)
     {
         this->getTransform();
     }
@@ -14,8 +14,8 @@ public:
     RemoteWarpPerspectiveBilinear(const std::string& name, const WarpSettings& settings);
     virtual ~RemoteWarpPerspectiveBilinear();
     
-    virtual void serialize(nlohmann::json & json) override;
-    virtual void deserialize(const nlohmann::json & json) override;
+    virtual void serialize(WarpRecord & record) const override;
+    virtual void deserialize(const WarpRecord & record) override;
     
     const glm::mat4 & getTransform();
     const glm::mat4 & getTransformInverted();
@@ -37,10 +37,15 @@ public:
     virtual void rotateClockwise() override;
     virtual void rotateCounterclockwise() override;
     
+    //! set one of the perspective corners, only the transform is recomputed
+    virtual bool setStreamedCorner(size_t index, const glm::vec2& pos) override;
+    
     virtual bool handleCursorDown(const glm::vec2 & pos) override;
     virtual bool handleCursorDrag(const glm::vec2 & pos) override;
         
     virtual void drawWarp(const ofTexture& tex)override;
+    //! compute the transform and the bilinear mesh
+    virtual void update() override;
     
 protected:
     
@@ -56,14 +61,28 @@ protected:
     size_t convertIndex(size_t index) const;
     
     virtual void handleRemoteUpdate(RemoteUIServerCallBackArg & arg)override;
+    virtual void applyCommand(const RemoteWarpCommand & command)override;
+    virtual void syncRemoteParams()override;
+    
+    virtual void encodeReplicatedState(std::vector<char>& records) const override;
+    virtual void replayJournalRecord(const RemoteWarpJournal::Record& record)override;
+    void journalCorners();
         
     glm::vec2 srcPoints[4];
     glm::vec2 dstPoints[4];
     
     glm::mat4 transform;
     glm::mat4 transformInverted;
+    //! set when the corners moved but the bilinear mesh is still valid
+    bool transformDirty{true};
     glm::vec2 perspSize;
         
-    glm::vec2 remoteCorners[4];
+    //! perspective corners in normalized window coordinates
+    glm::vec2 perspCorners[4];
+    //remoteUI, x and y of every corner
+    RemoteShadow<float> remoteCorners[4][2];
+    
+    //! copy perspCorners into the shadows shared with RemoteUI
+    void syncRemoteCorners();
     
 };
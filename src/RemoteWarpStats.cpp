@@ -0,0 +1,61 @@
+//
+//  RemoteWarpStats.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteWarpStats.h"
+
+#include <algorithm>
+
+void RemoteWarpStats::addSample(Stage stage, uint32_t micros)
+{
+    // One writer per stage, the release publishes the sample with the count.
+    auto & ring = rings[stage];
+    auto written = ring.written.load(std::memory_order_relaxed);
+    ring.samples[written % sWindow].store(micros, std::memory_order_relaxed);
+    ring.written.store(written + 1, std::memory_order_release);
+}
+
+RemoteWarpStats::Summary RemoteWarpStats::summarize(Stage stage) const
+{
+    const auto & ring = rings[stage];
+    uint32_t count = ring.written.load(std::memory_order_acquire);
+    if(count > sWindow) count = sWindow;
+
+    // A sample overwritten while copying only mixes in a newer timing.
+    std::array<uint32_t, sWindow> samples;
+    for(uint32_t i = 0; i < count; ++i){
+        samples[i] = ring.samples[i].load(std::memory_order_relaxed);
+    }
+
+    Summary summary;
+    summary.samples = count;
+    if(count == 0) return summary;
+
+    auto end = samples.begin() + count;
+    std::sort(samples.begin(), end);
+    summary.p50 = samples[(count - 1) / 2];
+    summary.p99 = samples[(count - 1) * 99 / 100];
+    summary.max = samples[count - 1];
+    return summary;
+}
+
+RemoteWarpStats::Counters RemoteWarpStats::takeCounters()
+{
+    auto taken = counters;
+    counters = Counters();
+    return taken;
+}
+
+const char* RemoteWarpStats::getStageName(Stage stage)
+{
+    switch(stage){
+        case STAGE_BUILD_MESH: return "build mesh";
+        case STAGE_UPDATE_MESH: return "update mesh";
+        case STAGE_UPLOAD: return "upload";
+        case STAGE_TRANSFORM: return "transform";
+        case STAGE_DRAW_TEXTURE: return "draw texture";
+        case STAGE_DRAW_CONTROLS: return "draw controls";
+        default: return "unknown";
+    }
+}
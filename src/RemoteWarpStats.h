@@ -0,0 +1,94 @@
+//
+//  RemoteWarpStats.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "RemoteTrace.h"
+
+//! rolling timings of the stages a warp goes through, and counts of what it rebuilt and uploaded.
+//!
+//! every stage keeps its last sWindow samples in a lock-free ring. a stage may be timed on any thread, but only on one at
+//! a time (mesh builds run on the thread pool, draws on the render thread), summaries can be taken from any thread.
+//! draw stages measure the time spent issuing GL calls on the CPU, not GPU time.
+class RemoteWarpStats {
+public:
+
+    enum Stage {
+        //! building a whole bilinear mesh
+        STAGE_BUILD_MESH = 0,
+        //! recomputing the vertices around moved control points
+        STAGE_UPDATE_MESH,
+        //! uploading a finished mesh to the vbo
+        STAGE_UPLOAD,
+        //! computing a perspective transform
+        STAGE_TRANSFORM,
+        STAGE_DRAW_TEXTURE,
+        STAGE_DRAW_CONTROLS,
+        NUM_STAGES
+    };
+
+    //! times a stage from construction to destruction, and traces it as a span named after the stage
+    class Timer {
+    public:
+        Timer(RemoteWarpStats& stats, Stage stage) : stats(stats), stage(stage), span(getStageName(stage), stats.getTraceName()), start(std::chrono::steady_clock::now()) {}
+        ~Timer(){ stats.addSample(stage, std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count()); }
+    private:
+        RemoteWarpStats& stats;
+        Stage stage;
+        RemoteTrace::Span span;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    //! timings of a stage over the samples in its ring, in microseconds
+    struct Summary {
+        uint32_t samples{0};
+        uint32_t p50{0};
+        uint32_t p99{0};
+        uint32_t max{0};
+    };
+
+    //! render thread: counted since the last takeCounters
+    struct Counters {
+        uint32_t rebuilds{0};
+        uint32_t updates{0};
+        uint32_t uploads{0};
+        uint64_t verticesUploaded{0};
+        uint64_t bytesUploaded{0};
+    };
+
+    void addSample(Stage stage, uint32_t micros);
+    Summary summarize(Stage stage) const;
+
+    inline void countRebuild(){ ++counters.rebuilds; }
+    inline void countUpdate(){ ++counters.updates; }
+    inline void countUpload(size_t vertices, size_t bytes){ ++counters.uploads; counters.verticesUploaded += vertices; counters.bytesUploaded += bytes; }
+    //! return the counters and start counting from 0
+    Counters takeCounters();
+
+    static const char* getStageName(Stage stage);
+
+    //! the warp's name as the detail of traced spans, from RemoteTrace::intern
+    inline void setTraceName(const char* name){ traceName = name; }
+    inline const char* getTraceName() const { return traceName; }
+
+    //! samples kept per stage
+    static const uint32_t sWindow = 128;
+
+private:
+
+    struct Ring {
+        std::array<std::atomic<uint32_t>, sWindow> samples{};
+        //! samples written so far, the next one goes to written % sWindow
+        std::atomic<uint32_t> written{0};
+    };
+    std::array<Ring, NUM_STAGES> rings;
+    Counters counters;
+    const char* traceName{nullptr};
+};
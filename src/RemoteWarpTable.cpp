@@ -0,0 +1,85 @@
+//
+//  RemoteWarpTable.cpp
+//  RemoteProjectionMapper
+//
+
+#include "RemoteWarpTable.h"
+#include "RemoteWarpBase.h"
+
+RemoteWarpHandle RemoteWarpTable::insert(std::shared_ptr<RemoteWarpBase> warp)
+{
+    if(!warp || names.count(warp->getName())) return RemoteWarpHandle();
+
+    uint32_t slot;
+    if(!freeSlots.empty()){
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    }else{
+        slot = slots.size();
+        slots.emplace_back();
+    }
+    slots[slot].position = warps.size();
+    names.emplace(warp->getName(), slot);
+    positionSlots.push_back(slot);
+    warp->setMapped(true);
+    warps.push_back(std::move(warp));
+    return RemoteWarpHandle{slot, slots[slot].generation};
+}
+
+bool RemoteWarpTable::remove(RemoteWarpHandle handle)
+{
+    auto position = getPosition(handle);
+    if(position == warps.size()) return false;
+
+    names.erase(warps[position]->getName());
+    warps[position]->setMapped(false);
+    warps.erase(warps.begin() + position);
+    positionSlots.erase(positionSlots.begin() + position);
+    // Keep the draw order, the warps after it move up one.
+    for(auto i = position; i < positionSlots.size(); ++i){
+        slots[positionSlots[i]].position = i;
+    }
+
+    auto & slot = slots[handle.index];
+    slot.position = npos;
+    ++slot.generation;
+    freeSlots.push_back(handle.index);
+    return true;
+}
+
+void RemoteWarpTable::clear()
+{
+    for(auto slot : positionSlots){
+        slots[slot].position = npos;
+        ++slots[slot].generation;
+        freeSlots.push_back(slot);
+    }
+    for(auto & warp : warps){
+        warp->setMapped(false);
+    }
+    warps.clear();
+    positionSlots.clear();
+    names.clear();
+}
+
+RemoteWarpHandle RemoteWarpTable::find(const std::string& name) const
+{
+    auto found = names.find(name);
+    if(found == names.end()) return RemoteWarpHandle();
+    return RemoteWarpHandle{found->second, slots[found->second].generation};
+}
+
+const std::shared_ptr<RemoteWarpBase>& RemoteWarpTable::get(RemoteWarpHandle handle) const
+{
+    static const std::shared_ptr<RemoteWarpBase> none;
+    auto position = getPosition(handle);
+    return position < warps.size() ? warps[position] : none;
+}
+
+size_t RemoteWarpTable::getPosition(RemoteWarpHandle handle) const
+{
+    if(handle.index >= slots.size()) return warps.size();
+    const auto & slot = slots[handle.index];
+    if(slot.generation != handle.generation || slot.position == npos) return warps.size();
+    return slot.position;
+}
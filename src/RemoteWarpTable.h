@@ -0,0 +1,75 @@
+//
+//  RemoteWarpTable.h
+//  RemoteProjectionMapper
+//
+
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class RemoteWarpBase;
+
+//! refers to a warp in a RemoteWarpTable. it keeps referring to the same warp while others are added and removed,
+//! once its warp is removed it doesn't resolve anymore, not even to a warp added later in the same slot.
+struct RemoteWarpHandle {
+    uint32_t index{std::numeric_limits<uint32_t>::max()};
+    uint32_t generation{0};
+
+    inline bool isNull() const { return index == std::numeric_limits<uint32_t>::max(); }
+    inline bool operator==(const RemoteWarpHandle& other) const { return index == other.index && generation == other.generation; }
+    inline bool operator!=(const RemoteWarpHandle& other) const { return !(*this == other); }
+};
+
+//! the warps of a mapper, in the order they were added. warps are kept in one contiguous array for iteration,
+//! looked up by name through a hash map and by handle through a slot array, both without searching.
+//! warps are marked as mapped while they are in a table, see RemoteWarpBase::setMapped.
+class RemoteWarpTable {
+public:
+
+    using Warps = std::vector<std::shared_ptr<RemoteWarpBase>>;
+
+    //! add a warp at the end, names have to be unique: returns a null handle if a warp of the same name is in the table
+    RemoteWarpHandle insert(std::shared_ptr<RemoteWarpBase> warp);
+    //! remove a warp, the ones after it keep their order. returns false if handle doesn't resolve
+    bool remove(RemoteWarpHandle handle);
+    void clear();
+
+    //! handle of the warp called name, a null handle if there is none
+    RemoteWarpHandle find(const std::string& name) const;
+    //! the warp handle refers to, nullptr if it was removed
+    const std::shared_ptr<RemoteWarpBase>& get(RemoteWarpHandle handle) const;
+    inline const std::shared_ptr<RemoteWarpBase>& get(const std::string& name) const { return get(find(name)); }
+    //! position of the warp in the table, size() if it was removed
+    size_t getPosition(RemoteWarpHandle handle) const;
+    //! handle of the warp at a position
+    inline RemoteWarpHandle getHandle(size_t position) const { return RemoteWarpHandle{positionSlots[position], slots[positionSlots[position]].generation}; }
+
+    inline size_t size() const { return warps.size(); }
+    inline bool empty() const { return warps.empty(); }
+    inline const std::shared_ptr<RemoteWarpBase>& operator[](size_t position) const { return warps[position]; }
+    inline const std::shared_ptr<RemoteWarpBase>& back() const { return warps.back(); }
+    inline Warps::const_iterator begin() const { return warps.begin(); }
+    inline Warps::const_iterator end() const { return warps.end(); }
+
+private:
+
+    struct Slot {
+        //! bumped on every removal, handles of the removed warp stop matching
+        uint32_t generation{0};
+        //! position of the warp, npos while the slot is free
+        uint32_t position{npos};
+    };
+    static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+    Warps warps;
+    //! slot of the warp at each position
+    std::vector<uint32_t> positionSlots;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<std::string, uint32_t> names;
+};
@@ -7,12 +7,19 @@
 
 #include "ofxRemoteProjectionMapper.h"
 
+std::string ofxRemoteProjectionMapper::sMappingFilename = "ProjectionMapping.json";
+
 ofxRemoteProjectionMapper::ofxRemoteProjectionMapper():
     saveLocation(ofToDataPath("mapping"))
 {}
 
 ofxRemoteProjectionMapper::~ofxRemoteProjectionMapper()
 {
+    watcher.stop();
+    gridChannel.close();
+    streamReceiver.stop();
+    disableReplication();
+    statsStream.close();
     saveWarps();
 }
 
@@ -56,8 +63,8 @@ void ofxRemoteProjectionMapper::handleKeyPress(ofKeyEventArgs& args)
             selectedMappings.clear();
             selectionArea = ofRectangle(0,0,0,0);
         }else{
-            if(focusedMappingIndex >= 0 && focusedMappingIndex < mappings.size())
-                mappings[focusedMappingIndex]->deselectControlPoint(prevSelectedIndex);
+            if(auto & focused = mappings.get(focusedMapping))
+                focused->deselectControlPoint(prevSelectedIndex);
         }
     }
 }
@@ -69,15 +76,31 @@ void ofxRemoteProjectionMapper::handleKeyReleased(ofKeyEventArgs& args)
 
 std::shared_ptr<RemoteWarpBase> ofxRemoteProjectionMapper::getWarp(const std::string& name)
 {
-    auto found = std::find_if( mappings.begin(), mappings.end(), [&name](const std::shared_ptr<RemoteWarpBase>& warp){
-        return warp->getName() == name;
-    });
-    if(found != mappings.end()){
-        return *found;
-    }else{
+    auto & found = mappings.get(name);
+    if(!found){
         ofLogWarning() << "couldn't find mapping with name " << name;
-        return nullptr;
     }
+    return found;
+}
+
+RemoteWarpHandle ofxRemoteProjectionMapper::addWarp(const std::shared_ptr<RemoteWarpBase>& warp)
+{
+    auto handle = mappings.insert(warp);
+    if(!handle.isNull()){
+        warp->share();
+    }
+    return handle;
+}
+
+bool ofxRemoteProjectionMapper::removeWarp(RemoteWarpHandle handle)
+{
+    auto warp = mappings.get(handle);
+    if(!warp) return false;
+    
+    warp->unshare();
+    mappings.remove(handle);
+    selectedMappings.erase(std::remove(selectedMappings.begin(), selectedMappings.end(), handle), selectedMappings.end());
+    return true;
 }
 
 void ofxRemoteProjectionMapper::toggleEditing()
@@ -87,9 +110,27 @@ void ofxRemoteProjectionMapper::toggleEditing()
     }
 }
 
+void ofxRemoteProjectionMapper::update()
+{
+    RemoteTrace::Span span("update");
+    applyEdits();
+    RemoteThreadPool::getShared().parallelFor(mappings.size(), [this](size_t i){
+        RemoteTrace::Span span("update warp", mappings[i]->getTraceName());
+        mappings[i]->update();
+    });
+    updated = true;
+}
+
 void ofxRemoteProjectionMapper::drawWarps(const ofTexture& tex)
 {
+    RemoteTrace::Span span("draw");
+    if(!updated){
+        applyEdits();
+    }
+    updated = false;
+    
     for(auto & warp: mappings){
+        RemoteTrace::Span span("draw warp", warp->getTraceName());
         warp->drawWarp(tex);
     }
     
@@ -104,22 +145,56 @@ void ofxRemoteProjectionMapper::drawWarps(const ofTexture& tex)
         ofPopStyle();
     }
     
+    if(statsStream.frame()){
+        for(auto & warp: mappings){
+            statsStream.send(warp->getName(), warp->getStats());
+        }
+    }
+    
+    sampleMemory();
+    
+    // Temporaries of this frame are done with.
+    getFrameArena().reset();
 }
 
-void ofxRemoteProjectionMapper::selectControlPoints(const ofRectangle& area)
+void ofxRemoteProjectionMapper::applyEdits()
 {
-    std::map<size_t, std::vector<size_t>> selectedWarps;
-    for (int i = mappings.size() - 1; i >= 0; --i){
-        auto selections = mappings[i]->getControlPointsInArea(area);
-        if(!selections.empty()){
-            selectedWarps.emplace( i, std::move(selections) );
-        }
+    RemoteTrace::Span span("apply edits");
+    {
+        RemoteTrace::Span span("remote commands");
+        applyRemoteCommands();
     }
     
-    for(auto & found: selectedWarps){
-        selectedMappings.push_back(found.first);
-        for(auto & ind : found.second){
-            mappings[found.first]->selectControlPoint(ind);
+    if(streamReceiver.isRunning()){
+        RemoteTrace::Span span("streamed updates");
+        applyStreamedUpdates();
+    }
+    
+    if(replication.getRole() != RemoteReplication::ROLE_NONE){
+        RemoteTrace::Span span("replication");
+        updateReplication();
+    }
+    
+    if(watcher.isRunning()){
+        RemoteTrace::Span span("hot reload");
+        applyReloadedFiles();
+    }
+    
+    if(gridChannel.isSetup()){
+        RemoteTrace::Span span("grid channel");
+        updateGridChannel();
+    }
+    
+    // Everything that changed this frame reaches the client in a single push.
+    RemoteTrace::Span pushSpan("push to client");
+    RemoteWarpBase::flushPushToClient();
+}
+
+void ofxRemoteProjectionMapper::selectControlPoints(const ofRectangle& area)
+{
+    for (size_t i = 0; i < mappings.size(); ++i){
+        if(mappings[i]->selectControlPointsInArea(area)){
+            selectedMappings.push_back(mappings.getHandle(i));
         }
     }
 }
@@ -127,7 +202,7 @@ void ofxRemoteProjectionMapper::selectControlPoints(const ofRectangle& area)
 //--------------------------------------------------------------
 void ofxRemoteProjectionMapper::selectClosestControlPoint(int x, int y)
 {
-    size_t warpIdx = -1;
+    RemoteWarpHandle warpHandle;
     size_t pointIdx = -1;
     auto distance = std::numeric_limits<float>::max();
     
@@ -140,19 +215,19 @@ void ofxRemoteProjectionMapper::selectClosestControlPoint(int x, int y)
         {
             distance = candidate;
             pointIdx = idx;
-            warpIdx = i;
+            warpHandle = mappings.getHandle(i);
         }
     }
     
-    if(warpIdx == focusedMappingIndex && prevSelectedIndex == pointIdx )
+    if(warpHandle == focusedMapping && prevSelectedIndex == pointIdx )
         return;
     
-    if(focusedMappingIndex < mappings.size() && focusedMappingIndex >=0)
-        mappings[focusedMappingIndex]->deselectControlPoint(prevSelectedIndex);
-    if(warpIdx < mappings.size() && warpIdx >= 0 )
-        mappings[warpIdx]->selectControlPoint(pointIdx);
+    if(auto & focused = mappings.get(focusedMapping))
+        focused->deselectControlPoint(prevSelectedIndex);
+    if(auto & closest = mappings.get(warpHandle))
+        closest->selectControlPoint(pointIdx);
     
-    focusedMappingIndex = warpIdx;
+    focusedMapping = warpHandle;
     prevSelectedIndex = pointIdx;
 }
 
@@ -162,16 +237,16 @@ void ofxRemoteProjectionMapper::handleMouseDown(ofMouseEventArgs& args)
         // Find and select closest control point.
         selectClosestControlPoint(args.x,args.y);
         
-        if (focusedMappingIndex < mappings.size())
+        if (auto & focused = mappings.get(focusedMapping))
         {
-            mappings[focusedMappingIndex]->handleCursorDown(args);
+            focused->handleCursorDown(args);
         }
     }else{
         if(!selectionAreaSet){
             selectionArea = ofRectangle(args, args);
         }else{
             for(auto & selected: selectedMappings){
-                mappings[selected]->handleCursorDown(args);
+                mappings.get(selected)->handleCursorDown(args);
             }
         }
     }
@@ -191,13 +266,13 @@ void ofxRemoteProjectionMapper::handleMouseDrag(ofMouseEventArgs& args)
             selectionArea = ofRectangle( selectionArea.getTopLeft(), args );
         }else{
             for(auto & selected: selectedMappings){
-                mappings[selected]->handleCursorDrag(args);
+                mappings.get(selected)->handleCursorDrag(args);
             }
         }
     }else{
-        if (focusedMappingIndex < mappings.size())
+        if (auto & focused = mappings.get(focusedMapping))
         {
-            mappings[focusedMappingIndex]->handleCursorDrag(args);
+            focused->handleCursorDrag(args);
         }
     }
 }
@@ -217,76 +292,69 @@ void ofxRemoteProjectionMapper::handleWindowResize(int width, int height)
     }
 }
 
-void ofxRemoteProjectionMapper::createPerspectiveWarp()
+void ofxRemoteProjectionMapper::createPerspectiveWarp(const std::string& name)
 {
-    mappings.emplace_back(std::make_shared<RemoteWarpPerspective>(nextWarpName,
-                                                                  WarpSettings()
-                                                                  .srcSize(contentSize.x, contentSize.y)
-                                                                  .saveLocation(saveLocation)
-                                                                  .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
-                                                                  .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
-                                                                  ));
-    lastWarpName = nextWarpName;
+    addWarp(std::make_shared<RemoteWarpPerspective>(name,
+                                                            WarpSettings()
+                                                            .srcSize(contentSize.x, contentSize.y)
+                                                            .saveLocation(saveLocation)
+                                                            .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
+                                                            .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
+                                                            ));
+    lastWarpName = name;
     saveWarps();
 }
 
-void ofxRemoteProjectionMapper::createBiliearWarp()
+void ofxRemoteProjectionMapper::createBiliearWarp(const std::string& name)
 {
-    mappings.emplace_back(std::make_shared<RemoteWarpBilinear>(nextWarpName,
-                                                               WarpSettings()
-                                                               .srcSize(contentSize.x, contentSize.y)
-                                                               .saveLocation(saveLocation)
-                                                               .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
-                                                               .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
-                                                               ));
-    lastWarpName = nextWarpName;
+    addWarp(std::make_shared<RemoteWarpBilinear>(name,
+                                                         WarpSettings()
+                                                         .srcSize(contentSize.x, contentSize.y)
+                                                         .saveLocation(saveLocation)
+                                                         .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
+                                                         .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
+                                                         ));
+    lastWarpName = name;
     saveWarps();
 }
 
-void ofxRemoteProjectionMapper::createPerspectiveBilinearWarp()
+void ofxRemoteProjectionMapper::createPerspectiveBilinearWarp(const std::string& name)
 {
-    mappings.emplace_back(std::make_shared<RemoteWarpPerspectiveBilinear>(nextWarpName,
-                                                                          WarpSettings()
-                                                                          .srcSize(contentSize.x, contentSize.y)
-                                                                          .saveLocation(saveLocation)
-                                                                          .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
-                                                                          .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
-                                                                          ));
-    lastWarpName = nextWarpName;
+    addWarp(std::make_shared<RemoteWarpPerspectiveBilinear>(name,
+                                                                    WarpSettings()
+                                                                    .srcSize(contentSize.x, contentSize.y)
+                                                                    .saveLocation(saveLocation)
+                                                                    .srcArea(ofRectangle(0,0,contentSize.x,contentSize.y))
+                                                                    .drawArea(ofRectangle(0,0,ofGetWidth(),ofGetHeight()))
+                                                                    ));
+    lastWarpName = name;
     saveWarps();
 }
 
 void ofxRemoteProjectionMapper::handleRemoteUpdate(RemoteUIServerCallBackArg & arg)
 {
+    RemoteTrace::Span span("remote event");
     switch (arg.action) {
         case CLIENT_UPDATED_PARAM:
             if(arg.group == "Mapper"){
-                if(arg.paramName == "next warp name"){
-                    nextWarpName = arg.param.getValueAsString();
-                }else if(arg.paramName == "create persp warp"){
-                    if(nextWarpName == lastWarpName)
-                        return;
-                    if(doCreatePerspectiveWarp){
-                        createPerspectiveWarp();
-                        doCreatePerspectiveWarp = false;
-                        RUI_PUSH_TO_CLIENT();
-                    }
-                }else if(arg.paramName == "create bilinear warp"){
-                    if(nextWarpName == lastWarpName)
-                        return;
-                    if(doCreateBilinearWarp){
-                        createBiliearWarp();
-                        doCreateBilinearWarp = false;
-                        RUI_PUSH_TO_CLIENT();
-                    }
-                }else if(arg.paramName == "create perp bilinear warp"){
-                    if(nextWarpName == lastWarpName)
-                        return;
-                    if(doCreatePerspectiveBilinearWarp){
-                        createPerspectiveBilinearWarp();
-                        doCreatePerspectiveBilinearWarp = false;
-                        RUI_PUSH_TO_CLIENT();
+                CreateWarpCommand command;
+                command.name = nextWarpName;
+                if(arg.paramName == "create persp warp" && doCreatePerspectiveWarp){
+                    command.type = WarpSettings::TYPE_PERSPECTIVE;
+                    doCreatePerspectiveWarp = false;
+                }else if(arg.paramName == "create bilinear warp" && doCreateBilinearWarp){
+                    command.type = WarpSettings::TYPE_BILINEAR;
+                    doCreateBilinearWarp = false;
+                }else if(arg.paramName == "create perp bilinear warp" && doCreatePerspectiveBilinearWarp){
+                    command.type = WarpSettings::TYPE_PERSPECTIVE_BILINEAR;
+                    doCreatePerspectiveBilinearWarp = false;
+                }
+                if(command.type != WarpSettings::TYPE_UNKNOWN){
+                    // Warps own GL resources, they are created by the render thread.
+                    if(!createCommands.push(command)){
+                        ofLogWarning("RemoteProjectionMapper") << "create queue is full, dropping " << command.name;
                     }
+                    RemoteWarpBase::requestPushToClient();
                 }
             }
             break;
@@ -294,118 +362,411 @@ void ofxRemoteProjectionMapper::handleRemoteUpdate(RemoteUIServerCallBackArg & a
     }
 }
 
+void ofxRemoteProjectionMapper::applyRemoteCommands()
+{
+    while(createCommands.pop(createCommand)){
+        // Warp names are unique, a second one would share its params under the same names.
+        if(createCommand.name == lastWarpName || !mappings.find(createCommand.name).isNull())
+            continue;
+        switch(createCommand.type){
+            case WarpSettings::TYPE_PERSPECTIVE:
+                createPerspectiveWarp(createCommand.name);
+                break;
+            case WarpSettings::TYPE_BILINEAR:
+                createBiliearWarp(createCommand.name);
+                break;
+            case WarpSettings::TYPE_PERSPECTIVE_BILINEAR:
+                createPerspectiveBilinearWarp(createCommand.name);
+                break;
+            default:
+                break;
+        }
+    }
+    
+    for(auto & warp: mappings){
+        warp->applyRemoteCommands();
+    }
+}
+
 void ofxRemoteProjectionMapper::loadWarps()
 {
-    auto infile = ofFile(saveLocation/"ProjectionMapping.json", ofFile::ReadOnly);
+    RemoteTrace::Span span("load warps");
+    auto infile = ofFile(saveLocation/sMappingFilename, ofFile::ReadOnly);
     if (!infile.exists())
     {
         ofLogWarning("RemoteProjectionMapper::loadConfig") << "File not found at path " << saveLocation;
-        return false;
+        return;
     }
     
-    nlohmann::json json;
-    infile >> json;
+    auto buffer = infile.readToBuffer();
+    mappingHash = RemoteMappingWatcher::hashContents(buffer.getText());
+    
+    if(!mappingReader.read(buffer.getData(), buffer.size(), mappingRecord)){
+        ofLogError("RemoteProjectionMapper::loadConfig") << "couldn't parse " << saveLocation/sMappingFilename << ": " << mappingReader.getError();
+        return;
+    }
     
-    for (const auto & warpJson : json["warps"])
+    for (size_t i = 0; i < mappingRecord.numWarps; ++i)
     {
-        std::string name = warpJson["name"];
-        int type = warpJson["type"];
-        
-        glm::ivec2 srcSize;
-        std::istringstream iss;
-        iss.str(warpJson["srcSize"]);
-        iss >> srcSize;
-        
-        auto& srcAreaJson =  warpJson["srcArea"];
-        ofRectangle srcArea(srcAreaJson["x"].get<float>(),
-                            srcAreaJson["y"].get<float>(),
-                            srcAreaJson["w"].get<float>(),
-                            srcAreaJson["h"].get<float>());
-        
-        auto& drawAreaJson =  warpJson["drawArea"];
-        ofRectangle drawArea(drawAreaJson["x"].get<float>(),
-                            drawAreaJson["y"].get<float>(),
-                            drawAreaJson["w"].get<float>(),
-                            drawAreaJson["h"].get<float>());
-        
-        switch(type){
-            case WarpSettings::TYPE_PERSPECTIVE:
-            {
-                mappings.emplace_back(std::make_shared<RemoteWarpPerspective>(name,
-                                                                              WarpSettings()
-                                                                              .saveLocation(saveLocation)
-                                                                              .srcSize(srcSize.x, srcSize.y)
-                                                                              .drawArea(drawArea)
-                                                                              .srcArea(srcArea)
-                                                                              ));
-            }break;
-            case WarpSettings::TYPE_BILINEAR:
-            {
-                mappings.emplace_back(std::make_shared<RemoteWarpBilinear>(name,
-                                                                              WarpSettings()
-                                                                              .saveLocation(saveLocation)
-                                                                              .srcSize(srcSize.x, srcSize.y)
-                                                                              .drawArea(drawArea)
-                                                                              .srcArea(srcArea)
-                                                                              ));
-            }break;
-            case WarpSettings::TYPE_PERSPECTIVE_BILINEAR:
-            {
-                mappings.emplace_back(std::make_shared<RemoteWarpPerspectiveBilinear>(name,
-                                                                              WarpSettings()
-                                                                              .saveLocation(saveLocation)
-                                                                              .srcSize(srcSize.x, srcSize.y)
-                                                                              .drawArea(drawArea)
-                                                                              .srcArea(srcArea)
-                                                                              ));
-               
-            }break;
-            default:
-                ofLogError() << "RemoteProjectionMapper::loadConfig | UNKNOWN WARP TYPE";
-                break;
-        }
-        mappings.back()->deserialize(warpJson["warp"]);
-        mappings.back()->loadPreset(warpJson["warp"]["preset"]);
+        loadWarp(mappingRecord.warps[i]);
     }
     
 }
 
-void ofxRemoteProjectionMapper::saveWarps()
+std::shared_ptr<RemoteWarpBase> ofxRemoteProjectionMapper::loadWarp(const MappingRecord::Entry& entry)
 {
-    nlohmann::json out;
+    const auto & name = entry.name;
+    const auto & srcSize = entry.srcSize;
+    const auto & srcArea = entry.srcArea;
+    const auto & drawArea = entry.drawArea;
     
-    auto& warps = out["warps"];
+    if(auto & existing = mappings.get(name)){
+        ofLogWarning("RemoteProjectionMapper::loadConfig") << "a warp called " << name << " exists already";
+        return existing;
+    }
     
+    std::shared_ptr<RemoteWarpBase> warp;
+    switch(entry.type){
+        case WarpSettings::TYPE_PERSPECTIVE:
+        {
+            warp = std::make_shared<RemoteWarpPerspective>(name,
+                                                           WarpSettings()
+                                                           .saveLocation(saveLocation)
+                                                           .srcSize(srcSize.x, srcSize.y)
+                                                           .drawArea(drawArea)
+                                                           .srcArea(srcArea)
+                                                           );
+        }break;
+        case WarpSettings::TYPE_BILINEAR:
+        {
+            warp = std::make_shared<RemoteWarpBilinear>(name,
+                                                        WarpSettings()
+                                                        .saveLocation(saveLocation)
+                                                        .srcSize(srcSize.x, srcSize.y)
+                                                        .drawArea(drawArea)
+                                                        .srcArea(srcArea)
+                                                        );
+        }break;
+        case WarpSettings::TYPE_PERSPECTIVE_BILINEAR:
+        {
+            warp = std::make_shared<RemoteWarpPerspectiveBilinear>(name,
+                                                                   WarpSettings()
+                                                                   .saveLocation(saveLocation)
+                                                                   .srcSize(srcSize.x, srcSize.y)
+                                                                   .drawArea(drawArea)
+                                                                   .srcArea(srcArea)
+                                                                   );
+           
+        }break;
+        default:
+            ofLogError() << "RemoteProjectionMapper::loadConfig | UNKNOWN WARP TYPE";
+            return nullptr;
+    }
+    addWarp(warp);
+    warp->deserialize(entry.warp);
+    warp->loadPreset(entry.warp.preset);
+    return warp;
+}
+
+void ofxRemoteProjectionMapper::saveWarps()
+{
+    RemoteTrace::Span span("save warps");
+    mappingRecord.clear();
     for(auto & mapping: mappings){
-        nlohmann::json warp;
-        warp["name"] = mapping->getName();
-        warp["type"] = mapping->getType();
+        auto & entry = mappingRecord.addWarp();
+        entry.name = mapping->getName();
+        entry.type = mapping->getType();
+        entry.srcSize = mapping->getSrcSize();
+        entry.srcArea = mapping->getSrcArea();
+        entry.drawArea = mapping->getDrawArea();
+        mapping->serialize(entry.warp);
+    }
+    
+    mappingWriter.write(mappingRecord);
+    const auto & text = mappingWriter.str();
+    mappingHash = RemoteMappingWatcher::hashContents(text);
+    auto outFile = ofFile(saveLocation/sMappingFilename, ofFile::WriteOnly);
+    outFile.write(text.data(), text.size());
+}
+
+void ofxRemoteProjectionMapper::enableHotReload(bool forcePolling)
+{
+    watcher.setPolling(forcePolling);
+    watcher.start(saveLocation, sMappingFilename, RemoteWarpBase::getSaveFilename());
+}
+
+void ofxRemoteProjectionMapper::disableHotReload()
+{
+    watcher.stop();
+}
+
+void ofxRemoteProjectionMapper::enableGridChannel(const std::string& host, int sendPort, int receivePort)
+{
+    gridChannel.setup(host, sendPort, receivePort);
+}
+
+void ofxRemoteProjectionMapper::disableGridChannel()
+{
+    gridChannel.close();
+}
+
+void ofxRemoteProjectionMapper::enableStreamInput(int port)
+{
+    streamReceiver.start(port);
+}
+
+void ofxRemoteProjectionMapper::disableStreamInput()
+{
+    streamReceiver.stop();
+}
+
+void ofxRemoteProjectionMapper::applyStreamedUpdates()
+{
+    for(auto & warp: mappings){
+        auto & slot = streamReceiver.getSlot(warp->getName());
+        auto state = slot.consume();
+        if(!state) continue;
+        
+        // Messages merged since the last frame carry newer versions than the one applied last.
+        if(state->cornersVersion > slot.appliedVersion){
+            for(size_t i = 0; i < 4; ++i){
+                warp->setStreamedCorner(i, state->corners[i]);
+            }
+        }
+        if(!state->points.empty()){
+            if(size_t(state->columns) == warp->getNumControlsX() && size_t(state->rows) == warp->getNumControlsY()){
+                for(size_t i = 0; i < state->points.size(); ++i){
+                    if(state->pointVersions[i] > slot.appliedVersion){
+                        warp->setStreamedControlPoint(i, state->points[i]);
+                    }
+                }
+                slot.mismatchReported = false;
+            }else if(!slot.mismatchReported){
+                ofLogWarning("ofxRemoteProjectionMapper::applyStreamedUpdates") << warp->getName() << " is streamed a " << state->columns << "x" << state->rows << " grid, expected " << warp->getNumControlsX() << "x" << warp->getNumControlsY();
+                slot.mismatchReported = true;
+            }
+        }
+        slot.appliedVersion = state->version;
+    }
+}
+
+void ofxRemoteProjectionMapper::enableReplicationLeader(const std::string& group, int port)
+{
+    disableReplication();
+    if(replication.setupLeader(group, port)){
+        replicationFrame = 0;
+    }
+}
+
+void ofxRemoteProjectionMapper::enableReplicationFollower(const std::string& group, int port)
+{
+    disableReplication();
+    replication.setupFollower(group, port);
+}
+
+void ofxRemoteProjectionMapper::enableStatsStream(const std::string& host, int port, float interval)
+{
+    statsStream.setup(host, port, interval);
+}
+
+void ofxRemoteProjectionMapper::disableStatsStream()
+{
+    statsStream.close();
+}
+
+void ofxRemoteProjectionMapper::startTrace()
+{
+    RemoteTrace::start();
+}
+
+void ofxRemoteProjectionMapper::stopTrace()
+{
+    RemoteTrace::stop();
+}
+
+bool ofxRemoteProjectionMapper::saveTrace(const std::filesystem::path& file)
+{
+    return RemoteTrace::save(file.is_absolute() ? file : saveLocation/file);
+}
+
+void ofxRemoteProjectionMapper::sampleMemory()
+{
+    RemoteWarpMemory total;
+    for(auto & warp: mappings){
+        warp->sampleMemory();
+        auto & memory = warp->getMemoryReport().current;
+        total += memory;
+        if(memory.sharedTopology){
+            total.texCoords -= memory.texCoords;
+            total.indices -= memory.indices;
+        }
+    }
+    
+    // Warps of the same resolution draw with the same topology, count every one once.
+    size_t texCoords, indices;
+    RemoteMeshTopology::getCachedBytes(texCoords, indices);
+    total.texCoords += texCoords;
+    total.indices += indices;
+    
+    total.journal += replicatedRecords.capacity() + scheduledPresets.capacity() * sizeof(ScheduledPreset);
+    total.caches += mappingRecord.getCapacityBytes() + mappingWriter.getCapacityBytes() + mappingReader.getCapacityBytes();
+    total.caches += RemoteWarpBase::getJsonCacheBytes() + getFrameArena().getCapacity();
+    memoryReport.sample(total);
+}
+
+void ofxRemoteProjectionMapper::resetMemoryPeaks()
+{
+    for(auto & warp: mappings){
+        warp->resetMemoryPeaks();
+    }
+    memoryReport.resetPeaks();
+}
+
+void ofxRemoteProjectionMapper::disableReplication()
+{
+    replication.close();
+    for(auto & warp: mappings){
+        warp->setReplicationLeader(false);
+    }
+    // Nothing is going to reach their frame anymore.
+    applyScheduledPresets(std::numeric_limits<uint64_t>::max());
+}
 
-        std::ostringstream oss;
-        oss << mapping->getSrcSize();
-        warp["srcSize"] = oss.str();
+void ofxRemoteProjectionMapper::updateReplication()
+{
+    replication.update();
+    
+    if(replication.getRole() == RemoteReplication::ROLE_LEADER){
+        for(auto & warp: mappings){
+            if(!warp->isReplicationLeader()){
+                warp->setReplicationLeader(true);
+            }
+        }
         
-        auto& srcArea =  warp["srcArea"];
-        srcArea["x"] = mapping->getSrcArea().x;
-        srcArea["y"] = mapping->getSrcArea().y;
-        srcArea["w"] = mapping->getSrcArea().width;
-        srcArea["h"] = mapping->getSrcArea().height;
-
-        auto& drawArea =  warp["drawArea"];
-        drawArea["x"] = mapping->getDrawArea().x;
-        drawArea["y"] = mapping->getDrawArea().y;
-        drawArea["w"] = mapping->getDrawArea().width;
-        drawArea["h"] = mapping->getDrawArea().height;
+        if(replication.takeResyncRequest()){
+            replication.sendBase();
+            for(auto & warp: mappings){
+                // Frame 0 switches right away, before the state that follows.
+                replication.sendPreset(warp->getName(), warp->getCurrentPreset(), RemoteReplication::Packet::PRESET_LOAD, 0);
+                warp->requestReplicatedState();
+            }
+        }
         
-        nlohmann::json serialized;
-        mapping->serialize(serialized);
-        warp["warp"] = serialized;
+        RemoteWarpCommand command;
+        for(auto & warp: mappings){
+            replicatedRecords.clear();
+            if(warp->takeReplicatedRecords(replicatedRecords)){
+                replication.sendRecords(warp->getName(), replicatedRecords);
+            }
+            while(warp->takePresetCommand(command)){
+                auto frame = replicationFrame + presetLatency;
+                auto action = RemoteReplication::Packet::PRESET_LOAD;
+                if(command.type == RemoteWarpCommand::COMMAND_SAVE_PRESET){
+                    action = RemoteReplication::Packet::PRESET_SAVE;
+                }else if(command.type == RemoteWarpCommand::COMMAND_DELETE_PRESET){
+                    action = RemoteReplication::Packet::PRESET_DELETE;
+                }
+                replication.sendPreset(warp->getName(), command.preset, action, frame);
+                scheduledPresets.push_back(ScheduledPreset{warp->getName(), command, frame});
+            }
+        }
         
-        warps.push_back(warp);
+        replication.sendFrame(replicationFrame);
+        applyScheduledPresets(replicationFrame);
+        ++replicationFrame;
+    }else{
+        while(replication.getNextPacket(replicationPacket)){
+            auto & found = mappings.get(replicationPacket.warpName);
+            if(!found) continue;
+            
+            if(replicationPacket.type == RemoteReplication::Packet::PACKET_DELTA){
+                found->applyReplicatedRecords(replicationPacket.records.data(), replicationPacket.records.size());
+            }else if(replicationPacket.type == RemoteReplication::Packet::PACKET_PRESET){
+                RemoteWarpCommand command;
+                switch (replicationPacket.action) {
+                    case RemoteReplication::Packet::PRESET_SAVE:
+                        command.type = RemoteWarpCommand::COMMAND_SAVE_PRESET;
+                        break;
+                    case RemoteReplication::Packet::PRESET_DELETE:
+                        command.type = RemoteWarpCommand::COMMAND_DELETE_PRESET;
+                        break;
+                    default:
+                        command.type = RemoteWarpCommand::COMMAND_LOAD_PRESET;
+                        break;
+                }
+                command.preset = replicationPacket.preset;
+                if(replicationPacket.frame == 0){
+                    // Sent with a resync, only needed if this node lost track of the preset.
+                    if(command.preset != found->getCurrentPreset()){
+                        found->applyPresetCommand(command);
+                    }
+                }else{
+                    scheduledPresets.push_back(ScheduledPreset{replicationPacket.warpName, command, replicationPacket.frame});
+                }
+            }
+        }
+        applyScheduledPresets(replication.getLeaderFrame());
     }
-    
-    auto outFile = ofFile(saveLocation/"ProjectionMapping.json", ofFile::WriteOnly);
-    outFile << out.dump(4);
 }
 
+void ofxRemoteProjectionMapper::applyScheduledPresets(uint64_t frame)
+{
+    auto due = std::stable_partition(scheduledPresets.begin(), scheduledPresets.end(), [frame](const ScheduledPreset& scheduled){
+        return scheduled.frame <= frame;
+    });
+    for(auto it = scheduledPresets.begin(); it != due; ++it){
+        if(auto & warp = mappings.get(it->warpName)){
+            warp->applyPresetCommand(it->command);
+        }
+    }
+    scheduledPresets.erase(scheduledPresets.begin(), due);
+}
+
+void ofxRemoteProjectionMapper::updateGridChannel()
+{
+    while(gridChannel.getNextUpdate(gridUpdate)){
+        auto & found = mappings.get(gridUpdate.warpName);
+        if(!found) continue;
+        if(gridUpdate.index < 0){
+            found->setRemoteGrid(gridUpdate.columns, gridUpdate.rows, gridUpdate.points);
+        }else{
+            found->setRemoteControlPoint(gridUpdate.index, gridUpdate.points[0]);
+        }
+    }
+    
+    for(auto & warp: mappings){
+        bool resend = gridChannel.takeResendRequest(warp->getName());
+        if(warp->takeGridPublishRequest() || resend){
+            gridChannel.sendGrid(warp->getName(), warp->getNumControlsX(), warp->getNumControlsY(), warp->getControlPoints());
+        }
+    }
+}
 
+void ofxRemoteProjectionMapper::applyReloadedFiles()
+{
+    for(auto & change : watcher.takeChanges()){
+        if(change.warpName.empty()){
+            if(change.hash == mappingHash) continue;
+            mappingHash = change.hash;
+            
+            // Only the placement of existing warps is taken from the mapping file, new warps are created.
+            for(size_t i = 0; i < change.mapping.numWarps; ++i){
+                const auto & entry = change.mapping.warps[i];
+                const auto & name = entry.name;
+                auto & found = mappings.get(name);
+                if(!found){
+                    ofLogNotice("RemoteProjectionMapper::hotReload") << "creating warp " << name;
+                    loadWarp(entry);
+                }else{
+                    found->setSrcArea(entry.srcArea);
+                    found->setDrawArea(entry.drawArea);
+                }
+            }
+        }else{
+            auto & found = mappings.get(change.warpName);
+            if(found && found->reloadControlPoints(change.preset, change.warp, change.hash)){
+                ofLogNotice("RemoteProjectionMapper::hotReload") << "reloaded " << change.warpName << "/" << change.preset;
+            }
+        }
+    }
+}
@@ -11,6 +11,14 @@
 #include "RemoteWarpPerspectiveBilinear.h"
 #include "RemoteWarpPerspective.h"
 #include "RemoteWarpBilinear.h"
+#include "RemoteMappingWatcher.h"
+#include "RemoteGridChannel.h"
+#include "RemoteStreamReceiver.h"
+#include "RemoteReplication.h"
+#include "RemoteThreadPool.h"
+#include "RemoteWarpTable.h"
+#include "RemoteStatsStream.h"
+#include "RemoteTrace.h"
 
 #include <type_traits>
 #include <memory>
@@ -24,34 +32,87 @@ public:
     //initializes remote UI options and optionally remote UI server iteself, inits the server by default
     void init(bool initRemoteUI = true, int port = -1, float updateInterval = .1, bool verbose = true);
     
+    //apply pending edits and compute the geometry of every warp that changed on a thread pool. optional, call it before drawWarps
+    //to leave only uploads and draws to it, without it drawWarps does the same work on the render thread one warp after another
+    void update();
+    
     //draw all warps using the provided texture
     void drawWarps(const ofTexture& tex);
     
+    //arena the warps and the mapper take temporaries from on the render thread, reset at the end of every drawWarps
+    inline RemoteFrameArena& getFrameArena(){ return RemoteFrameArena::get(); }
+    
     //load created warps created remotely from file
     void loadWarps();
     
     //write warps created remotely to file
     void saveWarps();
     
+    //watch the save location and reload warps whose files are changed by another process, changes are applied at the start of drawWarps
+    void enableHotReload(bool forcePolling = false);
+    void disableHotReload();
+    
+    //send the control grids of warps in edit mode to host:sendPort as packed OSC blobs and accept grid edits on receivePort
+    void enableGridChannel(const std::string& host, int sendPort = 12001, int receivePort = 12002);
+    void disableGridChannel();
+    
+    //listen for control points and corners streamed by a tracker on port, only the newest state of each warp is applied at the start of drawWarps
+    void enableStreamInput(int port = 12003);
+    void disableStreamInput();
+    
+    //mirror edits across render nodes over UDP multicast: the leader broadcasts control points, blend settings and preset changes of every warp,
+    //followers apply them to their warps of the same name. run the client against the leader only
+    void enableReplicationLeader(const std::string& group = "239.255.42.99", int port = 12004);
+    void enableReplicationFollower(const std::string& group = "239.255.42.99", int port = 12004);
+    void disableReplication();
+    
+    //send the stage timings and upload counts of every warp to host:port as OSC every interval seconds, see RemoteStatsStream
+    void enableStatsStream(const std::string& host, int port = 12005, float interval = 1.f);
+    void disableStatsStream();
+    
+    //record a timeline of the frame loop (edits, per warp updates, uploads, draws, saves and loads), see RemoteTrace
+    void startTrace();
+    void stopTrace();
+    //write the timeline as a Chrome trace to open in ui.perfetto.dev, relative paths are inside the save location
+    bool saveTrace(const std::filesystem::path& file = "trace.json");
+    
+    //bytes held by every warp together and by the mapper's own buffers, sampled at the end of every drawWarps with high-water marks.
+    //texture coordinates and indices shared by warps of the same resolution count once, see getWarp(name)->getMemoryReport() per warp
+    inline const RemoteMemoryReport& getMemoryReport() const { return memoryReport; }
+    //start the high-water marks of the mapper and every warp over from their current values
+    void resetMemoryPeaks();
+    
+    //number of frames between a preset change on the leader and the frame every node applies it on, has to cover the network latency
+    inline void setPresetLatency(int frames){ presetLatency = frames; }
+    
     //explicitly handle a resize
     void handleWindowResize(int width, int height);
     
     //get a single warp by name, useful if there are multiple warps that draw different textures
     std::shared_ptr<RemoteWarpBase> getWarp(const std::string& name);
     
+    //handle of a warp for lookups that skip the name, it keeps referring to the warp while others are created and removed
+    //and stops resolving once the warp is removed. null if there is no warp of that name
+    inline RemoteWarpHandle getWarpHandle(const std::string& name) const { return mappings.find(name); }
+    //get a warp by handle, nullptr once it was removed
+    inline const std::shared_ptr<RemoteWarpBase>& getWarp(RemoteWarpHandle handle) const { return mappings.get(handle); }
+    
+    //remove a warp: it stops drawing and its params leave the remote UI. it stays in ProjectionMapping.json until the next saveWarps
+    bool removeWarp(RemoteWarpHandle handle);
+    inline bool removeWarp(const std::string& name){ return removeWarp(mappings.find(name)); }
+    
     //manually create a warp: names must be unique, if the warp already exists it will return it.
     template<typename WarpType, typename...Args>
     std::shared_ptr<WarpType> createWarp( const std::string& name, const WarpSettings& settings, Args&&...args )
     {
         static_assert( std::is_base_of<RemoteWarpBase, WarpType>::value, "WarpType must inherit RemoteWarpBase!");
-        auto found = std::find_if( mappings.begin(), mappings.end(), [&name](const std::shared_ptr<RemoteWarpBase>& warp){
-            return warp->getName() == name;
-        });
-        if(found != mappings.end()){
-            return std::dynamic_pointer_cast<WarpType>(*found);
+        auto & found = mappings.get(name);
+        if(found){
+            return std::dynamic_pointer_cast<WarpType>(found);
         }else{
-            mappings.emplace_back(std::make_shared<WarpType>( name, settings, std::forward<Args>(args)... ));
-            return std::dynamic_pointer_cast<WarpType>(mappings.back());
+            auto warp = std::make_shared<WarpType>( name, settings, std::forward<Args>(args)... );
+            addWarp(warp);
+            return warp;
         }
     }
     
@@ -68,6 +129,9 @@ public:
 
 private:
     
+    //add a warp to the mappings and share it with the remote UI, returns a null handle if the name is taken
+    RemoteWarpHandle addWarp(const std::shared_ptr<RemoteWarpBase>& warp);
+    
     void handleMouseDown(ofMouseEventArgs& args);
     void handleMouseDrag(ofMouseEventArgs& args);
     void handleMouseMove(ofMouseEventArgs& args);
@@ -75,25 +139,80 @@ private:
     void handleKeyPress(ofKeyEventArgs& args);
     void handleKeyReleased(ofKeyEventArgs& args);
 
-    void createPerspectiveWarp();
-    void createBiliearWarp();
-    void createPerspectiveBilinearWarp();
+    void createPerspectiveWarp(const std::string& name);
+    void createBiliearWarp(const std::string& name);
+    void createPerspectiveBilinearWarp(const std::string& name);
     
+    //runs on the thread delivering RemoteUI events
     void handleRemoteUpdate(RemoteUIServerCallBackArg & arg);
+    //apply warps created remotely and every warp's queued remote edits, runs on the render thread
+    void applyRemoteCommands();
+    //apply everything that changed warps since the last frame: remote edits, streams, replication, reloaded files and grids
+    void applyEdits();
+    
+    //create a warp from its entry in ProjectionMapping.json
+    std::shared_ptr<RemoteWarpBase> loadWarp(const MappingRecord::Entry& entry);
+    //apply mapping files reloaded by the watcher
+    void applyReloadedFiles();
+    //apply grid edits received over the grid channel and send the grids that changed
+    void updateGridChannel();
+    //apply the newest streamed state of every warp
+    void applyStreamedUpdates();
+    //send or apply replicated edits and run the preset changes scheduled for this frame
+    void updateReplication();
+    void applyScheduledPresets(uint64_t frame);
         
     glm::ivec2 contentSize;
-    std::vector<std::shared_ptr<RemoteWarpBase>> mappings;
+    RemoteWarpTable mappings;
     std::string nextWarpName{"Next Warp"};
     std::string lastWarpName;
     ofRectangle nextWarpSrcArea;
     ofRectangle selectionArea;
     std::filesystem::path saveLocation;
-    std::vector<int> selectedMappings;
-    int focusedMappingIndex{0};
+    std::vector<RemoteWarpHandle> selectedMappings;
+    RemoteWarpHandle focusedMapping;
     int prevSelectedIndex{0};
     bool selectingMultiple{false};
     bool selectionAreaSet{false};
     bool doCreatePerspectiveWarp{false};
     bool doCreateBilinearWarp{false};
     bool doCreatePerspectiveBilinearWarp{false};
+    
+    struct CreateWarpCommand {
+        WarpSettings::Type type{WarpSettings::TYPE_UNKNOWN};
+        std::string name;
+    };
+    RemoteCommandQueue<CreateWarpCommand, 16> createCommands;
+    CreateWarpCommand createCommand;
+    
+    RemoteMappingWatcher watcher;
+    RemoteGridChannel gridChannel;
+    RemoteGridChannel::Update gridUpdate;
+    RemoteStreamReceiver streamReceiver;
+    RemoteReplication replication;
+    RemoteReplication::Packet replicationPacket;
+    RemoteStatsStream statsStream;
+    std::vector<char> replicatedRecords;
+    struct ScheduledPreset {
+        std::string warpName;
+        RemoteWarpCommand command;
+        uint64_t frame;
+    };
+    std::vector<ScheduledPreset> scheduledPresets;
+    //frames drawn by the leader since replication started
+    uint64_t replicationFrame{0};
+    int presetLatency{3};
+    //set by update, drawWarps applies the edits itself when update wasn't called
+    bool updated{false};
+    //hash of the ProjectionMapping.json contents last written or read
+    size_t mappingHash{0};
+    //reused by loadWarps and saveWarps
+    MappingRecord mappingRecord;
+    WarpJsonWriter mappingWriter;
+    WarpJsonReader mappingReader;
+    
+    void sampleMemory();
+    RemoteMemoryReport memoryReport;
+    
+    static std::string sMappingFilename;
 };